@@ -0,0 +1,64 @@
+param(
+    [Parameter(Mandatory=$true)]
+    [string]$Compiler,
+
+    [Parameter(Mandatory=$true)]
+    [ValidateSet("gcc","msvc")]
+    [string]$Style,
+
+    [Parameter(Mandatory=$true)]
+    [ValidateSet("x86","x64")]
+    [string]$Arch
+)
+
+# Function to not have to specify -Compiler, -Style, -Arch, -Action and -Optimize for each benchmark
+function Compile-And-Run {
+    param(
+        [Parameter(Mandatory=$true)]
+        [string[]]$Sources,
+
+        [Parameter(Mandatory=$false)]
+        [string[]]$Defines = @(),
+
+        [Parameter(Mandatory=$false)]
+        [string]$Output = "a.out",
+
+        [Parameter(Mandatory=$false)]
+        [switch]$AllowUnusedParameters,
+
+        [Parameter(Mandatory=$false)]
+        [switch]$AllowUnusedFunctions,
+
+        [Parameter(Mandatory=$false, ValueFromRemainingArguments=$true)]
+        [string[]]$RunArgs = @()
+    )
+
+    .\compile_and_run.ps1 `
+        -Compiler $Compiler `
+        -Style $Style `
+        -Arch $Arch `
+        -Action "run" `
+        -Sources $Sources `
+        -Defines $Defines `
+        -Output $Output `
+        -AllowUnusedParameters:$AllowUnusedParameters `
+        -AllowUnusedFunctions:$AllowUnusedFunctions `
+        -Optimize `
+        -RunArgs $RunArgs
+}
+
+# 1. StringBuilder library
+Write-Host "running benchmark for StringBuilder library..."
+Compile-And-Run `
+    -Sources @("../src/string_builder.h") `
+    -Defines @("STRING_BUILDER_BENCHMARK") `
+    -AllowUnusedParameters `
+    -AllowUnusedFunctions
+
+# 2. Argparse library
+Write-Host "running benchmark for Argparse library..."
+Compile-And-Run `
+    -Sources @("../src/argparse.h") `
+    -Defines @("ARGPARSE_BENCHMARK") `
+    -AllowUnusedParameters `
+    -AllowUnusedFunctions
@@ -29,6 +29,9 @@ param(
     [Parameter(Mandatory=$false)]
     [switch]$AllowUnusedFunctions,
 
+    [Parameter(Mandatory=$false)]
+    [switch]$Optimize,
+
     [Parameter(Mandatory=$false, ValueFromRemainingArguments=$true)]
     [string[]]$RunArgs = @()
 )
@@ -81,6 +84,10 @@ function Compile {
         if ($AllowUnusedFunctions) {
             $Args += "/wd4505"
         }
+        # Optimizations if requested
+        if ($Optimize) {
+            $Args += "/O2"
+        }
         # Add each define as a separate /D flag
         foreach ($def in $Defines) {
             $Args += "/D$def"
@@ -110,6 +117,10 @@ function Compile {
         if ($AllowUnusedFunctions) {
             $Args += "-Wno-unused-function"
         }
+        # Optimizations if requested
+        if ($Optimize) {
+            $Args += "-O2"
+        }
         # Add each define as a separate -D flag
         foreach ($def in $Defines) {
             $Args += "-D$def"
@@ -7,12 +7,16 @@
  *  - Root command, subcommands
  *  - Options with or without names (latter being positional arguments) prefixed with '-', '--' or '/'
  *  - Arguments with different arities
- *  - Default values
- *  - Custom parsing functions for options
+ *  - Default values, produced on first access
+ *  - Built-in typed values (integers, floats, booleans, enums, durations and sizes) stored inline without allocations
+ *  - Custom parsing functions for options, run on first access of the values
  *  - Double-dash (--) to escape options and treat all following arguments as positional
  *  - Option-value delimiters with a space, '=' or ':'
  *  - Option bundling for short-named options (e.g. '-abc' is equivalent to '-a -b -c')
- *  - Response files (e.g. '@args.txt' to read additional arguments from a file)
+ *  - Response files (e.g. '@args.txt' to read additional arguments from a file), memory-mapped on Linux and read once per parse
+ *  - Hashed name lookup for options and subcommands, and positional values assigned from where the previous one went, so huge command trees and argument lists parse in linear time
+ *  - Shell completion, both in-process from a partial command line and as static completion scripts for bash, zsh and fish
+ *  - All memory of a parse result comes from a single arena, and raw values point directly into argv or response files when possible
  *
  * Configuration:
  *  - #define ARGPARSE_IMPLEMENTATION before including this header in exactly one source file to include the implementation section
@@ -20,19 +24,37 @@
  *  - #define ARGPARSE_ASSERT to use a custom assertion mechanism (by default it uses assert from the C standard library)
  *  - #define ARGPARSE_SELF_TEST before including this header to compile a self-test that verifies the library's functionality
  *  - #define ARGPARSE_EXAMPLE before including this header to compile a simple example that demonstrates how to use the library
+ *  - #define ARGPARSE_BENCHMARK before including this header to compile a benchmark program measuring parsing and retrieval on huge command trees and inputs
  *
  * API:
  *  - Define commands and options using the Argparse_Command and Argparse_Option structs, including custom parsing functions and default value functions if needed
+ *  - Set the type of an option to one of the built-in Argparse_Type values to have its values parsed into the scalars of the argument
  *  - Use argparse_add_option and argparse_add_subcommand to build the command hierarchy as needed
+ *  - Optionally call argparse_compile_command to build the name lookup indices of the whole hierarchy up front, otherwise they are built lazily on first use
  *  - Call argparse_run to parse the command-line arguments and execute the corresponding handler function
  *  - Alternatively use argparse_parse to get a pack containing the parsed values and any errors, and call handlers manually
+ *  - Use argparse_parse_string to parse a whole command line from a single string, split with the quoting rules of response files
+ *  - For parsing many command lines, create an Argparse_Parser with argparse_create_parser, which recycles the memory of its pack
+ *    between parses of argparse_parser_parse and argparse_parser_parse_string, and free it with argparse_free_parser
  *  - Use argparse_get_argument and argparse_get_positional to retrieve parsed arguments from the pack by name or position
+ *  - Use argparse_get_argument_by_slot with the slot returned by argparse_add_option to retrieve parsed arguments in constant time
+ *  - Values of options with custom parsing functions are parsed when their argument is first retrieved, use argparse_validate to
+ *    parse all of them up front and collect their errors
  *  - Use argparse_print_usage to print usage information for a command
+ *  - Use argparse_complete to get the candidates for the last argument of a partial command line, and free them with argparse_free_completions
+ *  - Use argparse_format_completion_script to generate a completion script for bash, zsh or fish that does not need to run the program
  *  - Use argparse_free_pack and argparse_free_command to free the memory associated with packs and commands when they are no longer needed
+ *  - Values returned by parse functions must be allocated with the allocator passed to them, which is the arena of the pack being parsed
  *  - Use argparse_format to create formatted strings for error messages
  *  - Customize memory allocation by providing a custom Argparse_Allocator to the root command and use argparse_realloc and argparse_free for memory management
  */
 
+// NOTE: We need this for mmap on Linux
+// and apparently we need this before any includes
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // Declaration section                                                        //
 ////////////////////////////////////////////////////////////////////////////////
@@ -42,6 +64,7 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef ARGPARSE_STATIC
     #define ARGPARSE_DEF static
@@ -60,6 +83,8 @@ extern "C" {
 struct Argparse_Command;
 struct Argparse_Argument;
 struct Argparse_Option;
+struct Argparse_NameIndex;
+struct Argparse_Arena;
 
 /**
  * An allocator struct that allows customizing memory allocation for the library.
@@ -73,6 +98,16 @@ typedef struct Argparse_Allocator {
     void(*free)(void* ctx, void* ptr);
 } Argparse_Allocator;
 
+/**
+ * A non-owning view of a piece of text, which is not necessarily NUL-terminated.
+ */
+typedef struct Argparse_StringView {
+    // The first character of the text.
+    char const* data;
+    // The number of characters in the text.
+    size_t length;
+} Argparse_StringView;
+
 /**
  * The result of parsing command-line arguments, containing the parsed values and any errors that were encountered during parsing.
  */
@@ -93,6 +128,17 @@ typedef struct Argparse_Pack {
         size_t capacity;
     } arguments;
 
+    // Owned lookup table from the option slots of the resolved command to the parsed arguments
+    struct {
+        // For each option slot, the index of its parsed argument plus one, or 0 if the option was not specified.
+        size_t* elements;
+        // The number of slots, which is the number of options of the resolved command.
+        size_t length;
+    } slots;
+
+    // The first positional argument of the resolved command that might still take values, the ones before it are full.
+    size_t positional_cursor;
+
     // Owned list of errors
     struct {
         // The error messages that were produced.
@@ -102,6 +148,9 @@ typedef struct Argparse_Pack {
         // The capacity of the errors array.
         size_t capacity;
     } errors;
+
+    // Owned arena that all of the memory above, the parsed values and the contents of response files are allocated from.
+    struct Argparse_Arena* arena;
 } Argparse_Pack;
 
 /**
@@ -109,10 +158,10 @@ typedef struct Argparse_Pack {
  */
 typedef struct Argparse_ParseResult {
     // The value that was parsed, if parsing succeeded.
-    // The library will attempt to free this value, so it must be heap-allocated if parsing succeeded.
+    // It must be allocated with the allocator passed to the parse function, so that it's released along with the pack.
     void* value;
     // An error message if parsing failed, or NULL if parsing succeeded.
-    // The library will attempt to free this error message when the pack is freed, so it must be heap-allocated if parsing failed.
+    // It must be allocated with the allocator passed to the parse function, so that it's released along with the pack.
     // Consider using @see argparse_format to create error messages for this.
     char* error;
 } Argparse_ParseResult;
@@ -128,6 +177,51 @@ typedef enum Argparse_Arity {
     ARGPARSE_ARITY_ONE_OR_MORE,
 } Argparse_Arity;
 
+/**
+ * The built-in types that option values can be parsed to.
+ * Values of any type other than ARGPARSE_TYPE_STRING are stored inline in the scalars of the argument, without allocations.
+ */
+typedef enum Argparse_Type {
+    // The raw text, or the result of the custom parsing function if the option has one.
+    ARGPARSE_TYPE_STRING,
+    // A decimal or 0x-prefixed hexadecimal integer with an optional sign, stored in as_int64.
+    ARGPARSE_TYPE_INT64,
+    // A decimal or 0x-prefixed hexadecimal integer without a sign, stored in as_uint64.
+    ARGPARSE_TYPE_UINT64,
+    // A floating-point number, stored in as_double.
+    ARGPARSE_TYPE_DOUBLE,
+    // One of true/false, yes/no, on/off or 1/0 in any letter case, stored in as_bool.
+    ARGPARSE_TYPE_BOOL,
+    // One of the names in the enum_values table of the option, stored in as_int64 as the value of the matching entry.
+    ARGPARSE_TYPE_ENUM,
+    // A sequence of numbers with the units d, h, m, s, ms, us or ns (for example "1h30m" or "1.5s"), a plain number means seconds.
+    // Stored in as_int64 as nanoseconds.
+    ARGPARSE_TYPE_DURATION,
+    // A number with an optional binary size suffix K, M, G or T, optionally followed by B or iB (for example "64K" or "1.5GiB").
+    // Stored in as_uint64 as bytes.
+    ARGPARSE_TYPE_SIZE,
+} Argparse_Type;
+
+/**
+ * An inline value of an option with a built-in type.
+ */
+typedef union Argparse_Scalar {
+    int64_t as_int64;
+    uint64_t as_uint64;
+    double as_double;
+    bool as_bool;
+} Argparse_Scalar;
+
+/**
+ * An accepted name of an option with the type ARGPARSE_TYPE_ENUM.
+ */
+typedef struct Argparse_EnumValue {
+    // The name that is accepted on the command line.
+    char const* name;
+    // The value the name is parsed to.
+    int64_t value;
+} Argparse_EnumValue;
+
 typedef Argparse_ParseResult Argparse_ParseFn(Argparse_Allocator* allocator, char const* text, size_t length);
 typedef void* Argparse_ValueFn(Argparse_Allocator* allocator, struct Argparse_Option* option);
 
@@ -145,10 +239,18 @@ typedef struct Argparse_Option {
     char const* description;
     // The arity of the option, indicating how many values it can accept.
     Argparse_Arity arity;
-    // A custom parsing function for the option's values. If NULL, the raw text will be used as the value.
+    // The built-in type the option's values are parsed to. Zero-initialized to ARGPARSE_TYPE_STRING.
+    Argparse_Type type;
+    // The accepted names for options with the type ARGPARSE_TYPE_ENUM, terminated by an entry with a NULL name.
+    Argparse_EnumValue const* enum_values;
+    // A custom parsing function for the option's values, only used with ARGPARSE_TYPE_STRING. If NULL, the raw text will be used as the value.
+    // It's called when the argument is first retrieved from the pack, or by @see argparse_validate.
     Argparse_ParseFn* parse_fn;
     // A function that provides the default value for this option if it is not specified in the command line. Can be NULL if no default value is needed.
-    // Note, that the library currently does not call this at all, merely here for future extensibility.
+    // It's called when the argument is first retrieved from the pack, and an option with a default satisfies its arity without being specified.
+    // For options with a built-in type, it must return a pointer to an Argparse_Scalar, which is copied into the scalars of the argument.
+    // For those, returning NULL means there is no default, which is remembered in the pack like a default would be. The option is then treated
+    // as not specified, and one whose arity requires a value reports it as missing.
     Argparse_ValueFn* default_value_fn;
 } Argparse_Option;
 
@@ -186,6 +288,10 @@ typedef struct Argparse_Command {
     // Optional custom allocator. Only specify for the root command before adding subcommands, it will be inherited by all subcommands
     // when they are registered. Mixing the command tree with different allocators is UB by the library.
     Argparse_Allocator allocator;
+
+    // Owned lookup index for the names of options and subcommands, built by @see argparse_compile_command or lazily
+    // on first lookup, and discarded when options or subcommands are added. Leave it NULL when declaring the command.
+    struct Argparse_NameIndex* name_index;
 } Argparse_Command;
 
 /**
@@ -195,15 +301,61 @@ typedef struct Argparse_Argument {
     // The option that was parsed. This points to the corresponding option in the command's options array.
     Argparse_Option* option;
     struct {
-        // The values that were provided for the option.
+        // The values that were provided for the option. NULL for options with a built-in type other than ARGPARSE_TYPE_STRING.
         void** elements;
+        // The raw text of each value without surrounding quotes, pointing into argv or the response file it came from.
+        Argparse_StringView* texts;
+        // The parsed values of options with a built-in type other than ARGPARSE_TYPE_STRING, NULL otherwise.
+        Argparse_Scalar* scalars;
         // The number of values provided.
         size_t length;
         // The capacity of the values array.
         size_t capacity;
     } values;
+    // True if the option was not specified and the argument holds the value produced by its default_value_fn.
+    bool is_default;
+    // True once the values went through the parse_fn of the option, which happens on first retrieval from the pack.
+    bool is_parsed;
 } Argparse_Argument;
 
+/**
+ * A reusable parser for a command tree that recycles the memory of its pack between parses.
+ * The command tree is compiled when the parser is created and only read afterwards, so parsers on different threads can share
+ * the same tree, as long as no options or subcommands are added to it in the meantime. A single parser must not be used
+ * from multiple threads at the same time.
+ */
+typedef struct Argparse_Parser {
+    // The root command to parse against.
+    Argparse_Command* root;
+    // The result of the last parse, owned by the parser and overwritten by the next parse.
+    Argparse_Pack pack;
+    // Owned arena of the pack, which is reset instead of freed between parses.
+    struct Argparse_Arena* arena;
+} Argparse_Parser;
+
+/**
+ * The candidates for completing the last argument of a partial command line.
+ */
+typedef struct Argparse_Completions {
+    // The command that the completed argument belongs to.
+    Argparse_Command* command;
+    // The candidates in lexicographic order, pointing to names in the command tree.
+    char const** elements;
+    // The number of candidates.
+    size_t length;
+    // The capacity of the candidates array.
+    size_t capacity;
+} Argparse_Completions;
+
+/**
+ * The shells that completion scripts can be generated for.
+ */
+typedef enum Argparse_Shell {
+    ARGPARSE_SHELL_BASH,
+    ARGPARSE_SHELL_ZSH,
+    ARGPARSE_SHELL_FISH,
+} Argparse_Shell;
+
 /**
  * Parses the specified command-line arguments according to the specified root command,
  * and executes the corresponding handler function if parsing was successful.
@@ -233,24 +385,117 @@ ARGPARSE_DEF void argparse_print_usage(Argparse_Command* command);
  */
 ARGPARSE_DEF Argparse_Pack argparse_parse(int argc, char** argv, Argparse_Command* root);
 
+/**
+ * Parses a whole command line from a single string according to the specified root command.
+ * The string is split into arguments like the contents of response files, meaning on whitespace that is not between quotes.
+ * It does not contain the program name, the name of the root command is used instead. Arguments starting with '@' are not
+ * expanded into response files, so that command strings can't make the process read files.
+ * @param command_line The command line to parse, it's copied into the pack.
+ * @param root The root command to parse against, which may contain subcommands and options.
+ * @returns A pack containing the parsed values and any errors that were encountered during parsing.
+ */
+ARGPARSE_DEF Argparse_Pack argparse_parse_string(char const* command_line, Argparse_Command* root);
+
+/**
+ * Creates a reusable parser for the specified root command, compiling the command tree with @see argparse_compile_command.
+ * @param root The root command to parse against.
+ * @returns The parser, which must be freed with @see argparse_free_parser.
+ */
+ARGPARSE_DEF Argparse_Parser argparse_create_parser(Argparse_Command* root);
+
+/**
+ * Same as @see argparse_parse, but reuses the memory of the previous parse of the parser.
+ * @param parser The parser to use.
+ * @param argc The number of command-line arguments, including the program name.
+ * @param argv The command-line arguments, where argv[0] is the program name.
+ * @returns The pack of the parser, which stays valid until the next parse or until the parser is freed. It must not be freed by the caller.
+ */
+ARGPARSE_DEF Argparse_Pack* argparse_parser_parse(Argparse_Parser* parser, int argc, char** argv);
+
+/**
+ * Same as @see argparse_parse_string, but reuses the memory of the previous parse of the parser.
+ * @param parser The parser to use.
+ * @param command_line The command line to parse, it's copied into the pack.
+ * @returns The pack of the parser, which stays valid until the next parse or until the parser is freed. It must not be freed by the caller.
+ */
+ARGPARSE_DEF Argparse_Pack* argparse_parser_parse_string(Argparse_Parser* parser, char const* command_line);
+
+/**
+ * Frees the memory associated with the parser, including its pack. The command tree is not freed.
+ * @param parser The parser to free.
+ */
+ARGPARSE_DEF void argparse_free_parser(Argparse_Parser* parser);
+
+/**
+ * Collects the candidates for completing the last argument of a partial command line.
+ * The arguments before the last one resolve the subcommand the same way parsing does. The last argument is matched
+ * as a prefix against the names of subcommands and options, or against the accepted names of an enum option when it's
+ * the value of one. For values after a delimiter, like "--mode=de", the candidates are the values only, like "debug".
+ * Lookups use the name indices of the commands, so they are built if the tree was not compiled before.
+ * @param argc The number of arguments, including the program name and the argument being completed.
+ * @param argv The arguments, where argv[0] is the program name and argv[argc - 1] is the argument being completed.
+ * If argc is less than 2, an empty argument is completed.
+ * @param root The root command to complete against.
+ * @returns The candidates, which must be freed with @see argparse_free_completions.
+ */
+ARGPARSE_DEF Argparse_Completions argparse_complete(int argc, char** argv, Argparse_Command* root);
+
+/**
+ * Frees the memory associated with the completions. The candidates themselves are owned by the command tree.
+ * @param completions The completions to free.
+ */
+ARGPARSE_DEF void argparse_free_completions(Argparse_Completions* completions);
+
+/**
+ * Generates a static completion script for the specified shell, so the shell can complete subcommands, options
+ * and enum values without running the program. The script registers itself for the name of the root command.
+ * @param root The root command to generate the script for.
+ * @param shell The shell to generate the script for.
+ * @returns A heap-allocated string containing the script, that must be freed with the allocator of the root command.
+ */
+ARGPARSE_DEF char* argparse_format_completion_script(Argparse_Command* root, Argparse_Shell shell);
+
 /**
  * Retrieves the parsed argument corresponding to the specified option name from the pack.
+ * The first retrieval of an argument runs its values through the parse function of the option, dropping the values
+ * that fail to parse and adding their errors to the pack, or produces the default value if the option was not specified.
+ * The result is cached in the pack, so retrievals modify the pack and must not happen concurrently.
  * @param pack The pack returned by @see argparse_parse.
  * @param name The long or short name of the option to retrieve, including its prefix (e.g. "--help" or "-h").
- * @returns The parsed argument corresponding to the specified option name, or NULL if no such option was parsed.
+ * @returns The parsed argument corresponding to the specified option name, or NULL if no such option was parsed and it has no default value.
  */
 ARGPARSE_DEF Argparse_Argument* argparse_get_argument(Argparse_Pack* pack, char const* name);
 
+/**
+ * Retrieves the parsed argument corresponding to the specified option slot from the pack in constant time.
+ * Values are parsed and defaults produced on first retrieval, like with @see argparse_get_argument.
+ * @param pack The pack returned by @see argparse_parse.
+ * @param slot The slot of the option, as returned by @see argparse_add_option when it was added to the resolved command.
+ * @returns The parsed argument corresponding to the specified option slot, or NULL if no such option was parsed and it has no default value.
+ */
+ARGPARSE_DEF Argparse_Argument* argparse_get_argument_by_slot(Argparse_Pack* pack, size_t slot);
+
 /**
  * Retrieves the parsed argument corresponding to the specified positional argument index from the pack.
+ * Values are parsed and defaults produced on first retrieval, like with @see argparse_get_argument.
  * @param pack The pack returned by @see argparse_parse.
  * @param position The index of the positional argument to retrieve.
- * @returns The parsed argument corresponding to the specified positional argument index, or NULL if no such argument was parsed.
+ * @returns The parsed argument corresponding to the specified positional argument index, or NULL if no such argument was parsed and it has no default value.
  */
 ARGPARSE_DEF Argparse_Argument* argparse_get_positional(Argparse_Pack* pack, size_t position);
 
+/**
+ * Parses the values of all specified arguments that were not retrieved from the pack yet, adding their parse errors to the pack.
+ * Required options that were not specified get their defaults produced, so the ones without a default are reported as missing.
+ * Called by @see argparse_run before invoking the handler, so handlers only see packs without errors.
+ * @param pack The pack returned by @see argparse_parse.
+ * @returns True if the pack has no errors.
+ */
+ARGPARSE_DEF bool argparse_validate(Argparse_Pack* pack);
+
 /**
  * Frees the memory associated with the pack, including any parsed values and error messages.
+ * All of it is owned by the arena of the pack, so this is a handful of deallocations regardless of the number of values.
  * @param pack The pack to free.
  */
 ARGPARSE_DEF void argparse_free_pack(Argparse_Pack* pack);
@@ -259,16 +504,27 @@ ARGPARSE_DEF void argparse_free_pack(Argparse_Pack* pack);
  * Adds an option to the specified command.
  * @param command The command to which the option will be added.
  * @param option The option to add to the command.
+ * @returns The slot of the option, which is its index among the options of the command. It can be used
+ * to retrieve the parsed argument with @see argparse_get_argument_by_slot.
  */
-ARGPARSE_DEF void argparse_add_option(Argparse_Command* command, Argparse_Option option);
+ARGPARSE_DEF size_t argparse_add_option(Argparse_Command* command, Argparse_Option option);
 
 /**
  * Adds a subcommand to the specified command.
+ * The command takes over the subcommand, which should not be used on its own afterwards.
  * @param command The command to which the subcommand will be added.
  * @param subcommand The subcommand to add to the command.
  */
 ARGPARSE_DEF void argparse_add_subcommand(Argparse_Command* command, Argparse_Command subcommand);
 
+/**
+ * Builds the name lookup index of the specified command and all of its subcommands recursively.
+ * Calling this is optional, as indices are built lazily on the first lookup, but after this call the command
+ * tree is not modified by parsing anymore, as long as no options or subcommands are added to it.
+ * @param command The command to compile.
+ */
+ARGPARSE_DEF void argparse_compile_command(Argparse_Command* command);
+
 /**
  * Frees the memory associated with the command, including its options and subcommands.
  * @param command The command to free.
@@ -325,10 +581,21 @@ ARGPARSE_DEF void argparse_free(Argparse_Allocator* allocator, void* ptr);
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #if defined(MAP_FAILED)
+        #define __ARGPARSE_MMAP
+    #endif
+#endif
+
 #define ARGPARSE_ADD_TO_ARRAY(allocator, array, element) \
     do { \
         if ((array).length + 1 > (array).capacity) { \
@@ -377,48 +644,402 @@ void argparse_free(Argparse_Allocator* allocator, void* ptr) {
     allocator->free(allocator->context, ptr);
 }
 
-// Misc ////////////////////////////////////////////////////////////////////////
+// Arena ///////////////////////////////////////////////////////////////////////
+
+// Every allocation is preceded by a header of this size that stores its size, which keeps allocations aligned too
+#define ARGPARSE_ARENA_ALIGNMENT 16
+#define ARGPARSE_ARENA_MIN_CHUNK_SIZE 4096
+
+typedef struct Argparse_ArenaChunk {
+    // The previously allocated chunk, or NULL for the first one
+    struct Argparse_ArenaChunk* prev;
+    // The number of usable bytes in the chunk
+    size_t capacity;
+    // The number of bytes already handed out from the chunk
+    size_t used;
+} Argparse_ArenaChunk;
+
+typedef struct Argparse_Arena {
+    // The allocator used for the chunks, copied from the command the pack was parsed with
+    Argparse_Allocator backing;
+    // The allocator serving memory from this arena, which is what parse functions receive
+    Argparse_Allocator allocator;
+    // The chunk allocations are currently served from
+    Argparse_ArenaChunk* current;
+    // The total capacity of all chunks, used to size the next chunk
+    size_t total;
+#ifdef __ARGPARSE_MMAP
+    // The memory-mapped response files, unmapped when the arena is destroyed
+    struct Argparse_ArenaMapping* mappings;
+#endif
+} Argparse_Arena;
+
+#ifdef __ARGPARSE_MMAP
+typedef struct Argparse_ArenaMapping {
+    // The previously registered mapping, or NULL for the first one
+    struct Argparse_ArenaMapping* prev;
+    // The start address of the mapping
+    void* address;
+    // The length of the mapping in bytes
+    size_t length;
+} Argparse_ArenaMapping;
+#endif
+
+#define ARGPARSE_ARENA_CHUNK_HEADER_SIZE \
+    ((sizeof(Argparse_ArenaChunk) + ARGPARSE_ARENA_ALIGNMENT - 1) / ARGPARSE_ARENA_ALIGNMENT * ARGPARSE_ARENA_ALIGNMENT)
+
+static char* argparse_arena_chunk_data(Argparse_ArenaChunk* chunk) {
+    return (char*)chunk + ARGPARSE_ARENA_CHUNK_HEADER_SIZE;
+}
+
+static size_t argparse_arena_block_size(size_t size) {
+    return ARGPARSE_ARENA_ALIGNMENT + (size + ARGPARSE_ARENA_ALIGNMENT - 1) / ARGPARSE_ARENA_ALIGNMENT * ARGPARSE_ARENA_ALIGNMENT;
+}
+
+static void* argparse_arena_alloc(Argparse_Arena* arena, size_t size) {
+    size_t blockSize = argparse_arena_block_size(size);
+    Argparse_ArenaChunk* chunk = arena->current;
+    if (chunk == NULL || chunk->capacity - chunk->used < blockSize) {
+        // Chunks grow with the arena, so a pack only needs a logarithmic number of them
+        size_t capacity = arena->total < ARGPARSE_ARENA_MIN_CHUNK_SIZE ? ARGPARSE_ARENA_MIN_CHUNK_SIZE : arena->total;
+        if (capacity < blockSize) capacity = blockSize;
+        chunk = (Argparse_ArenaChunk*)argparse_realloc(&arena->backing, NULL, ARGPARSE_ARENA_CHUNK_HEADER_SIZE + capacity);
+        chunk->prev = arena->current;
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        arena->current = chunk;
+        arena->total += capacity;
+    }
+    char* block = argparse_arena_chunk_data(chunk) + chunk->used;
+    chunk->used += blockSize;
+    memcpy(block, &size, sizeof(size_t));
+    return block + ARGPARSE_ARENA_ALIGNMENT;
+}
+
+static void* argparse_arena_realloc(void* ctx, void* ptr, size_t new_size) {
+    Argparse_Arena* arena = (Argparse_Arena*)ctx;
+    if (ptr == NULL) return argparse_arena_alloc(arena, new_size);
+
+    char* block = (char*)ptr - ARGPARSE_ARENA_ALIGNMENT;
+    size_t oldSize;
+    memcpy(&oldSize, block, sizeof(size_t));
+    // The most recent allocation can grow or shrink in place
+    Argparse_ArenaChunk* chunk = arena->current;
+    size_t oldBlockSize = argparse_arena_block_size(oldSize);
+    size_t newBlockSize = argparse_arena_block_size(new_size);
+    if (block + oldBlockSize == argparse_arena_chunk_data(chunk) + chunk->used
+     && chunk->used - oldBlockSize + newBlockSize <= chunk->capacity) {
+        chunk->used = chunk->used - oldBlockSize + newBlockSize;
+        memcpy(block, &new_size, sizeof(size_t));
+        return ptr;
+    }
+    if (new_size <= oldSize) return ptr;
+    void* result = argparse_arena_alloc(arena, new_size);
+    memcpy(result, ptr, oldSize);
+    return result;
+}
+
+static void argparse_arena_free(void* ctx, void* ptr) {
+    // Memory is released all at once when the arena is destroyed
+    (void)ctx;
+    (void)ptr;
+}
+
+static Argparse_Arena* argparse_arena_new(Argparse_Allocator* backing) {
+    Argparse_Arena* arena = (Argparse_Arena*)argparse_realloc(backing, NULL, sizeof(Argparse_Arena));
+    arena->backing = *backing;
+    arena->allocator = (Argparse_Allocator){
+        .context = arena,
+        .realloc = argparse_arena_realloc,
+        .free = argparse_arena_free,
+    };
+    arena->current = NULL;
+    arena->total = 0;
+#ifdef __ARGPARSE_MMAP
+    arena->mappings = NULL;
+#endif
+    return arena;
+}
+
+#ifdef __ARGPARSE_MMAP
+static void argparse_arena_release_mappings(Argparse_Arena* arena) {
+    for (Argparse_ArenaMapping* mapping = arena->mappings; mapping != NULL; mapping = mapping->prev) {
+        munmap(mapping->address, mapping->length);
+    }
+    arena->mappings = NULL;
+}
+
+static void argparse_arena_add_mapping(Argparse_Arena* arena, void* address, size_t length) {
+    Argparse_ArenaMapping* mapping = (Argparse_ArenaMapping*)argparse_arena_alloc(arena, sizeof(Argparse_ArenaMapping));
+    mapping->prev = arena->mappings;
+    mapping->address = address;
+    mapping->length = length;
+    arena->mappings = mapping;
+}
+#endif
+
+static void argparse_arena_delete(Argparse_Arena* arena) {
+    if (arena == NULL) return;
+#ifdef __ARGPARSE_MMAP
+    argparse_arena_release_mappings(arena);
+#endif
+    Argparse_Allocator backing = arena->backing;
+    Argparse_ArenaChunk* chunk = arena->current;
+    while (chunk != NULL) {
+        Argparse_ArenaChunk* prev = chunk->prev;
+        argparse_free(&backing, chunk);
+        chunk = prev;
+    }
+    argparse_free(&backing, arena);
+}
 
-static bool argparse_option_has_name(Argparse_Option* option, char const* name) {
-    return (option->long_name != NULL && strcmp(option->long_name, name) == 0)
-        || (option->short_name != NULL && strcmp(option->short_name, name) == 0);
+// Releases all allocations of the arena, but keeps its memory for reuse
+static void argparse_arena_reset(Argparse_Arena* arena) {
+#ifdef __ARGPARSE_MMAP
+    argparse_arena_release_mappings(arena);
+#endif
+    Argparse_ArenaChunk* chunk = arena->current;
+    if (chunk == NULL) return;
+    if (chunk->prev != NULL) {
+        // Merge all chunks into one, so that a similar parse fits without allocating next time
+        while (chunk != NULL) {
+            Argparse_ArenaChunk* prev = chunk->prev;
+            argparse_free(&arena->backing, chunk);
+            chunk = prev;
+        }
+        chunk = (Argparse_ArenaChunk*)argparse_realloc(&arena->backing, NULL, ARGPARSE_ARENA_CHUNK_HEADER_SIZE + arena->total);
+        chunk->prev = NULL;
+        chunk->capacity = arena->total;
+        arena->current = chunk;
+    }
+    chunk->used = 0;
 }
 
+// Misc ////////////////////////////////////////////////////////////////////////
+
 static bool argparse_is_positional_option(Argparse_Option* option) {
     return option->long_name == NULL && option->short_name == NULL;
 }
 
-static Argparse_Command* argparse_find_subcommand_with_name_n(Argparse_Command* command, char const* name, size_t nameLength) {
-    for (size_t i = 0; i < command->subcommands.length; ++i) {
-        Argparse_Command* subcommand = &command->subcommands.elements[i];
-        if (strlen(subcommand->name) == nameLength && strncmp(subcommand->name, name, nameLength) == 0) {
-            return subcommand;
+static Argparse_Allocator* argparse_pack_allocator(Argparse_Pack* pack) {
+    return &pack->arena->allocator;
+}
+
+static void argparse_add_error(Argparse_Pack* pack, char* error) {
+    ARGPARSE_ADD_TO_ARRAY(argparse_pack_allocator(pack), pack->errors, error);
+}
+
+static void argparse_add_argument(Argparse_Pack* pack, Argparse_Argument arg) {
+    ARGPARSE_ADD_TO_ARRAY(argparse_pack_allocator(pack), pack->arguments, arg);
+}
+
+// Sizes the slot table for the resolved command, which is final by the time any argument is added
+static void argparse_init_slots(Argparse_Pack* pack) {
+    if (pack->slots.elements != NULL || pack->command->options.length == 0) return;
+    size_t length = pack->command->options.length;
+    pack->slots.elements = (size_t*)argparse_realloc(argparse_pack_allocator(pack), NULL, length * sizeof(size_t));
+    pack->slots.length = length;
+    memset(pack->slots.elements, 0, length * sizeof(size_t));
+}
+
+static Argparse_Argument* argparse_get_or_add_argument_for_slot(Argparse_Pack* pack, size_t slot) {
+    argparse_init_slots(pack);
+    ARGPARSE_ASSERT(slot < pack->slots.length, "option slot out of range for the resolved command");
+    if (pack->slots.elements[slot] == 0) {
+        Argparse_Argument argument = {
+            .option = &pack->command->options.elements[slot],
+            .values = { 0 },
+        };
+        argparse_add_argument(pack, argument);
+        pack->slots.elements[slot] = pack->arguments.length;
+    }
+    return &pack->arguments.elements[pack->slots.elements[slot] - 1];
+}
+
+// Looks up the argument of the slot without parsing its values or producing defaults
+static Argparse_Argument* argparse_find_argument_for_slot(Argparse_Pack* pack, size_t slot) {
+    if (slot >= pack->slots.length || pack->slots.elements[slot] == 0) return NULL;
+    return &pack->arguments.elements[pack->slots.elements[slot] - 1];
+}
+
+// Reserves an argument for each option of the resolved command, so adding defaults later never moves the arguments handed out before
+static void argparse_reserve_arguments(Argparse_Pack* pack) {
+    size_t capacity = pack->command->options.length;
+    if (pack->arguments.capacity >= capacity) return;
+    pack->arguments.elements = (Argparse_Argument*)argparse_realloc(argparse_pack_allocator(pack), pack->arguments.elements, capacity * sizeof(Argparse_Argument));
+    pack->arguments.capacity = capacity;
+}
+
+static void argparse_add_value_to_argument(Argparse_Pack* pack, Argparse_Argument* argument, void* value, Argparse_StringView text, Argparse_Scalar scalar) {
+    // The values, their texts and scalars are parallel arrays, so they are grown together
+    bool hasScalars = argument->option->type != ARGPARSE_TYPE_STRING;
+    if (argument->values.length + 1 > argument->values.capacity) {
+        Argparse_Allocator* allocator = argparse_pack_allocator(pack);
+        size_t newCapacity = (argument->values.capacity == 0) ? 4 : (argument->values.capacity * 2);
+        argument->values.elements = (void**)argparse_realloc(allocator, argument->values.elements, newCapacity * sizeof(void*));
+        argument->values.texts = (Argparse_StringView*)argparse_realloc(allocator, argument->values.texts, newCapacity * sizeof(Argparse_StringView));
+        if (hasScalars) {
+            argument->values.scalars = (Argparse_Scalar*)argparse_realloc(allocator, argument->values.scalars, newCapacity * sizeof(Argparse_Scalar));
         }
+        argument->values.capacity = newCapacity;
     }
-    return NULL;
+    argument->values.elements[argument->values.length] = value;
+    argument->values.texts[argument->values.length] = text;
+    if (hasScalars) argument->values.scalars[argument->values.length] = scalar;
+    ++argument->values.length;
 }
 
-static Argparse_Option* argparse_find_option_with_name_n(Argparse_Command* command, char const* name, size_t nameLength) {
+// Name index //////////////////////////////////////////////////////////////////
+
+typedef struct Argparse_NameEntry {
+    // The name of the option or subcommand, NULL for an empty entry
+    char const* name;
+    // The precomputed length of the name
+    size_t length;
+    // The hash of the name
+    uint32_t hash;
+    // The index of the option or subcommand in the command's arrays
+    uint32_t target;
+    // True, if the target is a subcommand, false if it's an option
+    bool is_subcommand;
+} Argparse_NameEntry;
+
+typedef struct Argparse_NameIndex {
+    // Open-addressing hash table of names, the capacity is always a power of 2 and at most half full
+    Argparse_NameEntry* entries;
+    // The number of entries in the table
+    size_t capacity;
+    // The slots of the positional options, in declaration order
+    size_t* positionals;
+    // The number of positional options
+    size_t positional_count;
+    // The entries of the table in lexicographic order of their names, for prefix lookups
+    Argparse_NameEntry** sorted;
+    // The number of sorted entries
+    size_t sorted_count;
+} Argparse_NameIndex;
+
+static uint32_t argparse_hash_name(char const* name, size_t length) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static Argparse_NameEntry* argparse_name_index_probe(Argparse_NameIndex* index, char const* name, size_t length, uint32_t hash, bool isSubcommand) {
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Argparse_NameEntry* entry = &index->entries[i];
+        if (entry->name == NULL) return entry;
+        if (entry->hash == hash
+         && entry->length == length
+         && entry->is_subcommand == isSubcommand
+         && memcmp(entry->name, name, length) == 0) return entry;
+    }
+}
+
+static void argparse_name_index_insert(Argparse_NameIndex* index, char const* name, size_t target, bool isSubcommand) {
+    size_t length = strlen(name);
+    uint32_t hash = argparse_hash_name(name, length);
+    Argparse_NameEntry* entry = argparse_name_index_probe(index, name, length, hash, isSubcommand);
+    // In case of duplicate names, the first declaration wins
+    if (entry->name != NULL) return;
+    *entry = (Argparse_NameEntry){
+        .name = name,
+        .length = length,
+        .hash = hash,
+        .target = (uint32_t)target,
+        .is_subcommand = isSubcommand,
+    };
+}
+
+static void argparse_name_index_free(Argparse_Command* command) {
+    if (command->name_index == NULL) return;
+    argparse_free(&command->allocator, command->name_index->entries);
+    argparse_free(&command->allocator, command->name_index->positionals);
+    argparse_free(&command->allocator, command->name_index->sorted);
+    argparse_free(&command->allocator, command->name_index);
+    command->name_index = NULL;
+}
+
+static int argparse_compare_name_entries(void const* a, void const* b) {
+    Argparse_NameEntry const* entryA = *(Argparse_NameEntry* const*)a;
+    Argparse_NameEntry const* entryB = *(Argparse_NameEntry* const*)b;
+    return strcmp(entryA->name, entryB->name);
+}
+
+static Argparse_NameIndex* argparse_get_name_index(Argparse_Command* command) {
+    if (command->name_index != NULL) return command->name_index;
+
+    // Each option can contribute two names, keep the table at most half full
+    size_t nameCount = command->options.length * 2 + command->subcommands.length;
+    size_t capacity = 8;
+    while (capacity < nameCount * 2) capacity *= 2;
+
+    Argparse_NameIndex* index = (Argparse_NameIndex*)argparse_realloc(&command->allocator, NULL, sizeof(Argparse_NameIndex));
+    index->entries = (Argparse_NameEntry*)argparse_realloc(&command->allocator, NULL, capacity * sizeof(Argparse_NameEntry));
+    index->capacity = capacity;
+    memset(index->entries, 0, capacity * sizeof(Argparse_NameEntry));
+    index->positionals = NULL;
+    index->positional_count = 0;
     for (size_t i = 0; i < command->options.length; ++i) {
         Argparse_Option* option = &command->options.elements[i];
-        if ((option->long_name != NULL && strlen(option->long_name) == nameLength && strncmp(option->long_name, name, nameLength) == 0)
-         || (option->short_name != NULL && strlen(option->short_name) == nameLength && strncmp(option->short_name, name, nameLength) == 0)) {
-            return option;
+        if (option->long_name != NULL) argparse_name_index_insert(index, option->long_name, i, false);
+        if (option->short_name != NULL) argparse_name_index_insert(index, option->short_name, i, false);
+        if (argparse_is_positional_option(option)) {
+            if (index->positionals == NULL) {
+                index->positionals = (size_t*)argparse_realloc(&command->allocator, NULL, command->options.length * sizeof(size_t));
+            }
+            index->positionals[index->positional_count++] = i;
         }
     }
-    return NULL;
+    for (size_t i = 0; i < command->subcommands.length; ++i) {
+        Argparse_Command* subcommand = &command->subcommands.elements[i];
+        argparse_name_index_insert(index, subcommand->name, i, true);
+    }
+    // Sort the names for prefix lookups
+    index->sorted = NULL;
+    index->sorted_count = 0;
+    if (nameCount > 0) {
+        index->sorted = (Argparse_NameEntry**)argparse_realloc(&command->allocator, NULL, nameCount * sizeof(Argparse_NameEntry*));
+        for (size_t i = 0; i < capacity; ++i) {
+            if (index->entries[i].name != NULL) index->sorted[index->sorted_count++] = &index->entries[i];
+        }
+        qsort(index->sorted, index->sorted_count, sizeof(Argparse_NameEntry*), argparse_compare_name_entries);
+    }
+    command->name_index = index;
+    return index;
 }
 
-static void argparse_add_error(Argparse_Pack* pack, char* error) {
-    ARGPARSE_ADD_TO_ARRAY(&pack->command->allocator, pack->errors, error);
+// Finds the first name in the sorted table that starts with the prefix, or comes after it
+static size_t argparse_name_index_lower_bound(Argparse_NameIndex* index, char const* prefix, size_t prefixLength) {
+    size_t low = 0;
+    size_t high = index->sorted_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (strncmp(index->sorted[mid]->name, prefix, prefixLength) < 0) low = mid + 1;
+        else high = mid;
+    }
+    return low;
 }
 
-static void argparse_add_argument(Argparse_Pack* pack, Argparse_Argument arg) {
-    ARGPARSE_ADD_TO_ARRAY(&pack->command->allocator, pack->arguments, arg);
+static Argparse_Command* argparse_find_subcommand_with_name_n(Argparse_Command* command, char const* name, size_t nameLength) {
+    if (command->subcommands.length == 0) return NULL;
+    Argparse_NameIndex* index = argparse_get_name_index(command);
+    Argparse_NameEntry* entry = argparse_name_index_probe(index, name, nameLength, argparse_hash_name(name, nameLength), true);
+    if (entry->name == NULL) return NULL;
+    return &command->subcommands.elements[entry->target];
 }
 
-static void argparse_add_value_to_argument(Argparse_Pack* pack, Argparse_Argument* argument, void* value) {
-    ARGPARSE_ADD_TO_ARRAY(&pack->command->allocator, argument->values, value);
+static Argparse_Option* argparse_find_option_with_name_n(Argparse_Command* command, char const* name, size_t nameLength) {
+    if (command->options.length == 0) return NULL;
+    Argparse_NameIndex* index = argparse_get_name_index(command);
+    Argparse_NameEntry* entry = argparse_name_index_probe(index, name, nameLength, argparse_hash_name(name, nameLength), false);
+    if (entry->name == NULL) return NULL;
+    return &command->options.elements[entry->target];
 }
 
 // Tokenization logic //////////////////////////////////////////////////////////
@@ -463,17 +1084,27 @@ static bool argparse_argument_can_take_value(Argparse_Argument* argument) {
 }
 
 typedef struct Argparse_Response {
-    char* text;
+    char const* text;
     size_t length;
     size_t index;
 } Argparse_Response;
 
 typedef struct Argparse_Token {
-    char* text;
+    char const* text;
     size_t index;
     size_t length;
 } Argparse_Token;
 
+// A response file that was already loaded during the current parse
+typedef struct Argparse_ResponseFile {
+    // The path of the file, as referenced after the '@'
+    char const* path;
+    size_t pathLength;
+    // The contents of the file, or NULL if it could not be read
+    char const* text;
+    size_t length;
+} Argparse_ResponseFile;
+
 typedef struct Argparse_Tokenizer {
     Argparse_Pack* pack;
     int argc;
@@ -484,19 +1115,26 @@ typedef struct Argparse_Tokenizer {
         size_t capacity;
         size_t length;
     } responseStack;
+    struct {
+        Argparse_ResponseFile* elements;
+        size_t capacity;
+        size_t length;
+    } responseFiles;
+    bool allowResponseFiles;
     Argparse_Token currentToken;
 } Argparse_Tokenizer;
 
 static void argparse_tokenizer_free(Argparse_Tokenizer* tokenizer) {
-    Argparse_Allocator* allocator = &tokenizer->pack->command->allocator;
-    for (size_t i = 0; i < tokenizer->responseStack.length; ++i) {
-        Argparse_Response* response = &tokenizer->responseStack.elements[i];
-        argparse_free(allocator, response->text);
-    }
+    // Response texts are owned by the arena of the pack, as values can point into them
+    Argparse_Allocator* allocator = argparse_pack_allocator(tokenizer->pack);
     argparse_free(allocator, tokenizer->responseStack.elements);
+    argparse_free(allocator, tokenizer->responseFiles.elements);
     tokenizer->responseStack.elements = NULL;
     tokenizer->responseStack.length = 0;
     tokenizer->responseStack.capacity = 0;
+    tokenizer->responseFiles.elements = NULL;
+    tokenizer->responseFiles.length = 0;
+    tokenizer->responseFiles.capacity = 0;
 }
 
 static Argparse_Response* argparse_tokenizer_current_response(Argparse_Tokenizer* tokenizer) {
@@ -505,16 +1143,15 @@ static Argparse_Response* argparse_tokenizer_current_response(Argparse_Tokenizer
 }
 
 static void argparse_tokenizer_push_response(Argparse_Tokenizer* tokenizer, Argparse_Response response) {
-    Argparse_Allocator* allocator = &tokenizer->pack->command->allocator;
+    Argparse_Allocator* allocator = argparse_pack_allocator(tokenizer->pack);
     ARGPARSE_ADD_TO_ARRAY(allocator, tokenizer->responseStack, response);
 }
 
 static void argparse_tokenizer_pop_response(Argparse_Tokenizer* tokenizer) {
-    Argparse_Allocator* allocator = &tokenizer->pack->command->allocator;
     Argparse_Response* toPop = argparse_tokenizer_current_response(tokenizer);
     ARGPARSE_ASSERT(toPop != NULL, "cannot pop response, response stack is empty");
     --tokenizer->responseStack.length;
-    argparse_free(allocator, toPop->text);
+    // NOTE: The text stays alive in the arena of the pack, values might point into it
     toPop->text = NULL;
     toPop->length = 0;
     toPop->index = 0;
@@ -603,52 +1240,115 @@ static void argparse_tokenizer_skip_current(Argparse_Tokenizer* tokenizer) {
     token->index = 0;
 }
 
+// Loads the contents of a response file into memory owned by the arena of the pack
+// Returns false if the file could not be read
+static bool argparse_load_response_file(Argparse_Pack* pack, char const* filePath, char const** outText, size_t* outLength) {
+#ifdef __ARGPARSE_MMAP
+    // Map the file, so tokens are served right from the page cache without copying
+    int fd = open(filePath, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        close(fd);
+        return false;
+    }
+    size_t fileSize = (size_t)fileStat.st_size;
+    if (fileSize == 0) {
+        // Empty files can't be mapped, but there is nothing to read either
+        close(fd);
+        *outText = "";
+        *outLength = 0;
+        return true;
+    }
+    void* mapping = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return false;
+#ifdef MADV_SEQUENTIAL
+    // The tokenizer only walks forward, the hint is only declared with _GNU_SOURCE, which might have been missed if the user included system headers before us
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+#endif
+    argparse_arena_add_mapping(pack->arena, mapping, fileSize);
+    *outText = (char const*)mapping;
+    *outLength = fileSize;
+    return true;
+#else
+    Argparse_Allocator* allocator = argparse_pack_allocator(pack);
+    // Open file for reading in binary mode to avoid CRLF translation issues
+    FILE* file = fopen(filePath, "rb");
+    if (file == NULL) return false;
+    // Get file size
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    if (fileSize < 0) {
+        fclose(file);
+        return false;
+    }
+    fseek(file, 0, SEEK_SET);
+    // Read file content
+    char* fileContent = (char*)argparse_realloc(allocator, NULL, (size_t)fileSize);
+    size_t bytesRead = fread(fileContent, 1, (size_t)fileSize, file);
+    fclose(file);
+    *outText = fileContent;
+    *outLength = bytesRead;
+    return true;
+#endif
+}
+
 // Handles the current token, unwrapping it if it's a response file token and pushing it on the stack if so
 // Returns true if the token was handled as a response file token, false otherwise
 static bool argparse_tokenizer_handle_current_as_response(Argparse_Tokenizer* tokenizer) {
     Argparse_Pack* pack = tokenizer->pack;
-    Argparse_Allocator* allocator = &pack->command->allocator;
-    char* error = NULL;
+    Argparse_Allocator* allocator = argparse_pack_allocator(pack);
     ARGPARSE_ASSERT(tokenizer->currentToken.text != NULL, "cannot process current token, no current token present");
 
     // If we are at the start of the token and it's a response, we need to push it onto the stack
     // Not a response
+    if (!tokenizer->allowResponseFiles) return false;
     if (tokenizer->currentToken.index != 0 || tokenizer->currentToken.text[0] != '@') return false;
 
     Argparse_Token* token = &tokenizer->currentToken;
     // We interpret the token (minus the @) as a file path
-    char* filePath = argparse_format(allocator, "%.*s", (int)(token->length - 1), token->text + 1);
+    // NOTE: The token text stays alive until the pack is freed, the cache can refer to it
+    char const* path = token->text + 1;
+    size_t pathLength = token->length - 1;
     // Skip this token to not re-read it when the response is processed
     argparse_tokenizer_skip_current(tokenizer);
-    // Open file for reading in binary mode to avoid CRLF translation issues
-    FILE* file = fopen(filePath, "rb");
-    if (file == NULL) goto io_fail;
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    if (fileSize < 0) goto io_fail;
-    fseek(file, 0, SEEK_SET);
-    // Read file content
-    char* fileContent = (char*)argparse_realloc(allocator, NULL, (size_t)fileSize);
-    size_t bytesRead = fread(fileContent, 1, (size_t)fileSize, file);
-    fclose(file);
-    argparse_free(allocator, filePath);
-    // Push content as new response
-    argparse_tokenizer_push_response(tokenizer, (Argparse_Response){
-        .text = fileContent,
-        .length = bytesRead,
-        .index = 0,
-    });
-    return true;
 
-io_fail:
-    // Report error, we add a dummy response to the stack to allow processing to continue
-    error = argparse_format(allocator, "failed to read response file '%s'", filePath);
-    argparse_free(allocator, filePath);
-    argparse_add_error(pack, error);
+    // Files referenced multiple times are only loaded once per parse
+    Argparse_ResponseFile* responseFile = NULL;
+    for (size_t i = 0; i < tokenizer->responseFiles.length; ++i) {
+        Argparse_ResponseFile* cached = &tokenizer->responseFiles.elements[i];
+        if (cached->pathLength == pathLength && memcmp(cached->path, path, pathLength) == 0) {
+            responseFile = cached;
+            break;
+        }
+    }
+    if (responseFile == NULL) {
+        Argparse_ResponseFile loaded = {
+            .path = path,
+            .pathLength = pathLength,
+            .text = NULL,
+            .length = 0,
+        };
+        char* filePath = argparse_format(allocator, "%.*s", (int)pathLength, path);
+        if (!argparse_load_response_file(pack, filePath, &loaded.text, &loaded.length)) {
+            loaded.text = NULL;
+            loaded.length = 0;
+        }
+        argparse_free(allocator, filePath);
+        ARGPARSE_ADD_TO_ARRAY(allocator, tokenizer->responseFiles, loaded);
+        responseFile = &tokenizer->responseFiles.elements[tokenizer->responseFiles.length - 1];
+    }
+
+    if (responseFile->text == NULL) {
+        // Report error, the NULL text acts as a dummy response on the stack to allow processing to continue
+        char* error = argparse_format(allocator, "failed to read response file '%.*s'", (int)pathLength, path);
+        argparse_add_error(pack, error);
+    }
+    // Push content as new response
     argparse_tokenizer_push_response(tokenizer, (Argparse_Response){
-        .text = NULL,
-        .length = 0,
+        .text = responseFile->text,
+        .length = responseFile->length,
         .index = 0,
     });
     return true;
@@ -684,7 +1384,7 @@ start:
     goto start;
 }
 
-static bool argparse_tokenizer_next(Argparse_Tokenizer* tokenizer, char** outToken, size_t* outLength, bool* outEndsInValueDelimiter) {
+static bool argparse_tokenizer_next(Argparse_Tokenizer* tokenizer, char const** outToken, size_t* outLength, bool* outEndsInValueDelimiter) {
     Argparse_Token* token = &tokenizer->currentToken;
 
     if (token->index >= token->length) {
@@ -699,7 +1399,7 @@ static bool argparse_tokenizer_next(Argparse_Tokenizer* tokenizer, char** outTok
     }
 
     // We have a current token, parse until a value separator or the end of the token
-    char* tokenText = token->text + token->index;
+    char const* tokenText = token->text + token->index;
     size_t tokenLength = 0;
     char currentQuote = '\0';
     while (token->index + tokenLength < token->length) {
@@ -736,122 +1436,363 @@ static bool argparse_tokenizer_next(Argparse_Tokenizer* tokenizer, char** outTok
     return true;
 }
 
-// Construction ////////////////////////////////////////////////////////////////
+// Checks, if the specified part of the current token is followed by a NUL terminator,
+// which is the case for the tail of an argv element, as those are NUL-terminated by definition
+static bool argparse_tokenizer_is_nul_terminated(Argparse_Tokenizer* tokenizer, char const* text, size_t length) {
+    return tokenizer->responseStack.length == 0
+        && text + length == tokenizer->currentToken.text + tokenizer->currentToken.length;
+}
 
-static Argparse_Argument* argparse_try_get_or_add_option_by_name(Argparse_Pack* pack, char* name, size_t nameLength) {
-    Argparse_Option* option = argparse_find_option_with_name_n(pack->command, name, nameLength);
-    if (option == NULL) return NULL;
+// Typed values ////////////////////////////////////////////////////////////////
 
-    // The command accepts such argument, check if we already added it, if so, return that
-    for (size_t i = 0; i < pack->arguments.length; ++i) {
-        if (pack->arguments.elements[i].option == option) {
-            return &pack->arguments.elements[i];
-        }
+static bool argparse_equals_ignore_case(char const* text, size_t length, char const* expected) {
+    size_t expectedLength = strlen(expected);
+    if (length != expectedLength) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if (tolower((unsigned char)text[i]) != tolower((unsigned char)expected[i])) return false;
     }
-    // No match, we need to add a new argument for this option
-    Argparse_Argument argument = {
-        .option = option,
-        .values = { 0 },
-    };
-    argparse_add_argument(pack, argument);
-    return &pack->arguments.elements[pack->arguments.length - 1];
+    return true;
 }
 
-static Argparse_Argument* argparse_try_add_option_argument(Argparse_Pack* pack, char* name, size_t nameLength) {
-    // First, try a full option name match
-    Argparse_Argument* argument = argparse_try_get_or_add_option_by_name(pack, name, nameLength);
-    if (argument != NULL) return argument;
+// Parses an unsigned decimal or 0x-prefixed hexadecimal integer, returns false on syntax error or overflow
+static bool argparse_parse_unsigned(char const* text, size_t length, uint64_t* outValue) {
+    uint64_t base = 10;
+    if (length > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+        length -= 2;
+    }
+    if (length == 0) return false;
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        uint64_t digit;
+        if (c >= '0' && c <= '9') digit = (uint64_t)(c - '0');
+        else if (base == 16 && c >= 'a' && c <= 'f') digit = (uint64_t)(c - 'a' + 10);
+        else if (base == 16 && c >= 'A' && c <= 'F') digit = (uint64_t)(c - 'A' + 10);
+        else return false;
+        if (value > (UINT64_MAX - digit) / base) return false;
+        value = value * base + digit;
+    }
+    *outValue = value;
+    return true;
+}
 
-    // Try bundling
-    if (argparse_is_legal_prefix_for_bundling(name, nameLength)) {
-        char nameBuffer[2];
-        nameBuffer[0] = name[0];
-        // Check, if all characters correspond to a short name
-        for (size_t i = 1; i < nameLength; ++i) {
-            nameBuffer[1] = name[i];
-            // NOTE: We don't add here yet, we first need to confirm a legal bundle
-            Argparse_Option* option = argparse_find_option_with_name_n(pack->command, nameBuffer, 2);
-            if (option == NULL) {
-                // Illegal bundling, some character did not correspond to a short name
-                return NULL;
-            }
-        }
-        // Legal, add all arguments for the bundled options
-        for (size_t i = 1; i < nameLength; ++i) {
-            nameBuffer[1] = name[i];
-            argument = argparse_try_get_or_add_option_by_name(pack, nameBuffer, 2);
-            // We know this won't be NULL since we checked above
-            ARGPARSE_ASSERT(argument != NULL, "unexpectedly failed to get argument for bundled option");
+// Parses the decimal number at the start of the text, with an optional fraction
+// Returns the number of characters consumed, 0 if there is no number or it overflows
+static size_t argparse_parse_decimal_prefix(char const* text, size_t length, uint64_t* outWhole, double* outFraction) {
+    size_t i = 0;
+    uint64_t whole = 0;
+    while (i < length && isdigit((unsigned char)text[i])) {
+        uint64_t digit = (uint64_t)(text[i] - '0');
+        if (whole > (UINT64_MAX - digit) / 10) return 0;
+        whole = whole * 10 + digit;
+        ++i;
+    }
+    size_t wholeDigits = i;
+    double fraction = 0.0;
+    if (i < length && text[i] == '.') {
+        ++i;
+        double scale = 0.1;
+        size_t fractionStart = i;
+        while (i < length && isdigit((unsigned char)text[i])) {
+            fraction += (text[i] - '0') * scale;
+            scale *= 0.1;
+            ++i;
         }
-        // We return the last one to allow adding values to it
-        return argument;
+        if (i == fractionStart) return 0;
     }
-
+    else if (wholeDigits == 0) {
+        return 0;
+    }
+    *outWhole = whole;
+    *outFraction = fraction;
+    return i;
+}
+
+// Scales a parsed decimal number by a unit, returns false on overflow
+static bool argparse_scale_decimal(uint64_t whole, double fraction, uint64_t unit, uint64_t limit, uint64_t* outValue) {
+    if (whole > limit / unit) return false;
+    uint64_t value = whole * unit;
+    // Rounding, as the fraction is inexact
+    uint64_t fractionValue = (uint64_t)(fraction * (double)unit + 0.5);
+    if (fractionValue > limit - value) return false;
+    *outValue = value + fractionValue;
+    return true;
+}
+
+static char* argparse_parse_duration(Argparse_Allocator* allocator, char const* text, size_t length, Argparse_Scalar* outScalar) {
+    static struct { char const* name; uint64_t nanoseconds; } const units[] = {
+        { "ns", 1ull },
+        { "us", 1000ull },
+        { "ms", 1000000ull },
+        { "s", 1000000000ull },
+        { "m", 60000000000ull },
+        { "h", 3600000000000ull },
+        { "d", 86400000000000ull },
+    };
+    uint64_t total = 0;
+    size_t i = 0;
+    if (length == 0) goto fail;
+    while (i < length) {
+        uint64_t whole;
+        double fraction;
+        size_t numberLength = argparse_parse_decimal_prefix(text + i, length - i, &whole, &fraction);
+        if (numberLength == 0) goto fail;
+        i += numberLength;
+        size_t unitStart = i;
+        while (i < length && isalpha((unsigned char)text[i])) ++i;
+        uint64_t unit = 0;
+        if (i == unitStart) {
+            // A plain number means seconds, but only on its own
+            if (unitStart != numberLength || i != length) goto fail;
+            unit = 1000000000ull;
+        }
+        for (size_t u = 0; u < sizeof(units) / sizeof(units[0]) && unit == 0; ++u) {
+            if (argparse_equals_ignore_case(text + unitStart, i - unitStart, units[u].name)) unit = units[u].nanoseconds;
+        }
+        if (unit == 0) goto fail;
+        uint64_t component;
+        if (!argparse_scale_decimal(whole, fraction, unit, (uint64_t)INT64_MAX - total, &component)) goto fail;
+        total += component;
+    }
+    outScalar->as_int64 = (int64_t)total;
+    return NULL;
+
+fail:
+    return argparse_format(allocator, "expected duration (for example 1h30m, 1.5s or 250ms), got '%.*s'", (int)length, text);
+}
+
+static char* argparse_parse_size(Argparse_Allocator* allocator, char const* text, size_t length, Argparse_Scalar* outScalar) {
+    uint64_t whole;
+    double fraction;
+    size_t numberLength = argparse_parse_decimal_prefix(text, length, &whole, &fraction);
+    if (numberLength == 0) goto fail;
+    char const* suffix = text + numberLength;
+    size_t suffixLength = length - numberLength;
+    // Strip the optional byte unit after the multiplier
+    if (suffixLength >= 2 && argparse_equals_ignore_case(suffix + suffixLength - 2, 2, "ib")) suffixLength -= 2;
+    else if (suffixLength >= 1 && (suffix[suffixLength - 1] == 'B' || suffix[suffixLength - 1] == 'b')) suffixLength -= 1;
+    uint64_t unit = 0;
+    if (suffixLength == 0) unit = 1;
+    else if (suffixLength == 1) {
+        switch (toupper((unsigned char)suffix[0])) {
+        case 'K': unit = 1ull << 10; break;
+        case 'M': unit = 1ull << 20; break;
+        case 'G': unit = 1ull << 30; break;
+        case 'T': unit = 1ull << 40; break;
+        default: break;
+        }
+    }
+    // "iB" on its own is not a unit
+    if (unit == 0 || (suffixLength == 0 && length - numberLength == 2)) goto fail;
+    if (!argparse_scale_decimal(whole, fraction, unit, UINT64_MAX, &outScalar->as_uint64)) goto fail;
+    return NULL;
+
+fail:
+    return argparse_format(allocator, "expected size (for example 512, 64K or 1.5GiB), got '%.*s'", (int)length, text);
+}
+
+// Parses a value of a built-in type into a scalar, returns an error message on failure
+static char* argparse_parse_scalar(Argparse_Allocator* allocator, Argparse_Option* option, char const* text, size_t length, Argparse_Scalar* outScalar) {
+    switch (option->type) {
+    case ARGPARSE_TYPE_INT64: {
+        bool negative = length > 0 && text[0] == '-';
+        size_t signLength = (length > 0 && (text[0] == '-' || text[0] == '+')) ? 1 : 0;
+        uint64_t magnitude;
+        if (argparse_parse_unsigned(text + signLength, length - signLength, &magnitude)
+         && magnitude <= (negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX)) {
+            // NOTE: Negating in the unsigned domain to handle INT64_MIN
+            outScalar->as_int64 = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+            return NULL;
+        }
+        return argparse_format(allocator, "expected integer, got '%.*s'", (int)length, text);
+    }
+    case ARGPARSE_TYPE_UINT64: {
+        size_t signLength = (length > 0 && text[0] == '+') ? 1 : 0;
+        if (argparse_parse_unsigned(text + signLength, length - signLength, &outScalar->as_uint64)) return NULL;
+        return argparse_format(allocator, "expected non-negative integer, got '%.*s'", (int)length, text);
+    }
+    case ARGPARSE_TYPE_DOUBLE: {
+        // strtod needs a terminated string, and numbers are short
+        char buffer[64];
+        if (length > 0 && length < sizeof(buffer) && !isspace((unsigned char)text[0])) {
+            memcpy(buffer, text, length);
+            buffer[length] = '\0';
+            char* end;
+            outScalar->as_double = strtod(buffer, &end);
+            if (end == buffer + length) return NULL;
+        }
+        return argparse_format(allocator, "expected number, got '%.*s'", (int)length, text);
+    }
+    case ARGPARSE_TYPE_BOOL: {
+        static char const* const trueNames[] = { "true", "yes", "on", "1" };
+        static char const* const falseNames[] = { "false", "no", "off", "0" };
+        for (size_t i = 0; i < sizeof(trueNames) / sizeof(trueNames[0]); ++i) {
+            if (argparse_equals_ignore_case(text, length, trueNames[i])) {
+                outScalar->as_bool = true;
+                return NULL;
+            }
+            if (argparse_equals_ignore_case(text, length, falseNames[i])) {
+                outScalar->as_bool = false;
+                return NULL;
+            }
+        }
+        return argparse_format(allocator, "expected boolean, got '%.*s'", (int)length, text);
+    }
+    case ARGPARSE_TYPE_ENUM: {
+        ARGPARSE_ASSERT(option->enum_values != NULL, "enum options must specify their accepted values");
+        for (Argparse_EnumValue const* entry = option->enum_values; entry->name != NULL; ++entry) {
+            if (strlen(entry->name) == length && memcmp(entry->name, text, length) == 0) {
+                outScalar->as_int64 = entry->value;
+                return NULL;
+            }
+        }
+        // List the accepted names in the error
+        char* error = argparse_format(allocator, "expected one of");
+        for (Argparse_EnumValue const* entry = option->enum_values; entry->name != NULL; ++entry) {
+            error = argparse_format(allocator, "%s%s '%s'", error, entry == option->enum_values ? "" : ",", entry->name);
+        }
+        return argparse_format(allocator, "%s, got '%.*s'", error, (int)length, text);
+    }
+    case ARGPARSE_TYPE_DURATION:
+        return argparse_parse_duration(allocator, text, length, outScalar);
+    case ARGPARSE_TYPE_SIZE:
+        return argparse_parse_size(allocator, text, length, outScalar);
+    case ARGPARSE_TYPE_STRING:
+        break;
+    }
+    ARGPARSE_ASSERT(false, "unknown option type");
+    return NULL;
+}
+
+// Construction ////////////////////////////////////////////////////////////////
+
+static Argparse_Argument* argparse_try_get_or_add_option_by_name(Argparse_Pack* pack, char const* name, size_t nameLength) {
+    Argparse_Option* option = argparse_find_option_with_name_n(pack->command, name, nameLength);
+    if (option == NULL) return NULL;
+
+    // The command accepts such argument, return the existing one or add a new one for this option
+    return argparse_get_or_add_argument_for_slot(pack, (size_t)(option - pack->command->options.elements));
+}
+
+static Argparse_Argument* argparse_try_add_option_argument(Argparse_Pack* pack, char const* name, size_t nameLength) {
+    // First, try a full option name match
+    Argparse_Argument* argument = argparse_try_get_or_add_option_by_name(pack, name, nameLength);
+    if (argument != NULL) return argument;
+
+    // Try bundling
+    if (argparse_is_legal_prefix_for_bundling(name, nameLength)) {
+        char nameBuffer[2];
+        nameBuffer[0] = name[0];
+        // Check, if all characters correspond to a short name
+        for (size_t i = 1; i < nameLength; ++i) {
+            nameBuffer[1] = name[i];
+            // NOTE: We don't add here yet, we first need to confirm a legal bundle
+            Argparse_Option* option = argparse_find_option_with_name_n(pack->command, nameBuffer, 2);
+            if (option == NULL) {
+                // Illegal bundling, some character did not correspond to a short name
+                return NULL;
+            }
+        }
+        // Legal, add all arguments for the bundled options
+        for (size_t i = 1; i < nameLength; ++i) {
+            nameBuffer[1] = name[i];
+            argument = argparse_try_get_or_add_option_by_name(pack, nameBuffer, 2);
+            // We know this won't be NULL since we checked above
+            ARGPARSE_ASSERT(argument != NULL, "unexpectedly failed to get argument for bundled option");
+        }
+        // We return the last one to allow adding values to it
+        return argument;
+    }
+
     // No luck
     return NULL;
 }
 
-static void argparse_parse_value_to_argument(Argparse_Pack* pack, Argparse_Argument* argument, char const* value, size_t valueLength) {
-    Argparse_Allocator* allocator = &pack->command->allocator;
-    // If there is a parser function, invoke it
+static void argparse_parse_value_to_argument(Argparse_Pack* pack, Argparse_Argument* argument, char const* value, size_t valueLength, bool nulTerminated) {
+    Argparse_Allocator* allocator = argparse_pack_allocator(pack);
+    Argparse_StringView text = { .data = value, .length = valueLength };
+    Argparse_Scalar scalar = { 0 };
     void* resultValue = NULL;
-    if (argument->option->parse_fn == NULL) {
-        // Paste the raw text as the value
-        char* valueCopy = (char*)argparse_realloc(allocator, NULL, (size_t)(valueLength + 1) * sizeof(char));
-        memcpy(valueCopy, value, valueLength);
-        valueCopy[valueLength] = '\0';
-        resultValue = valueCopy;
+    if (argument->option->type != ARGPARSE_TYPE_STRING) {
+        // Built-in type, stored inline
+        char* error = argparse_parse_scalar(allocator, argument->option, value, valueLength, &scalar);
+        if (error != NULL) {
+            argparse_add_error(pack, error);
+            return;
+        }
     }
-    else {
-        // Use the specified parser function
-        Argparse_ParseResult parseResult = argument->option->parse_fn(allocator, value, valueLength);
+    // Values for parser functions are only parsed on first access, we just keep their text until then
+    else if (argument->option->parse_fn == NULL) {
+        if (nulTerminated) {
+            // The raw text can be used as-is
+            resultValue = (void*)value;
+        }
+        else {
+            // Paste a terminated copy of the raw text as the value
+            char* valueCopy = (char*)argparse_realloc(allocator, NULL, (size_t)(valueLength + 1) * sizeof(char));
+            memcpy(valueCopy, value, valueLength);
+            valueCopy[valueLength] = '\0';
+            resultValue = valueCopy;
+        }
+    }
+    // Add the value to the argument
+    argparse_add_value_to_argument(pack, argument, resultValue, text, scalar);
+}
+
+// Runs the values of the argument through the parse function of its option, the first time the argument is accessed
+static void argparse_parse_argument_values(Argparse_Pack* pack, Argparse_Argument* argument) {
+    if (argument->is_parsed) return;
+    argument->is_parsed = true;
+    Argparse_ParseFn* parseFn = argument->option->parse_fn;
+    if (parseFn == NULL || argument->option->type != ARGPARSE_TYPE_STRING) return;
+
+    Argparse_Allocator* allocator = argparse_pack_allocator(pack);
+    size_t keptCount = 0;
+    for (size_t i = 0; i < argument->values.length; ++i) {
+        Argparse_StringView text = argument->values.texts[i];
+        Argparse_ParseResult parseResult = parseFn(allocator, text.data, text.length);
         if (parseResult.error != NULL) {
-            // Parsing failed, report error
+            // Parsing failed, report error and drop the value
             // This error is already expected to be heap-allocated, so we can just add it directly
             argparse_add_error(pack, parseResult.error);
-            return;
+            continue;
         }
-        resultValue = parseResult.value;
+        argument->values.elements[keptCount] = parseResult.value;
+        argument->values.texts[keptCount] = text;
+        ++keptCount;
     }
-    // Add the value to the argument
-    argparse_add_value_to_argument(pack, argument, resultValue);
+    argument->values.length = keptCount;
 }
 
 static Argparse_Argument* argparse_get_current_positional_argument_for_value(Argparse_Pack* pack) {
     // Look through the positional arguments in order they are declared in the command
-    for (size_t optionArgIndex = 0; optionArgIndex < pack->command->options.length; ++optionArgIndex) {
-        Argparse_Option* option = &pack->command->options.elements[optionArgIndex];
-        if (!argparse_is_positional_option(option)) continue;
-
-        // This is a positional argument, look for the corresponding argument in the pack
-        Argparse_Argument* argument = NULL;
-        for (size_t i = 0; i < pack->arguments.length; ++i) {
-            if (pack->arguments.elements[i].option == option) {
-                argument = &pack->arguments.elements[i];
-                break;
-            }
-        }
-        if (argument == NULL) {
+    if (pack->command->options.length == 0) return NULL;
+    Argparse_NameIndex* index = argparse_get_name_index(pack->command);
+    argparse_init_slots(pack);
+    // Arguments only ever gain values, so the ones that were full before stay full, and we can continue where we left off
+    for (size_t i = pack->positional_cursor; i < index->positional_count; ++i) {
+        pack->positional_cursor = i;
+        size_t slot = index->positionals[i];
+        if (pack->slots.elements[slot] == 0) {
             // We want this argument next, but it hasn't been added to the pack yet, so we add it
-            Argparse_Argument newArgument = {
-                .option = option,
-                .values = { 0 },
-            };
-            argparse_add_argument(pack, newArgument);
-            return &pack->arguments.elements[pack->arguments.length - 1];
+            return argparse_get_or_add_argument_for_slot(pack, slot);
         }
         // This argument is already present, check if it can take more values
+        Argparse_Argument* argument = &pack->arguments.elements[pack->slots.elements[slot] - 1];
         if (argparse_argument_can_take_value(argument)) {
             return argument;
         }
         // This argument cannot take more values, continue to the next one
     }
+    pack->positional_cursor = index->positional_count;
 
     return NULL;
 }
 
 static void argparse_validate_option_arity(Argparse_Pack* pack, Argparse_Option* option, Argparse_Argument* argument) {
-    Argparse_Allocator* allocator = &pack->command->allocator;
+    Argparse_Allocator* allocator = argparse_pack_allocator(pack);
     size_t valueCount = (argument != NULL) ? argument->values.length : 0;
     Argparse_Arity arity = option->arity;
     bool valid = false;
@@ -899,113 +1840,63 @@ static void argparse_validate_option_arity(Argparse_Pack* pack, Argparse_Option*
     }
 }
 
-// Public API //////////////////////////////////////////////////////////////////
-
-int argparse_run(int argc, char** argv, Argparse_Command* root) {
-    Argparse_Pack pack = argparse_parse(argc, argv, root);
-    if (pack.errors.length > 0) {
-        // Print errors
-        for (size_t i = 0; i < pack.errors.length; ++i) {
-            fprintf(stderr, "Error: %s\n", pack.errors.elements[i]);
-        }
-        // Print usage
-        argparse_print_usage(root);
-        argparse_free_pack(&pack);
-        return -1;
-    }
-    if (pack.command->handler_fn == NULL) {
-        fprintf(stderr, "Error: no handler specified for command '%s'\n", pack.command->name);
-        argparse_print_usage(root);
-        argparse_free_pack(&pack);
-        return -1;
-    }
-    int result = pack.command->handler_fn(&pack);
-    argparse_free_pack(&pack);
-    return result;
-}
-
-void argparse_print_usage(Argparse_Command* command) {
-    fprintf(stderr, "Usage: %s", command->name);
-    if (command->options.length > 0) {
-        fprintf(stderr, " [options]");
-    }
-    if (command->subcommands.length > 0) {
-        fprintf(stderr, " <subcommand>");
-    }
-    fprintf(stderr, "\n");
-    if (command->description != NULL) {
-        fprintf(stderr, "%s\n", command->description);
-    }
-    if (command->options.length > 0) {
-        fprintf(stderr, "Options:\n");
-        for (size_t i = 0; i < command->options.length; ++i) {
-            Argparse_Option* option = &command->options.elements[i];
-            char optionNames[128] = { 0 };
-            if (option->short_name != NULL) {
-                strcat(optionNames, option->short_name);
-                if (option->long_name != NULL) {
-                    strcat(optionNames, ", ");
-                }
-            }
-            if (option->long_name != NULL) {
-                strcat(optionNames, option->long_name);
-            }
-            fprintf(stderr, "  %-20s %s\n", optionNames, option->description != NULL ? option->description : "");
-        }
-    }
-    if (command->subcommands.length > 0) {
-        fprintf(stderr, "Subcommands:\n");
-        for (size_t i = 0; i < command->subcommands.length; ++i) {
-            Argparse_Command* subcommand = &command->subcommands.elements[i];
-            fprintf(stderr, "  %-20s %s\n", subcommand->name, subcommand->description != NULL ? subcommand->description : "");
+// Adds the argument holding the default value of the option in the slot, if it has one
+static Argparse_Argument* argparse_add_default_argument(Argparse_Pack* pack, size_t slot) {
+    Argparse_Option* option = &pack->command->options.elements[slot];
+    if (option->default_value_fn == NULL) return NULL;
+
+    void* value = option->default_value_fn(argparse_pack_allocator(pack), option);
+    Argparse_Argument* argument = argparse_get_or_add_argument_for_slot(pack, slot);
+    argument->is_default = true;
+    argument->is_parsed = true;
+    Argparse_Scalar scalar = { 0 };
+    if (option->type != ARGPARSE_TYPE_STRING) {
+        if (value == NULL) {
+            // No scalar to copy, the option has no default after all, which the argument without values remembers
+            argparse_validate_option_arity(pack, option, NULL);
+            return NULL;
         }
+        // Built-in types return their default as a scalar, which we store inline
+        scalar = *(Argparse_Scalar*)value;
+        value = NULL;
     }
+    argparse_add_value_to_argument(pack, argument, value, (Argparse_StringView){ 0 }, scalar);
+    return argument;
 }
 
-Argparse_Pack argparse_parse(int argc, char** argv, Argparse_Command* root) {
-    Argparse_Allocator* allocator = &root->allocator;
-    Argparse_Pack pack = { 0 };
-    pack.command = root;
-
-    if (argc == 0) {
-        // NOTE: We call argparse_format to move the error to the heap, we expect errors to be freeable
-        char* error = argparse_format(allocator, "no arguments provided");
-        argparse_add_error(&pack, error);
-        return pack;
-    }
-
-    pack.program_name = argv[0];
-    Argparse_Tokenizer tokenizer = {
-        .pack = &pack,
-        .argc = argc,
-        .argv = argv,
-        .argvIndex = 1,
-        .responseStack = { 0 },
-        .currentToken = { 0 },
-    };
+// Parses all tokens of the tokenizer into its pack, then validates the arity of the options of the resolved command
+static void argparse_parse_tokens(Argparse_Tokenizer* tokenizer) {
+    Argparse_Pack* pack = tokenizer->pack;
+    Argparse_Allocator* allocator = argparse_pack_allocator(pack);
 
     bool allowSubcommands = true;
     bool allowOptions = true;
     Argparse_Argument* currentArgument = NULL;
-    char* tokenText;
+    char const* tokenText;
     size_t tokenLength;
     bool endsInValueDelimiter = false;
     bool prevExpectsValue = false;
-    while (argparse_tokenizer_next(&tokenizer, &tokenText, &tokenLength, &endsInValueDelimiter)) {
+    while (argparse_tokenizer_next(tokenizer, &tokenText, &tokenLength, &endsInValueDelimiter)) {
         if (endsInValueDelimiter) {
-            ARGPARSE_ASSERT(!prevExpectsValue, "cannot have two consecutive tokens that end with value delimiters");
+            // Like '--name: --count=1', the previous option did not get its value, unknown options were reported already
+            if (prevExpectsValue && currentArgument != NULL) {
+                Argparse_Option const* option = currentArgument->option;
+                char const* optionName = (option->long_name == NULL) ? option->short_name : option->long_name;
+                char* error = argparse_format(allocator, "missing value for option '%s' before option '%.*s'", optionName, (int)tokenLength, tokenText);
+                argparse_add_error(pack, error);
+            }
             // A value specification bans subcommands
             allowSubcommands = false;
             // If we have already banned options, this is illegal
             if (!allowOptions) {
                 char* error = argparse_format(allocator, "unexpected option value '%.*s' after option escape", (int)tokenLength, tokenText);
-                argparse_add_error(&pack, error);
+                argparse_add_error(pack, error);
                 continue;
             }
-            currentArgument = argparse_try_add_option_argument(&pack, tokenText, tokenLength);
+            currentArgument = argparse_try_add_option_argument(pack, tokenText, tokenLength);
             if (currentArgument == NULL) {
                 char* error = argparse_format(allocator, "unknown option '%.*s'", (int)tokenLength, tokenText);
-                argparse_add_error(&pack, error);
+                argparse_add_error(pack, error);
                 // NOTE: We allow fallthrough here, we still parse a value to match intent closer
             }
             prevExpectsValue = true;
@@ -1015,11 +1906,12 @@ Argparse_Pack argparse_parse(int argc, char** argv, Argparse_Command* root) {
             // Has to be a value for prev. option
             if (currentArgument == NULL) {
                 // NOTE: We just throw it away, error should have been reported
-                ARGPARSE_ASSERT(pack.errors.length > 0, "an error was expected to be reported for throwaway value");
+                ARGPARSE_ASSERT(pack->errors.length > 0, "an error was expected to be reported for throwaway value");
                 continue;
             }
             else {
-                argparse_parse_value_to_argument(&pack, currentArgument, tokenText, tokenLength);
+                bool nulTerminated = argparse_tokenizer_is_nul_terminated(tokenizer, tokenText, tokenLength);
+                argparse_parse_value_to_argument(pack, currentArgument, tokenText, tokenLength, nulTerminated);
             }
             currentArgument = NULL;
             prevExpectsValue = false;
@@ -1036,10 +1928,10 @@ Argparse_Pack argparse_parse(int argc, char** argv, Argparse_Command* root) {
         if (allowSubcommands) {
             ARGPARSE_ASSERT(currentArgument == NULL, "cannot have a subcommand token after an option value");
             // Try to look up a subcommand first
-            Argparse_Command* sub = argparse_find_subcommand_with_name_n(pack.command, tokenText, tokenLength);
+            Argparse_Command* sub = argparse_find_subcommand_with_name_n(pack->command, tokenText, tokenLength);
             if (sub != NULL) {
                 // Step down, continue
-                pack.command = sub;
+                pack->command = sub;
                 continue;
             }
             // From here on out, subcommands are not allowed anymore, we have to parse options or arguments
@@ -1047,7 +1939,7 @@ Argparse_Pack argparse_parse(int argc, char** argv, Argparse_Command* root) {
         }
         // Try to parse as option
         if (allowOptions && argparse_is_legal_prefix_for_option(tokenText, tokenLength)) {
-            Argparse_Argument* asOption = argparse_try_add_option_argument(&pack, tokenText, tokenLength);
+            Argparse_Argument* asOption = argparse_try_add_option_argument(pack, tokenText, tokenLength);
             // If we failed, that's not an error here yet, we can still attempt to parse it as a value
             if (asOption != NULL) {
                 // But if we succeeded, save it
@@ -1056,134 +1948,748 @@ Argparse_Pack argparse_parse(int argc, char** argv, Argparse_Command* root) {
             }
         }
         // If the current argument can take more values, parse into that
+        bool nulTerminated = argparse_tokenizer_is_nul_terminated(tokenizer, tokenText, tokenLength);
         if (argparse_argument_can_take_value(currentArgument)) {
-            argparse_parse_value_to_argument(&pack, currentArgument, tokenText, tokenLength);
+            argparse_parse_value_to_argument(pack, currentArgument, tokenText, tokenLength, nulTerminated);
             continue;
         }
         // We have exhausted our options, look for the first positional argument that can take a value
-        currentArgument = argparse_get_current_positional_argument_for_value(&pack);
+        currentArgument = argparse_get_current_positional_argument_for_value(pack);
         if (currentArgument != NULL) {
-            argparse_parse_value_to_argument(&pack, currentArgument, tokenText, tokenLength);
+            argparse_parse_value_to_argument(pack, currentArgument, tokenText, tokenLength, nulTerminated);
             continue;
         }
         // No argument could take this value, report error
         char* error = argparse_format(allocator, "unexpected argument '%.*s'", (int)tokenLength, tokenText);
-        argparse_add_error(&pack, error);
+        argparse_add_error(pack, error);
     }
 
-    argparse_tokenizer_free(&tokenizer);
-
     // Now we need to validate the arity of each option
-    for (size_t i = 0; i < pack.command->options.length; ++i) {
-        Argparse_Option* option = &pack.command->options.elements[i];
-        Argparse_Argument* argument = NULL;
-        for (size_t j = 0; j < pack.arguments.length; ++j) {
-            if (pack.arguments.elements[j].option == option) {
-                argument = &pack.arguments.elements[j];
-                break;
-            }
-        }
-        argparse_validate_option_arity(&pack, option, argument);
+    argparse_init_slots(pack);
+    for (size_t i = 0; i < pack->command->options.length; ++i) {
+        Argparse_Option* option = &pack->command->options.elements[i];
+        Argparse_Argument* argument = argparse_find_argument_for_slot(pack, i);
+        // The default is checked against the arity when it's produced
+        if (argument == NULL && option->default_value_fn != NULL) continue;
+        argparse_validate_option_arity(pack, option, argument);
     }
+    argparse_reserve_arguments(pack);
+}
 
-    return pack;
+static void argparse_init_pack(Argparse_Pack* pack, Argparse_Arena* arena, Argparse_Command* root) {
+    *pack = (Argparse_Pack){ 0 };
+    pack->command = root;
+    pack->arena = arena;
 }
 
-Argparse_Argument* argparse_get_argument(Argparse_Pack* pack, char const* name) {
-    for (size_t i = 0; i < pack->arguments.length; ++i) {
-        if (argparse_option_has_name(pack->arguments.elements[i].option, name)) {
-            return &pack->arguments.elements[i];
-        }
+static void argparse_parse_argv_into(Argparse_Pack* pack, Argparse_Arena* arena, int argc, char** argv, Argparse_Command* root) {
+    argparse_init_pack(pack, arena, root);
+
+    if (argc == 0) {
+        // NOTE: We call argparse_format to move the error to the heap, we expect errors to be freeable
+        char* error = argparse_format(argparse_pack_allocator(pack), "no arguments provided");
+        argparse_add_error(pack, error);
+        return;
     }
-    return NULL;
+
+    pack->program_name = argv[0];
+    Argparse_Tokenizer tokenizer = {
+        .pack = pack,
+        .argc = argc,
+        .argv = argv,
+        .argvIndex = 1,
+        .responseStack = { 0 },
+        .responseFiles = { 0 },
+        .allowResponseFiles = true,
+        .currentToken = { 0 },
+    };
+    argparse_parse_tokens(&tokenizer);
+    argparse_tokenizer_free(&tokenizer);
 }
 
-Argparse_Argument* argparse_get_positional(Argparse_Pack* pack, size_t position) {
-    size_t positionalIndex = 0;
-    for (size_t i = 0; i < pack->command->options.length; ++i) {
-        Argparse_Option* option = &pack->command->options.elements[i];
-        if (!argparse_is_positional_option(option)) continue;
-        if (positionalIndex == position) {
-            // Found the right positional index, look for the corresponding argument
-            for (size_t j = 0; j < pack->arguments.length; ++j) {
-                if (pack->arguments.elements[j].option == option) {
-                    return &pack->arguments.elements[j];
-                }
-            }
-            // No argument found, this means this positional was not provided, we return NULL
-            return NULL;
-        }
-        ++positionalIndex;
-    }
-    // No such positional index
-    return NULL;
+static void argparse_parse_string_into(Argparse_Pack* pack, Argparse_Arena* arena, char const* commandLine, Argparse_Command* root) {
+    argparse_init_pack(pack, arena, root);
+    pack->program_name = root->name;
+
+    // We copy the command line into the arena, so values can point into it
+    size_t length = strlen(commandLine);
+    char* text = (char*)argparse_realloc(argparse_pack_allocator(pack), NULL, length);
+    memcpy(text, commandLine, length);
+    // The command line is tokenized as if it was the only response file
+    Argparse_Tokenizer tokenizer = {
+        .pack = pack,
+        .argc = 0,
+        .argv = NULL,
+        .argvIndex = 0,
+        .responseStack = { 0 },
+        .responseFiles = { 0 },
+        .allowResponseFiles = false,
+        .currentToken = { 0 },
+    };
+    argparse_tokenizer_push_response(&tokenizer, (Argparse_Response){
+        .text = text,
+        .length = length,
+        .index = 0,
+    });
+    argparse_parse_tokens(&tokenizer);
+    argparse_tokenizer_free(&tokenizer);
 }
 
-void argparse_free_pack(Argparse_Pack* pack) {
-    Argparse_Allocator* allocator = &pack->command->allocator;
-    // Free all allocated memory for the parsed arguments
-    // Do not deallocate the command or options, as they are owned by the command hierarchy
-    for (size_t i = 0; i < pack->arguments.length; ++i) {
-        Argparse_Argument* argument = &pack->arguments.elements[i];
-        for (size_t j = 0; j < argument->values.length; ++j) {
-            argparse_free(allocator, argument->values.elements[j]);
-        }
-        argparse_free(allocator, argument->values.elements);
-    }
-    argparse_free(allocator, pack->arguments.elements);
-    for (size_t i = 0; i < pack->errors.length; ++i) {
-        argparse_free(allocator, pack->errors.elements[i]);
-    }
-    argparse_free(allocator, pack->errors.elements);
+// Completion //////////////////////////////////////////////////////////////////
+
+static bool argparse_option_requires_value(Argparse_Option* option) {
+    return option->arity == ARGPARSE_ARITY_EXACTLY_ONE || option->arity == ARGPARSE_ARITY_ONE_OR_MORE;
 }
 
-void argparse_add_option(Argparse_Command* command, Argparse_Option option) {
-    ARGPARSE_ADD_TO_ARRAY(&command->allocator, command->options, option);
+static int argparse_compare_strings(void const* a, void const* b) {
+    return strcmp(*(char const* const*)a, *(char const* const*)b);
 }
 
-void argparse_add_subcommand(Argparse_Command* command, Argparse_Command subcommand) {
-    // Inherit allocator
-    subcommand.allocator = command->allocator;
-    ARGPARSE_ADD_TO_ARRAY(&subcommand.allocator, command->subcommands, subcommand);
+static void argparse_add_completion(Argparse_Completions* completions, char const* candidate) {
+    ARGPARSE_ADD_TO_ARRAY(&completions->command->allocator, *completions, candidate);
 }
 
-void argparse_free_command(Argparse_Command* command) {
-    // We assume name and description are static, so we don't free them
-    // We only free the options and subcommands arrays, as well as the subcommands themselves
-    for (size_t i = 0; i < command->subcommands.length; ++i) {
-        argparse_free_command(&command->subcommands.elements[i]);
+static void argparse_complete_enum_values(Argparse_Completions* completions, Argparse_Option* option, char const* prefix, size_t prefixLength) {
+    if (option->type != ARGPARSE_TYPE_ENUM || option->enum_values == NULL) return;
+    for (Argparse_EnumValue const* value = option->enum_values; value->name != NULL; ++value) {
+        if (strncmp(value->name, prefix, prefixLength) == 0) argparse_add_completion(completions, value->name);
     }
-    argparse_free(&command->allocator, command->subcommands.elements);
-    argparse_free(&command->allocator, command->options.elements);
-    // We null out the pointers to avoid double-free, in case this command is shared in the hierarchy
-    command->subcommands.elements = NULL;
-    command->options.elements = NULL;
+    // Keep the same order as names
+    qsort(completions->elements, completions->length, sizeof(char const*), argparse_compare_strings);
 }
 
-char* argparse_format(Argparse_Allocator* allocator, char const* format, ...) {
-    va_list args;
-    va_start(args, format);
-    char* result = argparse_vformat(allocator, format, args);
-    va_end(args);
-    return result;
+static void argparse_complete_names(Argparse_Completions* completions, char const* prefix, size_t prefixLength, bool allowSubcommands, bool allowOptions) {
+    Argparse_Command* command = completions->command;
+    if (command->options.length == 0 && command->subcommands.length == 0) return;
+    Argparse_NameIndex* index = argparse_get_name_index(command);
+    for (size_t i = argparse_name_index_lower_bound(index, prefix, prefixLength); i < index->sorted_count; ++i) {
+        Argparse_NameEntry* entry = index->sorted[i];
+        if (strncmp(entry->name, prefix, prefixLength) != 0) break;
+        if (entry->is_subcommand ? allowSubcommands : allowOptions) argparse_add_completion(completions, entry->name);
+    }
 }
 
-char* argparse_vformat(Argparse_Allocator* allocator, char const* format, va_list args) {
-    va_list args_copy;
-    va_copy(args_copy, args);
-    int length = vsnprintf(NULL, 0, format, args_copy);
-    ARGPARSE_ASSERT(length >= 0, "failed to compute length of formatted string");
-    va_end(args_copy);
-    char* buffer = (char*)argparse_realloc(allocator, NULL, (size_t)length + 1);
-    vsnprintf(buffer, (size_t)length + 1, format, args);
-    return buffer;
+// A growable string for generating completion scripts
+typedef struct Argparse_Buffer {
+    Argparse_Allocator* allocator;
+    char* elements;
+    size_t length;
+    size_t capacity;
+} Argparse_Buffer;
+
+static void argparse_buffer_reserve(Argparse_Buffer* buffer, size_t additional) {
+    if (buffer->length + additional + 1 <= buffer->capacity) return;
+    size_t newCapacity = (buffer->capacity == 0) ? 256 : buffer->capacity;
+    while (buffer->length + additional + 1 > newCapacity) newCapacity *= 2;
+    buffer->elements = (char*)argparse_realloc(buffer->allocator, buffer->elements, newCapacity);
+    buffer->capacity = newCapacity;
 }
 
-#ifdef __cplusplus
+static void argparse_buffer_puts(Argparse_Buffer* buffer, char const* text) {
+    size_t length = strlen(text);
+    argparse_buffer_reserve(buffer, length);
+    memcpy(buffer->elements + buffer->length, text, length + 1);
+    buffer->length += length;
 }
-#endif
-
-#undef ARGPARSE_ADD_TO_ARRAY
+
+static void argparse_buffer_format(Argparse_Buffer* buffer, char const* format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    int length = vsnprintf(NULL, 0, format, argsCopy);
+    ARGPARSE_ASSERT(length >= 0, "failed to compute length of formatted string");
+    va_end(argsCopy);
+    argparse_buffer_reserve(buffer, (size_t)length);
+    vsnprintf(buffer->elements + buffer->length, (size_t)length + 1, format, args);
+    buffer->length += (size_t)length;
+    va_end(args);
+}
+
+// Appends text so it can be placed between double quotes in bash and zsh, or between single quotes in fish
+static void argparse_buffer_put_quoted(Argparse_Buffer* buffer, char const* text, Argparse_Shell shell) {
+    for (char const* c = text; *c != '\0'; ++c) {
+        bool needsEscape = (shell == ARGPARSE_SHELL_FISH)
+            ? (*c == '\'' || *c == '\\')
+            : (*c == '"' || *c == '\\' || *c == '$' || *c == '`');
+        char piece[3] = { '\\', *c, '\0' };
+        argparse_buffer_puts(buffer, needsEscape ? piece : piece + 1);
+    }
+}
+
+// Appends the name of the command, with every character that can't be in a function name replaced
+static void argparse_buffer_put_identifier(Argparse_Buffer* buffer, char const* name) {
+    argparse_buffer_reserve(buffer, strlen(name));
+    for (char const* c = name; *c != '\0'; ++c) {
+        bool isAlnum = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9');
+        buffer->elements[buffer->length++] = isAlnum ? *c : '_';
+    }
+    buffer->elements[buffer->length] = '\0';
+}
+
+typedef enum Argparse_ScriptPart {
+    // The patterns that match a subcommand on the path
+    ARGPARSE_SCRIPT_SUBCOMMAND_PATHS,
+    // The cases that complete the value of an option
+    ARGPARSE_SCRIPT_OPTION_VALUES,
+    // The cases that complete the names of subcommands and options
+    ARGPARSE_SCRIPT_NAMES,
+} Argparse_ScriptPart;
+
+// Appends one part of a completion script for bash or zsh for the command at the path and all of its subcommands
+static void argparse_format_shell_script_part(Argparse_Buffer* buffer, Argparse_Buffer* path, Argparse_Command* command, Argparse_Shell shell, Argparse_ScriptPart part) {
+    switch (part) {
+    case ARGPARSE_SCRIPT_SUBCOMMAND_PATHS:
+        for (size_t i = 0; i < command->subcommands.length; ++i) {
+            argparse_buffer_puts(buffer, buffer->elements[buffer->length - 1] == '"' ? "|\"" : "\"");
+            argparse_buffer_put_quoted(buffer, path->elements, shell);
+            argparse_buffer_puts(buffer, " ");
+            argparse_buffer_put_quoted(buffer, command->subcommands.elements[i].name, shell);
+            argparse_buffer_puts(buffer, "\"");
+        }
+        break;
+    case ARGPARSE_SCRIPT_OPTION_VALUES:
+        for (size_t i = 0; i < command->options.length; ++i) {
+            Argparse_Option* option = &command->options.elements[i];
+            if (argparse_is_positional_option(option) || option->arity == ARGPARSE_ARITY_ZERO) continue;
+            char const* names[] = { option->long_name, option->short_name };
+            argparse_buffer_puts(buffer, "        ");
+            bool first = true;
+            for (size_t j = 0; j < 2; ++j) {
+                if (names[j] == NULL) continue;
+                argparse_buffer_puts(buffer, first ? "\"" : "|\"");
+                argparse_buffer_put_quoted(buffer, path->elements, shell);
+                argparse_buffer_puts(buffer, "|");
+                argparse_buffer_put_quoted(buffer, names[j], shell);
+                argparse_buffer_puts(buffer, "\"");
+                first = false;
+            }
+            if (option->type == ARGPARSE_TYPE_ENUM && option->enum_values != NULL) {
+                argparse_buffer_puts(buffer, shell == ARGPARSE_SHELL_BASH ? ") words=\"" : ") candidates=(");
+                for (Argparse_EnumValue const* value = option->enum_values; value->name != NULL; ++value) {
+                    if (value != option->enum_values) argparse_buffer_puts(buffer, " ");
+                    if (shell == ARGPARSE_SHELL_ZSH) argparse_buffer_puts(buffer, "\"");
+                    argparse_buffer_put_quoted(buffer, value->name, shell);
+                    if (shell == ARGPARSE_SHELL_ZSH) argparse_buffer_puts(buffer, "\"");
+                }
+                argparse_buffer_puts(buffer, shell == ARGPARSE_SHELL_BASH ? "\" ;;\n" : ") ;;\n");
+            }
+            else {
+                // Any other value is most likely a path
+                argparse_buffer_puts(buffer, shell == ARGPARSE_SHELL_BASH
+                    ? ") COMPREPLY=( $(compgen -f -- \"$cur\") ); return ;;\n"
+                    : ") _files; return ;;\n");
+            }
+        }
+        break;
+    case ARGPARSE_SCRIPT_NAMES:
+        argparse_buffer_puts(buffer, "                \"");
+        argparse_buffer_put_quoted(buffer, path->elements, shell);
+        argparse_buffer_puts(buffer, shell == ARGPARSE_SHELL_BASH ? "\") words=\"" : "\") candidates=(");
+        Argparse_NameIndex* index = argparse_get_name_index(command);
+        for (size_t i = 0; i < index->sorted_count; ++i) {
+            if (i > 0) argparse_buffer_puts(buffer, " ");
+            if (shell == ARGPARSE_SHELL_ZSH) argparse_buffer_puts(buffer, "\"");
+            argparse_buffer_put_quoted(buffer, index->sorted[i]->name, shell);
+            if (shell == ARGPARSE_SHELL_ZSH) argparse_buffer_puts(buffer, "\"");
+        }
+        argparse_buffer_puts(buffer, shell == ARGPARSE_SHELL_BASH ? "\" ;;\n" : ") ;;\n");
+        break;
+    }
+    // Recurse with the path extended by the name of each subcommand
+    for (size_t i = 0; i < command->subcommands.length; ++i) {
+        Argparse_Command* subcommand = &command->subcommands.elements[i];
+        size_t pathLength = path->length;
+        argparse_buffer_format(path, " %s", subcommand->name);
+        argparse_format_shell_script_part(buffer, path, subcommand, shell, part);
+        path->length = pathLength;
+        path->elements[pathLength] = '\0';
+    }
+}
+
+static void argparse_format_bash_or_zsh_script(Argparse_Buffer* buffer, Argparse_Command* root, Argparse_Shell shell) {
+    bool isBash = shell == ARGPARSE_SHELL_BASH;
+    Argparse_Buffer path = { .allocator = buffer->allocator };
+    argparse_buffer_puts(&path, root->name);
+
+    if (!isBash) argparse_buffer_format(buffer, "#compdef %s\n", root->name);
+    argparse_buffer_format(buffer, "# %s completion for %s, generated by argparse\n", isBash ? "bash" : "zsh", root->name);
+    argparse_buffer_puts(buffer, "_");
+    argparse_buffer_put_identifier(buffer, root->name);
+    argparse_buffer_puts(buffer, "_completion() {\n");
+    if (isBash) {
+        argparse_buffer_puts(buffer,
+            "    local cur=\"${COMP_WORDS[COMP_CWORD]}\" prev=\"\" words=\"\" i\n"
+            "    (( COMP_CWORD > 0 )) && prev=\"${COMP_WORDS[COMP_CWORD-1]}\"\n"
+            "    # Bash splits values like --mode=debug into separate words\n"
+            "    if [[ \"$cur\" == \"=\" || \"$cur\" == \":\" ]]; then\n"
+            "        cur=\"\"\n"
+            "    elif [[ ( \"$prev\" == \"=\" || \"$prev\" == \":\" ) && COMP_CWORD -gt 1 ]]; then\n"
+            "        prev=\"${COMP_WORDS[COMP_CWORD-2]}\"\n"
+            "    fi\n");
+    }
+    else {
+        argparse_buffer_puts(buffer,
+            "    local cur=\"${words[CURRENT]}\" prev=\"${words[CURRENT-1]}\" i\n"
+            "    local -a candidates\n"
+            "    if [[ \"$cur\" == [-/]*[=:]* ]]; then\n"
+            "        prev=\"${cur%%[=:]*}\"\n"
+            "        compset -P '*[=:]'\n"
+            "    fi\n");
+    }
+    argparse_buffer_puts(buffer, "    local cmd_path=\"");
+    argparse_buffer_put_quoted(buffer, root->name, shell);
+    argparse_buffer_puts(buffer, "\"\n");
+    // Subcommands can only come first, so the path ends at the first word that is not a subcommand
+    argparse_buffer_puts(buffer, isBash
+        ? "    for ((i = 1; i < COMP_CWORD; i++)); do\n        case \"${cmd_path} ${COMP_WORDS[i]}\" in\n"
+        : "    for ((i = 2; i < CURRENT; i++)); do\n        case \"${cmd_path} ${words[i]}\" in\n");
+    size_t casesStart = buffer->length;
+    argparse_buffer_puts(buffer, "            ");
+    size_t patternsStart = buffer->length;
+    argparse_format_shell_script_part(buffer, &path, root, shell, ARGPARSE_SCRIPT_SUBCOMMAND_PATHS);
+    if (buffer->length == patternsStart) {
+        // No subcommands, no patterns
+        buffer->length = casesStart;
+        buffer->elements[casesStart] = '\0';
+    }
+    else {
+        argparse_buffer_puts(buffer, isBash
+            ? ") cmd_path=\"${cmd_path} ${COMP_WORDS[i]}\" ;;\n"
+            : ") cmd_path=\"${cmd_path} ${words[i]}\" ;;\n");
+    }
+    argparse_buffer_puts(buffer, "            *) break ;;\n        esac\n    done\n");
+
+    argparse_buffer_puts(buffer, "    case \"${cmd_path}|${prev}\" in\n");
+    argparse_format_shell_script_part(buffer, &path, root, shell, ARGPARSE_SCRIPT_OPTION_VALUES);
+    argparse_buffer_puts(buffer, "        *)\n            case \"${cmd_path}\" in\n");
+    argparse_format_shell_script_part(buffer, &path, root, shell, ARGPARSE_SCRIPT_NAMES);
+    argparse_buffer_puts(buffer, "            esac ;;\n    esac\n");
+    argparse_buffer_puts(buffer, isBash
+        ? "    COMPREPLY=( $(compgen -W \"$words\" -- \"$cur\") )\n}\n"
+        : "    compadd -- \"${candidates[@]}\"\n}\n");
+    argparse_buffer_format(buffer, isBash ? "complete -F _" : "compdef _");
+    argparse_buffer_put_identifier(buffer, root->name);
+    argparse_buffer_format(buffer, "_completion %s\n", root->name);
+    argparse_free(path.allocator, path.elements);
+}
+
+// Appends the completions of the command at the path and all of its subcommands for fish
+static void argparse_format_fish_commands(Argparse_Buffer* buffer, Argparse_Buffer* path, Argparse_Command* command, Argparse_Command* root) {
+    for (size_t i = 0; i < command->subcommands.length + command->options.length; ++i) {
+        bool isSubcommand = i < command->subcommands.length;
+        Argparse_Option* option = isSubcommand ? NULL : &command->options.elements[i - command->subcommands.length];
+        if (option != NULL && argparse_is_positional_option(option)) continue;
+
+        argparse_buffer_format(buffer, "complete -c %s -n 'test (__", root->name);
+        argparse_buffer_put_identifier(buffer, root->name);
+        argparse_buffer_puts(buffer, "_completion_path) = \"");
+        argparse_buffer_put_quoted(buffer, path->elements, ARGPARSE_SHELL_FISH);
+        argparse_buffer_puts(buffer, "\"'");
+        char const* description;
+        if (isSubcommand) {
+            Argparse_Command* subcommand = &command->subcommands.elements[i];
+            argparse_buffer_puts(buffer, " -a '");
+            argparse_buffer_put_quoted(buffer, subcommand->name, ARGPARSE_SHELL_FISH);
+            argparse_buffer_puts(buffer, "'");
+            description = subcommand->description;
+        }
+        else {
+            char const* names[] = { option->long_name, option->short_name };
+            for (size_t j = 0; j < 2; ++j) {
+                char const* name = names[j];
+                if (name == NULL) continue;
+                size_t length = strlen(name);
+                // Fish has its own flags for each option style, anything else is completed as a plain argument
+                char const* flag =
+                    (length > 2 && name[0] == '-' && name[1] == '-') ? " -l '" :
+                    (length == 2 && name[0] == '-') ? " -s '" :
+                    (length > 2 && name[0] == '-') ? " -o '" : " -a '";
+                argparse_buffer_puts(buffer, flag);
+                argparse_buffer_put_quoted(buffer, (flag[2] == 'l') ? name + 2 : (flag[2] == 'a') ? name : name + 1, ARGPARSE_SHELL_FISH);
+                argparse_buffer_puts(buffer, "'");
+            }
+            if (option->type == ARGPARSE_TYPE_ENUM && option->enum_values != NULL) {
+                argparse_buffer_puts(buffer, " -x -a '");
+                for (Argparse_EnumValue const* value = option->enum_values; value->name != NULL; ++value) {
+                    if (value != option->enum_values) argparse_buffer_puts(buffer, " ");
+                    argparse_buffer_put_quoted(buffer, value->name, ARGPARSE_SHELL_FISH);
+                }
+                argparse_buffer_puts(buffer, "'");
+            }
+            else if (option->arity != ARGPARSE_ARITY_ZERO) {
+                argparse_buffer_puts(buffer, " -r -F");
+            }
+            description = option->description;
+        }
+        if (description != NULL) {
+            argparse_buffer_puts(buffer, " -d '");
+            argparse_buffer_put_quoted(buffer, description, ARGPARSE_SHELL_FISH);
+            argparse_buffer_puts(buffer, "'");
+        }
+        argparse_buffer_puts(buffer, "\n");
+    }
+    for (size_t i = 0; i < command->subcommands.length; ++i) {
+        Argparse_Command* subcommand = &command->subcommands.elements[i];
+        size_t pathLength = path->length;
+        argparse_buffer_format(path, " %s", subcommand->name);
+        argparse_format_fish_commands(buffer, path, subcommand, root);
+        path->length = pathLength;
+        path->elements[pathLength] = '\0';
+    }
+}
+
+// Appends the patterns of fish that match a subcommand on the path
+static void argparse_format_fish_subcommand_paths(Argparse_Buffer* buffer, Argparse_Buffer* path, Argparse_Command* command) {
+    for (size_t i = 0; i < command->subcommands.length; ++i) {
+        Argparse_Command* subcommand = &command->subcommands.elements[i];
+        size_t pathLength = path->length;
+        argparse_buffer_format(path, " %s", subcommand->name);
+        argparse_buffer_puts(buffer, " '");
+        argparse_buffer_put_quoted(buffer, path->elements, ARGPARSE_SHELL_FISH);
+        argparse_buffer_puts(buffer, "'");
+        argparse_format_fish_subcommand_paths(buffer, path, subcommand);
+        path->length = pathLength;
+        path->elements[pathLength] = '\0';
+    }
+}
+
+static void argparse_format_fish_script(Argparse_Buffer* buffer, Argparse_Command* root) {
+    Argparse_Buffer path = { .allocator = buffer->allocator };
+    argparse_buffer_puts(&path, root->name);
+
+    argparse_buffer_format(buffer, "# fish completion for %s, generated by argparse\n", root->name);
+    argparse_buffer_puts(buffer, "function __");
+    argparse_buffer_put_identifier(buffer, root->name);
+    argparse_buffer_puts(buffer, "_completion_path\n"
+        "    set -l tokens (commandline -opc)\n"
+        "    set -e tokens[1]\n"
+        "    set -l cmd_path '");
+    argparse_buffer_put_quoted(buffer, root->name, ARGPARSE_SHELL_FISH);
+    argparse_buffer_puts(buffer, "'\n"
+        "    for token in $tokens\n"
+        "        switch \"$cmd_path $token\"\n"
+        "            case");
+    size_t patternsStart = buffer->length;
+    argparse_format_fish_subcommand_paths(buffer, &path, root);
+    // Without subcommands, no pattern can match
+    if (buffer->length == patternsStart) argparse_buffer_puts(buffer, " ''");
+    argparse_buffer_puts(buffer, "\n"
+        "                set cmd_path \"$cmd_path $token\"\n"
+        "            case '*'\n"
+        "                break\n"
+        "        end\n"
+        "    end\n"
+        "    echo $cmd_path\n"
+        "end\n");
+    argparse_buffer_format(buffer, "complete -c %s -f\n", root->name);
+    argparse_format_fish_commands(buffer, &path, root, root);
+    argparse_free(path.allocator, path.elements);
+}
+
+// Public API //////////////////////////////////////////////////////////////////
+
+int argparse_run(int argc, char** argv, Argparse_Command* root) {
+    Argparse_Pack pack = argparse_parse(argc, argv, root);
+    if (!argparse_validate(&pack)) {
+        // Print errors
+        for (size_t i = 0; i < pack.errors.length; ++i) {
+            fprintf(stderr, "Error: %s\n", pack.errors.elements[i]);
+        }
+        // Print usage
+        argparse_print_usage(root);
+        argparse_free_pack(&pack);
+        return -1;
+    }
+    if (pack.command->handler_fn == NULL) {
+        fprintf(stderr, "Error: no handler specified for command '%s'\n", pack.command->name);
+        argparse_print_usage(root);
+        argparse_free_pack(&pack);
+        return -1;
+    }
+    int result = pack.command->handler_fn(&pack);
+    argparse_free_pack(&pack);
+    return result;
+}
+
+void argparse_print_usage(Argparse_Command* command) {
+    fprintf(stderr, "Usage: %s", command->name);
+    if (command->options.length > 0) {
+        fprintf(stderr, " [options]");
+    }
+    if (command->subcommands.length > 0) {
+        fprintf(stderr, " <subcommand>");
+    }
+    fprintf(stderr, "\n");
+    if (command->description != NULL) {
+        fprintf(stderr, "%s\n", command->description);
+    }
+    if (command->options.length > 0) {
+        fprintf(stderr, "Options:\n");
+        for (size_t i = 0; i < command->options.length; ++i) {
+            Argparse_Option* option = &command->options.elements[i];
+            char optionNames[128] = { 0 };
+            if (option->short_name != NULL) {
+                strcat(optionNames, option->short_name);
+                if (option->long_name != NULL) {
+                    strcat(optionNames, ", ");
+                }
+            }
+            if (option->long_name != NULL) {
+                strcat(optionNames, option->long_name);
+            }
+            fprintf(stderr, "  %-20s %s\n", optionNames, option->description != NULL ? option->description : "");
+        }
+    }
+    if (command->subcommands.length > 0) {
+        fprintf(stderr, "Subcommands:\n");
+        for (size_t i = 0; i < command->subcommands.length; ++i) {
+            Argparse_Command* subcommand = &command->subcommands.elements[i];
+            fprintf(stderr, "  %-20s %s\n", subcommand->name, subcommand->description != NULL ? subcommand->description : "");
+        }
+    }
+}
+
+Argparse_Completions argparse_complete(int argc, char** argv, Argparse_Command* root) {
+    Argparse_Completions completions = { .command = root };
+    bool allowSubcommands = true;
+    bool allowOptions = true;
+    // The option that the next argument is a value for
+    Argparse_Option* valueFor = NULL;
+    for (int i = 1; i < argc - 1; ++i) {
+        char const* word = argv[i];
+        size_t length = strlen(word);
+        if (valueFor != NULL) {
+            valueFor = NULL;
+            continue;
+        }
+        if (allowOptions && strcmp(word, "--") == 0) {
+            allowSubcommands = false;
+            allowOptions = false;
+            continue;
+        }
+        if (allowSubcommands) {
+            Argparse_Command* subcommand = argparse_find_subcommand_with_name_n(completions.command, word, length);
+            if (subcommand != NULL) {
+                completions.command = subcommand;
+                continue;
+            }
+            allowSubcommands = false;
+        }
+        if (allowOptions && argparse_is_legal_prefix_for_option(word, length)) {
+            Argparse_Option* option = argparse_find_option_with_name_n(completions.command, word, length);
+            if (option != NULL && option->arity != ARGPARSE_ARITY_ZERO) valueFor = option;
+        }
+    }
+
+    char const* current = (argc >= 2) ? argv[argc - 1] : "";
+    size_t currentLength = strlen(current);
+    if (allowOptions && argparse_is_legal_prefix_for_option(current, currentLength)) {
+        // A value after a delimiter completes the value only
+        for (size_t i = 1; i < currentLength; ++i) {
+            if (!argparse_is_value_delimiter(current[i])) continue;
+            Argparse_Option* option = argparse_find_option_with_name_n(completions.command, current, i);
+            if (option != NULL) argparse_complete_enum_values(&completions, option, current + i + 1, currentLength - i - 1);
+            return completions;
+        }
+    }
+    if (valueFor != NULL && !argparse_is_legal_prefix_for_option(current, currentLength)) {
+        argparse_complete_enum_values(&completions, valueFor, current, currentLength);
+        // A required value can't be anything else, an optional one can be skipped
+        if (argparse_option_requires_value(valueFor)) return completions;
+    }
+    size_t valueCount = completions.length;
+    argparse_complete_names(&completions, current, currentLength, allowSubcommands, allowOptions);
+    if (valueCount > 0 && completions.length > valueCount) {
+        // Merge the values and the names into a single order
+        qsort(completions.elements, completions.length, sizeof(char const*), argparse_compare_strings);
+    }
+    return completions;
+}
+
+void argparse_free_completions(Argparse_Completions* completions) {
+    if (completions->command != NULL) argparse_free(&completions->command->allocator, completions->elements);
+    completions->elements = NULL;
+    completions->length = 0;
+    completions->capacity = 0;
+}
+
+char* argparse_format_completion_script(Argparse_Command* root, Argparse_Shell shell) {
+    Argparse_Buffer buffer = { .allocator = &root->allocator };
+    argparse_buffer_reserve(&buffer, 0);
+    buffer.elements[0] = '\0';
+    switch (shell) {
+    case ARGPARSE_SHELL_BASH:
+    case ARGPARSE_SHELL_ZSH:
+        argparse_format_bash_or_zsh_script(&buffer, root, shell);
+        break;
+    case ARGPARSE_SHELL_FISH:
+        argparse_format_fish_script(&buffer, root);
+        break;
+    }
+    return buffer.elements;
+}
+
+Argparse_Pack argparse_parse(int argc, char** argv, Argparse_Command* root) {
+    Argparse_Pack pack;
+    argparse_parse_argv_into(&pack, argparse_arena_new(&root->allocator), argc, argv, root);
+    return pack;
+}
+
+Argparse_Pack argparse_parse_string(char const* command_line, Argparse_Command* root) {
+    Argparse_Pack pack;
+    argparse_parse_string_into(&pack, argparse_arena_new(&root->allocator), command_line, root);
+    return pack;
+}
+
+Argparse_Parser argparse_create_parser(Argparse_Command* root) {
+    // Compiling up front means parsing won't touch the tree anymore
+    argparse_compile_command(root);
+    return (Argparse_Parser){
+        .root = root,
+        .pack = { 0 },
+        .arena = argparse_arena_new(&root->allocator),
+    };
+}
+
+Argparse_Pack* argparse_parser_parse(Argparse_Parser* parser, int argc, char** argv) {
+    argparse_arena_reset(parser->arena);
+    argparse_parse_argv_into(&parser->pack, parser->arena, argc, argv, parser->root);
+    return &parser->pack;
+}
+
+Argparse_Pack* argparse_parser_parse_string(Argparse_Parser* parser, char const* command_line) {
+    argparse_arena_reset(parser->arena);
+    argparse_parse_string_into(&parser->pack, parser->arena, command_line, parser->root);
+    return &parser->pack;
+}
+
+void argparse_free_parser(Argparse_Parser* parser) {
+    argparse_arena_delete(parser->arena);
+    parser->arena = NULL;
+    parser->pack = (Argparse_Pack){ 0 };
+}
+
+Argparse_Argument* argparse_get_argument(Argparse_Pack* pack, char const* name) {
+    if (name == NULL) return NULL;
+    Argparse_Option* option = argparse_find_option_with_name_n(pack->command, name, strlen(name));
+    if (option == NULL) return NULL;
+    return argparse_get_argument_by_slot(pack, (size_t)(option - pack->command->options.elements));
+}
+
+Argparse_Argument* argparse_get_argument_by_slot(Argparse_Pack* pack, size_t slot) {
+    if (slot >= pack->slots.length) return NULL;
+    Argparse_Argument* argument = argparse_find_argument_for_slot(pack, slot);
+    if (argument == NULL) return argparse_add_default_argument(pack, slot);
+    // The default function was called before, and produced no default
+    if (argument->is_default && argument->values.length == 0) return NULL;
+    argparse_parse_argument_values(pack, argument);
+    return argument;
+}
+
+Argparse_Argument* argparse_get_positional(Argparse_Pack* pack, size_t position) {
+    if (pack->command->options.length == 0) return NULL;
+    Argparse_NameIndex* index = argparse_get_name_index(pack->command);
+    // No such positional index
+    if (position >= index->positional_count) return NULL;
+    // NULL if this positional was not provided
+    return argparse_get_argument_by_slot(pack, index->positionals[position]);
+}
+
+bool argparse_validate(Argparse_Pack* pack) {
+    // Whether a required option is missing depends on its default
+    for (size_t slot = 0; slot < pack->slots.length; ++slot) {
+        Argparse_Option* option = &pack->command->options.elements[slot];
+        bool required = option->arity == ARGPARSE_ARITY_EXACTLY_ONE || option->arity == ARGPARSE_ARITY_ONE_OR_MORE;
+        if (required && option->default_value_fn != NULL && argparse_find_argument_for_slot(pack, slot) == NULL) argparse_add_default_argument(pack, slot);
+    }
+    for (size_t i = 0; i < pack->arguments.length; ++i) {
+        argparse_parse_argument_values(pack, &pack->arguments.elements[i]);
+    }
+    return pack->errors.length == 0;
+}
+
+void argparse_free_pack(Argparse_Pack* pack) {
+    // Everything the pack owns lives in its arena
+    // Do not deallocate the command or options, as they are owned by the command hierarchy
+    argparse_arena_delete(pack->arena);
+    pack->arena = NULL;
+    pack->arguments.elements = NULL;
+    pack->arguments.length = 0;
+    pack->arguments.capacity = 0;
+    pack->slots.elements = NULL;
+    pack->slots.length = 0;
+    pack->errors.elements = NULL;
+    pack->errors.length = 0;
+    pack->errors.capacity = 0;
+}
+
+size_t argparse_add_option(Argparse_Command* command, Argparse_Option option) {
+    // The index is rebuilt on the next lookup
+    argparse_name_index_free(command);
+    ARGPARSE_ADD_TO_ARRAY(&command->allocator, command->options, option);
+    return command->options.length - 1;
+}
+
+void argparse_add_subcommand(Argparse_Command* command, Argparse_Command subcommand) {
+    argparse_name_index_free(command);
+    // An index built while the subcommand was looked up on its own is dropped, with the allocator it was made with,
+    // the added copy builds its own, so it can be freed along with the hierarchy
+    argparse_name_index_free(&subcommand);
+    // Inherit allocator
+    subcommand.allocator = command->allocator;
+    ARGPARSE_ADD_TO_ARRAY(&subcommand.allocator, command->subcommands, subcommand);
+}
+
+void argparse_compile_command(Argparse_Command* command) {
+    argparse_get_name_index(command);
+    for (size_t i = 0; i < command->subcommands.length; ++i) {
+        argparse_compile_command(&command->subcommands.elements[i]);
+    }
+}
+
+void argparse_free_command(Argparse_Command* command) {
+    // We assume name and description are static, so we don't free them
+    // We only free the options and subcommands arrays, as well as the subcommands themselves
+    for (size_t i = 0; i < command->subcommands.length; ++i) {
+        argparse_free_command(&command->subcommands.elements[i]);
+    }
+    argparse_free(&command->allocator, command->subcommands.elements);
+    argparse_free(&command->allocator, command->options.elements);
+    argparse_name_index_free(command);
+    // We null out the pointers to avoid double-free, in case this command is shared in the hierarchy
+    command->subcommands.elements = NULL;
+    command->options.elements = NULL;
+}
+
+char* argparse_format(Argparse_Allocator* allocator, char const* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char* result = argparse_vformat(allocator, format, args);
+    va_end(args);
+    return result;
+}
+
+char* argparse_vformat(Argparse_Allocator* allocator, char const* format, va_list args) {
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int length = vsnprintf(NULL, 0, format, args_copy);
+    ARGPARSE_ASSERT(length >= 0, "failed to compute length of formatted string");
+    va_end(args_copy);
+    char* buffer = (char*)argparse_realloc(allocator, NULL, (size_t)length + 1);
+    vsnprintf(buffer, (size_t)length + 1, format, args);
+    return buffer;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#undef ARGPARSE_ADD_TO_ARRAY
+#undef ARGPARSE_ARENA_ALIGNMENT
+#undef ARGPARSE_ARENA_MIN_CHUNK_SIZE
+#undef ARGPARSE_ARENA_CHUNK_HEADER_SIZE
+#undef __ARGPARSE_MMAP
 
 #endif /* ARGPARSE_IMPLEMENTATION */
 
@@ -1724,22 +3230,792 @@ CTEST_CASE(parse_nested_subcommands) {
     argparse_free_command(&root);
 }
 
-CTEST_CASE(unknown_subcommand_treated_as_positional) {
-    Argparse_Command cmd = { .name = "test" };
-    argparse_add_subcommand(&cmd, (Argparse_Command){ .name = "run" });
-    argparse_add_option(&cmd, (Argparse_Option){
-        .description = "args",
-        .arity = ARGPARSE_ARITY_ZERO_OR_MORE,
-    });
+CTEST_CASE(unknown_subcommand_treated_as_positional) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_subcommand(&cmd, (Argparse_Command){ .name = "run" });
+    argparse_add_option(&cmd, (Argparse_Option){
+        .description = "args",
+        .arity = ARGPARSE_ARITY_ZERO_OR_MORE,
+    });
+
+    char* argv[] = { "test", "unknown" };
+    Argparse_Pack pack = argparse_parse(2, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    // Should stay at root command since "unknown" is not a subcommand
+    CTEST_ASSERT_TRUE(strcmp(pack.command->name, "test") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+// Name index tests ////////////////////////////////////////////////////////////
+
+CTEST_CASE(name_index_finds_options_among_many) {
+    static char longNames[300][16];
+    static char shortNames[26][3];
+    Argparse_Command cmd = { .name = "test" };
+    for (size_t i = 0; i < 300; ++i) {
+        snprintf(longNames[i], sizeof(longNames[i]), "--option-%zu", i);
+        argparse_add_option(&cmd, (Argparse_Option){
+            .long_name = longNames[i],
+            .short_name = i < 26 ? shortNames[i] : NULL,
+            .arity = ARGPARSE_ARITY_ZERO_OR_ONE,
+        });
+        if (i < 26) {
+            shortNames[i][0] = '-';
+            shortNames[i][1] = (char)('a' + i);
+            shortNames[i][2] = '\0';
+        }
+    }
+
+    char* argv[] = { "program", "--option-3000", "--option-0", "--option-299=last", "--option-150:middle", "-xyz" };
+    Argparse_Pack pack = argparse_parse(6, argv, &cmd);
+
+    ASSERT_ERROR_COUNT(pack, 1);
+    CTEST_ASSERT_TRUE(has_option(&pack, "--option-0"));
+    CTEST_ASSERT_TRUE(strcmp(get_string_value(&pack, "--option-299"), "last") == 0);
+    CTEST_ASSERT_TRUE(strcmp(get_string_value(&pack, "--option-150"), "middle") == 0);
+    CTEST_ASSERT_TRUE(has_option(&pack, "--option-23"));
+    CTEST_ASSERT_TRUE(has_option(&pack, "--option-24"));
+    CTEST_ASSERT_TRUE(has_option(&pack, "--option-25"));
+    CTEST_ASSERT_TRUE(!has_option(&pack, "--option-1"));
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(name_index_rebuilt_after_adding_options) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--first", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_compile_command(&cmd);
+    CTEST_ASSERT_TRUE(cmd.name_index != NULL);
+
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--second", .arity = ARGPARSE_ARITY_ZERO });
+    CTEST_ASSERT_TRUE(cmd.name_index == NULL);
+
+    char* argv[] = { "program", "--first", "--second" };
+    Argparse_Pack pack = argparse_parse(3, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(has_option(&pack, "--first"));
+    CTEST_ASSERT_TRUE(has_option(&pack, "--second"));
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(name_index_compiles_whole_hierarchy) {
+    Argparse_Command root = { .name = "tool" };
+    Argparse_Command sub = { .name = "remote" };
+    argparse_add_option(&sub, (Argparse_Option){ .long_name = "--verbose", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_subcommand(&root, sub);
+    argparse_add_subcommand(&root, (Argparse_Command){ .name = "--verbose" });
+    argparse_compile_command(&root);
+    CTEST_ASSERT_TRUE(root.name_index != NULL);
+    CTEST_ASSERT_TRUE(root.subcommands.elements[0].name_index != NULL);
+    CTEST_ASSERT_TRUE(root.subcommands.elements[1].name_index != NULL);
+
+    char* argv[] = { "tool", "remote", "--verbose" };
+    Argparse_Pack pack = argparse_parse(3, argv, &root);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(strcmp(pack.command->name, "remote") == 0);
+    CTEST_ASSERT_TRUE(has_option(&pack, "--verbose"));
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&root);
+}
+
+CTEST_CASE(name_index_first_duplicate_wins) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .description = "first", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .description = "second", .arity = ARGPARSE_ARITY_ZERO_OR_ONE });
+
+    char* argv[] = { "program", "--name", "value" };
+    Argparse_Pack pack = argparse_parse(3, argv, &cmd);
+
+    CTEST_ASSERT_TRUE(strcmp(argparse_get_argument(&pack, "--name")->option->description, "first") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(positional_values_fill_positionals_in_order) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--flag", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ONE_OR_MORE });
+
+    char* argv[] = { "program", "a", "b", "--flag", "c", "d" };
+    Argparse_Pack pack = argparse_parse(6, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(strcmp(get_positional_string(&pack, 0), "a") == 0);
+    CTEST_ASSERT_TRUE(strcmp(get_positional_string(&pack, 1), "b") == 0);
+    Argparse_Argument* rest = argparse_get_positional(&pack, 2);
+    CTEST_ASSERT_TRUE(rest->values.length == 2);
+    CTEST_ASSERT_TRUE(strcmp((char const*)rest->values.elements[0], "c") == 0);
+    CTEST_ASSERT_TRUE(strcmp((char const*)rest->values.elements[1], "d") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+static void parse_positionals_bench(CTest_BenchState* state) {
+    Argparse_Command cmd = { .name = "bench" };
+    char** argv = (char**)malloc((state->size + 1) * sizeof(char*));
+    argv[0] = "bench";
+    for (size_t i = 0; i < state->size; ++i) {
+        argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+        argv[i + 1] = "value";
+    }
+    argparse_compile_command(&cmd);
+    ctest_bench_reset_timer(state);
+    for (size_t i = 0; i < state->iterations; ++i) {
+        Argparse_Pack pack = argparse_parse((int)state->size + 1, argv, &cmd);
+        CTEST_DO_NOT_OPTIMIZE(pack.arguments.length);
+        argparse_free_pack(&pack);
+    }
+    free(argv);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(positional_assignment_scales_linearly) {
+    // Each value continues from the positional the previous one went to, rescanning from the first would make this quadratic.
+    // The bound allows n log n, because thousands of options and their arguments outgrow the cache and each value gets slower.
+    CTEST_ASSERT_COMPLEXITY(parse_positionals_bench, CTEST_COMPLEXITY_N_LOG_N);
+}
+
+// Slot access tests ///////////////////////////////////////////////////////////
+
+CTEST_CASE(add_option_returns_dense_slots) {
+    Argparse_Command cmd = { .name = "test" };
+    size_t verboseSlot = argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--verbose", .arity = ARGPARSE_ARITY_ZERO });
+    size_t nameSlot = argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    size_t fileSlot = argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_ONE });
+    CTEST_ASSERT_TRUE(verboseSlot == 0);
+    CTEST_ASSERT_TRUE(nameSlot == 1);
+    CTEST_ASSERT_TRUE(fileSlot == 2);
+
+    char* argv[] = { "program", "--name", "value", "file.txt" };
+    Argparse_Pack pack = argparse_parse(4, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(argparse_get_argument_by_slot(&pack, verboseSlot) == NULL);
+    CTEST_ASSERT_TRUE(argparse_get_argument_by_slot(&pack, nameSlot) == argparse_get_argument(&pack, "--name"));
+    CTEST_ASSERT_TRUE(argparse_get_argument_by_slot(&pack, fileSlot) == argparse_get_positional(&pack, 0));
+    CTEST_ASSERT_TRUE(strcmp((char const*)argparse_get_argument_by_slot(&pack, fileSlot)->values.elements[0], "file.txt") == 0);
+    CTEST_ASSERT_TRUE(argparse_get_argument_by_slot(&pack, 3) == NULL);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(slots_refer_to_resolved_subcommand) {
+    Argparse_Command root = { .name = "tool" };
+    argparse_add_option(&root, (Argparse_Option){ .long_name = "--root-flag", .arity = ARGPARSE_ARITY_ZERO });
+    Argparse_Command sub = { .name = "build" };
+    size_t releaseSlot = argparse_add_option(&sub, (Argparse_Option){ .long_name = "--release", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_subcommand(&root, sub);
+
+    char* argv[] = { "tool", "build", "--release" };
+    Argparse_Pack pack = argparse_parse(3, argv, &root);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(releaseSlot == 0);
+    CTEST_ASSERT_TRUE(argparse_get_argument_by_slot(&pack, releaseSlot) != NULL);
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--root-flag") == NULL);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&root);
+}
+
+CTEST_CASE(positionals_skip_named_options) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--flag", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ONE_OR_MORE });
+
+    char* argv[] = { "program", "first", "--flag", "second", "third" };
+    Argparse_Pack pack = argparse_parse(5, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(strcmp(get_positional_string(&pack, 0), "first") == 0);
+    CTEST_ASSERT_TRUE(argparse_get_positional(&pack, 1)->values.length == 2);
+    CTEST_ASSERT_TRUE(argparse_get_positional(&pack, 1) == argparse_get_argument_by_slot(&pack, 2));
+    CTEST_ASSERT_TRUE(argparse_get_positional(&pack, 2) == NULL);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+// Arena and zero-copy tests //////////////////////////////////////////////////
+
+typedef struct CountingContext {
+    size_t allocations;
+    size_t frees;
+} CountingContext;
+
+static void* counting_realloc(void* ctx, void* ptr, size_t new_size) {
+    CountingContext* counter = (CountingContext*)ctx;
+    if (ptr == NULL) ++counter->allocations;
+    return realloc(ptr, new_size);
+}
+
+static void counting_free(void* ctx, void* ptr) {
+    CountingContext* counter = (CountingContext*)ctx;
+    if (ptr != NULL) ++counter->frees;
+    free(ptr);
+}
+
+CTEST_CASE(compiled_subcommand_index_is_freed_when_added) {
+    CountingContext counter = { 0 };
+    Argparse_Allocator allocator = { .context = &counter, .realloc = counting_realloc, .free = counting_free };
+    Argparse_Command root = { .name = "tool", .allocator = allocator };
+    Argparse_Command sub = { .name = "remote", .allocator = allocator };
+    argparse_add_option(&sub, (Argparse_Option){ .long_name = "--verbose", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_compile_command(&sub);
+    CTEST_ASSERT_TRUE(sub.name_index != NULL);
+    argparse_add_subcommand(&root, sub);
+
+    char* argv[] = { "tool", "remote", "--verbose" };
+    Argparse_Pack pack = argparse_parse(3, argv, &root);
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(strcmp(pack.command->name, "remote") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&root);
+    CTEST_ASSERT_TRUE(counter.allocations == counter.frees);
+}
+
+CTEST_CASE(raw_values_point_into_argv) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--other", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+
+    char* argv[] = { "program", "--name", "value", "--other=tail", "file.txt" };
+    Argparse_Pack pack = argparse_parse(5, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* name = argparse_get_argument(&pack, "--name");
+    CTEST_ASSERT_TRUE(name->values.elements[0] == argv[2]);
+    CTEST_ASSERT_TRUE(name->values.texts[0].data == argv[2]);
+    CTEST_ASSERT_TRUE(name->values.texts[0].length == 5);
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--other")->values.elements[0] == argv[3] + 8);
+    CTEST_ASSERT_TRUE(argparse_get_positional(&pack, 0)->values.elements[0] == argv[4]);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(quoted_argv_values_are_copied) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+
+    char* argv[] = { "program", "--name='quoted value'" };
+    Argparse_Pack pack = argparse_parse(2, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* name = argparse_get_argument(&pack, "--name");
+    CTEST_ASSERT_TRUE(strcmp((char const*)name->values.elements[0], "quoted value") == 0);
+    CTEST_ASSERT_TRUE(name->values.texts[0].data == argv[1] + 8);
+    CTEST_ASSERT_TRUE(name->values.texts[0].length == 12);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(response_file_values_have_views_into_file) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--message", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--path", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+
+    char* argv[] = { "program", "@test_inputs/argparse/quoted_args.txt" };
+    Argparse_Pack pack = argparse_parse(2, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_StringView message = argparse_get_argument(&pack, "--message")->values.texts[0];
+    Argparse_StringView path = argparse_get_argument(&pack, "--path")->values.texts[0];
+    CTEST_ASSERT_TRUE(message.length == 11 && strncmp(message.data, "hello world", 11) == 0);
+    CTEST_ASSERT_TRUE(path.length == 20 && strncmp(path.data, "C:\\Program Files\\App", 20) == 0);
+    // Both views point into the same response file buffer
+    CTEST_ASSERT_TRUE(message.data < path.data && path.data - message.data < 64);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(pack_memory_comes_from_few_allocations) {
+    static char values[10000][8];
+    static char* argv[10001];
+    CountingContext counter = { 0 };
+    Argparse_Command cmd = {
+        .name = "test",
+        .allocator = { .context = &counter, .realloc = counting_realloc, .free = counting_free },
+    };
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ONE_OR_MORE, .parse_fn = parse_int });
+    argparse_compile_command(&cmd);
+
+    argv[0] = "program";
+    for (size_t i = 0; i < 10000; ++i) {
+        snprintf(values[i], sizeof(values[i]), "%zu", i);
+        argv[i + 1] = values[i];
+    }
+    size_t allocationsBefore = counter.allocations;
+    size_t freesBefore = counter.frees;
+    Argparse_Pack pack = argparse_parse(10001, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* arg = argparse_get_positional(&pack, 0);
+    CTEST_ASSERT_TRUE(arg->values.length == 10000);
+    CTEST_ASSERT_TRUE(*(int*)arg->values.elements[9999] == 9999);
+    CTEST_ASSERT_TRUE(counter.allocations - allocationsBefore <= 16);
+
+    argparse_free_pack(&pack);
+    CTEST_ASSERT_TRUE(counter.allocations - allocationsBefore == counter.frees - freesBefore);
+
+    argparse_free_command(&cmd);
+}
+
+// Typed value tests ///////////////////////////////////////////////////////////
+
+// Parses a single value of the specified type, returns true on success
+static bool parse_typed(Argparse_Type type, char* text, Argparse_Scalar* outScalar) {
+    static Argparse_EnumValue const modes[] = {
+        { "fast", 1 },
+        { "slow", 2 },
+        { NULL, 0 },
+    };
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){
+        .long_name = "--value",
+        .arity = ARGPARSE_ARITY_EXACTLY_ONE,
+        .type = type,
+        .enum_values = modes,
+    });
+    char* argv[] = { "program", "--value", text };
+    Argparse_Pack pack = argparse_parse(3, argv, &cmd);
+    bool success = pack.errors.length == 0;
+    if (success) {
+        Argparse_Argument* arg = argparse_get_argument(&pack, "--value");
+        CTEST_ASSERT_TRUE(arg->values.elements[0] == NULL);
+        CTEST_ASSERT_TRUE(arg->values.texts[0].data == text);
+        *outScalar = arg->values.scalars[0];
+    }
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+    return success;
+}
+
+CTEST_CASE(typed_int64_values) {
+    Argparse_Scalar scalar;
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_INT64, "42", &scalar) && scalar.as_int64 == 42);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_INT64, "-17", &scalar) && scalar.as_int64 == -17);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_INT64, "+0x1F", &scalar) && scalar.as_int64 == 31);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_INT64, "9223372036854775807", &scalar) && scalar.as_int64 == INT64_MAX);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_INT64, "-9223372036854775808", &scalar) && scalar.as_int64 == INT64_MIN);
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_INT64, "9223372036854775808", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_INT64, "12a", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_INT64, "-", &scalar));
+}
+
+CTEST_CASE(typed_uint64_values) {
+    Argparse_Scalar scalar;
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_UINT64, "18446744073709551615", &scalar) && scalar.as_uint64 == UINT64_MAX);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_UINT64, "0xff", &scalar) && scalar.as_uint64 == 255);
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_UINT64, "18446744073709551616", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_UINT64, "-1", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_UINT64, "0x", &scalar));
+}
+
+CTEST_CASE(typed_double_values) {
+    Argparse_Scalar scalar;
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DOUBLE, "1.5", &scalar) && scalar.as_double == 1.5);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DOUBLE, "-2e3", &scalar) && scalar.as_double == -2000.0);
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_DOUBLE, "1.5x", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_DOUBLE, " 1", &scalar));
+}
+
+CTEST_CASE(typed_bool_values) {
+    Argparse_Scalar scalar;
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_BOOL, "true", &scalar) && scalar.as_bool);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_BOOL, "YES", &scalar) && scalar.as_bool);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_BOOL, "Off", &scalar) && !scalar.as_bool);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_BOOL, "0", &scalar) && !scalar.as_bool);
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_BOOL, "maybe", &scalar));
+}
+
+CTEST_CASE(typed_enum_values) {
+    Argparse_Scalar scalar;
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_ENUM, "fast", &scalar) && scalar.as_int64 == 1);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_ENUM, "slow", &scalar) && scalar.as_int64 == 2);
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_ENUM, "medium", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_ENUM, "fas", &scalar));
+}
+
+CTEST_CASE(typed_duration_values) {
+    Argparse_Scalar scalar;
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DURATION, "90", &scalar) && scalar.as_int64 == 90000000000ll);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DURATION, "1h30m", &scalar) && scalar.as_int64 == 5400000000000ll);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DURATION, "1.5s", &scalar) && scalar.as_int64 == 1500000000ll);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DURATION, "1.001s", &scalar) && scalar.as_int64 == 1001000000ll);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DURATION, "250ms", &scalar) && scalar.as_int64 == 250000000ll);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_DURATION, "2d3us7ns", &scalar) && scalar.as_int64 == 172800000003007ll);
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_DURATION, "1h30", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_DURATION, "5 min", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_DURATION, "3w", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_DURATION, "999999999999d", &scalar));
+}
+
+CTEST_CASE(typed_size_values) {
+    Argparse_Scalar scalar;
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_SIZE, "512", &scalar) && scalar.as_uint64 == 512);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_SIZE, "512B", &scalar) && scalar.as_uint64 == 512);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_SIZE, "64k", &scalar) && scalar.as_uint64 == 65536);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_SIZE, "1.5GiB", &scalar) && scalar.as_uint64 == 1610612736ull);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_SIZE, "2MB", &scalar) && scalar.as_uint64 == 2097152ull);
+    CTEST_ASSERT_TRUE(parse_typed(ARGPARSE_TYPE_SIZE, "1T", &scalar) && scalar.as_uint64 == 1099511627776ull);
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_SIZE, "1iB", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_SIZE, "1X", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_SIZE, "K", &scalar));
+    CTEST_ASSERT_TRUE(!parse_typed(ARGPARSE_TYPE_SIZE, "99999999999T", &scalar));
+}
+
+CTEST_CASE(typed_values_need_no_allocations) {
+    static char values[1000][8];
+    static char* argv[1002];
+    CountingContext counter = { 0 };
+    Argparse_Command cmd = {
+        .name = "test",
+        .allocator = { .context = &counter, .realloc = counting_realloc, .free = counting_free },
+    };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--n", .arity = ARGPARSE_ARITY_ONE_OR_MORE, .type = ARGPARSE_TYPE_INT64 });
+    argparse_compile_command(&cmd);
+
+    argv[0] = "program";
+    argv[1] = "--n";
+    for (size_t i = 0; i < 1000; ++i) {
+        snprintf(values[i], sizeof(values[i]), "%zu", i);
+        argv[i + 2] = values[i];
+    }
+    size_t allocationsBefore = counter.allocations;
+    Argparse_Pack pack = argparse_parse(1002, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* arg = argparse_get_argument(&pack, "--n");
+    CTEST_ASSERT_TRUE(arg->values.length == 1000);
+    int64_t sum = 0;
+    for (size_t i = 0; i < arg->values.length; ++i) sum += arg->values.scalars[i].as_int64;
+    CTEST_ASSERT_TRUE(sum == 499500);
+    // Only the arena and its chunks are allocated, which grow geometrically
+    CTEST_ASSERT_TRUE(counter.allocations - allocationsBefore <= 12);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+// Command string and parser tests /////////////////////////////////////////////
+
+CTEST_CASE(parse_string_splits_quoted_arguments) {
+    Argparse_Command cmd = { .name = "git" };
+    Argparse_Command commitCmd = { .name = "commit" };
+    argparse_add_option(&commitCmd, (Argparse_Option){ .long_name = "--message", .short_name = "-m", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&commitCmd, (Argparse_Option){ .long_name = "--depth", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .type = ARGPARSE_TYPE_INT64 });
+    argparse_add_option(&commitCmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+    argparse_add_subcommand(&cmd, commitCmd);
+
+    Argparse_Pack pack = argparse_parse_string("commit -m \"Initial commit\" --depth=3 a.txt 'b c.txt'", &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(strcmp(pack.program_name, "git") == 0);
+    CTEST_ASSERT_TRUE(strcmp(pack.command->name, "commit") == 0);
+    CTEST_ASSERT_TRUE(strcmp(get_string_value(&pack, "-m"), "Initial commit") == 0);
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--depth")->values.scalars[0].as_int64 == 3);
+    Argparse_Argument* files = argparse_get_positional(&pack, 0);
+    CTEST_ASSERT_TRUE(files->values.length == 2);
+    CTEST_ASSERT_TRUE(strcmp((char const*)files->values.elements[0], "a.txt") == 0);
+    CTEST_ASSERT_TRUE(strcmp((char const*)files->values.elements[1], "b c.txt") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(parse_string_empty_is_ok) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--verbose", .arity = ARGPARSE_ARITY_ZERO });
+
+    Argparse_Pack pack = argparse_parse_string("", &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(!has_option(&pack, "--verbose"));
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(parse_string_does_not_expand_response_files) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .arity = ARGPARSE_ARITY_ZERO_OR_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+
+    // The file exists and holds '--name value', which expanding it would set
+    Argparse_Pack pack = argparse_parse_string("@test_inputs/argparse/basic_args.txt", &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(!has_option(&pack, "--name"));
+    CTEST_ASSERT_TRUE(strcmp(get_positional_string(&pack, 0), "@test_inputs/argparse/basic_args.txt") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(parser_reuses_memory_between_parses) {
+    CountingContext counter = { 0 };
+    Argparse_Command cmd = {
+        .name = "test",
+        .allocator = { .context = &counter, .realloc = counting_realloc, .free = counting_free },
+    };
+    size_t nameSlot = argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    size_t countSlot = argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--count", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .type = ARGPARSE_TYPE_INT64 });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+
+    Argparse_Parser parser = argparse_create_parser(&cmd);
+    argparse_parser_parse_string(&parser, "--name warmup --count 0 a b c d e f g h");
+
+    size_t allocationsBefore = counter.allocations;
+    char line[64];
+    for (int i = 0; i < 100; ++i) {
+        snprintf(line, sizeof(line), "--name \"item %d\" --count %d a b c", i, i);
+        Argparse_Pack* pack = argparse_parser_parse_string(&parser, line);
+        ASSERT_NO_ERRORS(*pack);
+        char expected[16];
+        snprintf(expected, sizeof(expected), "item %d", i);
+        CTEST_ASSERT_TRUE(strcmp((char const*)argparse_get_argument_by_slot(pack, nameSlot)->values.elements[0], expected) == 0);
+        CTEST_ASSERT_TRUE(argparse_get_argument_by_slot(pack, countSlot)->values.scalars[0].as_int64 == i);
+        CTEST_ASSERT_TRUE(argparse_get_positional(pack, 0)->values.length == 3);
+    }
+    char* argv[] = { "program", "--name", "argv", "--count", "7", "x" };
+    Argparse_Pack* pack = argparse_parser_parse(&parser, 6, argv);
+    ASSERT_NO_ERRORS(*pack);
+    CTEST_ASSERT_TRUE(strcmp(get_string_value(pack, "--name"), "argv") == 0);
+    // Parses no larger than the warm-up one fit into the recycled memory
+    CTEST_ASSERT_TRUE(counter.allocations == allocationsBefore);
+
+    argparse_free_parser(&parser);
+    argparse_free_command(&cmd);
+    CTEST_ASSERT_TRUE(counter.allocations == counter.frees);
+}
+
+CTEST_CASE(parser_merges_chunks_after_large_parse) {
+    static char line[64 * 1024];
+    CountingContext counter = { 0 };
+    Argparse_Command cmd = {
+        .name = "test",
+        .allocator = { .context = &counter, .realloc = counting_realloc, .free = counting_free },
+    };
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+
+    size_t length = 0;
+    for (int i = 0; i < 5000; ++i) length += (size_t)snprintf(line + length, sizeof(line) - length, "v%d ", i);
+
+    Argparse_Parser parser = argparse_create_parser(&cmd);
+    // The first large parse spreads over multiple chunks, the second one merges them
+    argparse_parser_parse_string(&parser, line);
+    argparse_parser_parse_string(&parser, line);
+    size_t allocationsBefore = counter.allocations;
+    Argparse_Pack* pack = argparse_parser_parse_string(&parser, line);
+
+    ASSERT_NO_ERRORS(*pack);
+    CTEST_ASSERT_TRUE(argparse_get_positional(pack, 0)->values.length == 5000);
+    CTEST_ASSERT_TRUE(counter.allocations == allocationsBefore);
+
+    argparse_free_parser(&parser);
+    argparse_free_command(&cmd);
+    CTEST_ASSERT_TRUE(counter.allocations == counter.frees);
+}
+
+CTEST_CASE(parser_does_not_modify_compiled_tree) {
+    Argparse_Command cmd = { .name = "git" };
+    Argparse_Command commitCmd = { .name = "commit" };
+    argparse_add_option(&commitCmd, (Argparse_Option){ .long_name = "--message", .short_name = "-m", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_subcommand(&cmd, commitCmd);
+
+    Argparse_Parser parser = argparse_create_parser(&cmd);
+    struct Argparse_NameIndex* rootIndex = cmd.name_index;
+    struct Argparse_NameIndex* commitIndex = cmd.subcommands.elements[0].name_index;
+    CTEST_ASSERT_TRUE(rootIndex != NULL);
+    CTEST_ASSERT_TRUE(commitIndex != NULL);
+
+    Argparse_Pack* pack = argparse_parser_parse_string(&parser, "commit -m message");
+    ASSERT_NO_ERRORS(*pack);
+    CTEST_ASSERT_TRUE(strcmp(get_string_value(pack, "--message"), "message") == 0);
+    CTEST_ASSERT_TRUE(cmd.name_index == rootIndex);
+    CTEST_ASSERT_TRUE(cmd.subcommands.elements[0].name_index == commitIndex);
+
+    argparse_free_parser(&parser);
+    argparse_free_command(&cmd);
+}
+
+// Completion tests ////////////////////////////////////////////////////////////
+
+static Argparse_EnumValue const completion_modes[] = {
+    { .name = "debug", .value = 0 },
+    { .name = "release", .value = 1 },
+    { .name = "relwithdebinfo", .value = 2 },
+    { .name = NULL },
+};
+
+static Argparse_Command completion_command(void) {
+    Argparse_Command cmd = { .name = "proj" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--verbose", .short_name = "-v", .arity = ARGPARSE_ARITY_ZERO });
+    Argparse_Command buildCmd = { .name = "build", .description = "Builds the project" };
+    argparse_add_option(&buildCmd, (Argparse_Option){ .long_name = "--mode", .short_name = "-m", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .type = ARGPARSE_TYPE_ENUM, .enum_values = completion_modes });
+    argparse_add_option(&buildCmd, (Argparse_Option){ .long_name = "--output", .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_option(&buildCmd, (Argparse_Option){ .long_name = "--release", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&buildCmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+    Argparse_Command remoteCmd = { .name = "remote" };
+    Argparse_Command addCmd = { .name = "add" };
+    argparse_add_option(&addCmd, (Argparse_Option){ .long_name = "--fetch", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_subcommand(&remoteCmd, addCmd);
+    argparse_add_subcommand(&cmd, buildCmd);
+    argparse_add_subcommand(&cmd, remoteCmd);
+    return cmd;
+}
+
+// Checks that the completions are exactly the expected ones, in order
+static bool completions_equal(Argparse_Completions* completions, char const* const* expected, size_t expectedLength) {
+    if (completions->length != expectedLength) return false;
+    for (size_t i = 0; i < expectedLength; ++i) {
+        if (strcmp(completions->elements[i], expected[i]) != 0) return false;
+    }
+    return true;
+}
+
+CTEST_CASE(complete_subcommands_and_options_by_prefix) {
+    Argparse_Command cmd = completion_command();
+
+    char* emptyArgv[] = { "proj", "" };
+    Argparse_Completions completions = argparse_complete(2, emptyArgv, &cmd);
+    char const* all[] = { "--verbose", "-v", "build", "remote" };
+    CTEST_ASSERT_TRUE(completions.command == &cmd);
+    CTEST_ASSERT_TRUE(completions_equal(&completions, all, 4));
+    argparse_free_completions(&completions);
+
+    char* subcommandArgv[] = { "proj", "re" };
+    completions = argparse_complete(2, subcommandArgv, &cmd);
+    char const* remote[] = { "remote" };
+    CTEST_ASSERT_TRUE(completions_equal(&completions, remote, 1));
+    argparse_free_completions(&completions);
+
+    char* nestedArgv[] = { "proj", "build", "--r" };
+    completions = argparse_complete(3, nestedArgv, &cmd);
+    char const* release[] = { "--release" };
+    CTEST_ASSERT_TRUE(strcmp(completions.command->name, "build") == 0);
+    CTEST_ASSERT_TRUE(completions_equal(&completions, release, 1));
+    argparse_free_completions(&completions);
+
+    char* deepArgv[] = { "proj", "remote", "add", "-" };
+    completions = argparse_complete(4, deepArgv, &cmd);
+    char const* fetch[] = { "--fetch" };
+    CTEST_ASSERT_TRUE(completions_equal(&completions, fetch, 1));
+    argparse_free_completions(&completions);
+
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(complete_no_subcommands_after_option) {
+    Argparse_Command cmd = completion_command();
+
+    char* argv[] = { "proj", "-v", "" };
+    Argparse_Completions completions = argparse_complete(3, argv, &cmd);
+    char const* options[] = { "--verbose", "-v" };
+    CTEST_ASSERT_TRUE(completions_equal(&completions, options, 2));
+    argparse_free_completions(&completions);
+
+    // Nothing is completed after the option escape
+    char* escapedArgv[] = { "proj", "build", "--", "--r" };
+    completions = argparse_complete(4, escapedArgv, &cmd);
+    CTEST_ASSERT_TRUE(completions.length == 0);
+    argparse_free_completions(&completions);
+
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(complete_enum_values) {
+    Argparse_Command cmd = completion_command();
+
+    char* argv[] = { "proj", "build", "--mode", "rel" };
+    Argparse_Completions completions = argparse_complete(4, argv, &cmd);
+    char const* rel[] = { "release", "relwithdebinfo" };
+    CTEST_ASSERT_TRUE(completions_equal(&completions, rel, 2));
+    argparse_free_completions(&completions);
+
+    char* shortArgv[] = { "proj", "build", "-m", "" };
+    completions = argparse_complete(4, shortArgv, &cmd);
+    char const* all[] = { "debug", "release", "relwithdebinfo" };
+    CTEST_ASSERT_TRUE(completions_equal(&completions, all, 3));
+    argparse_free_completions(&completions);
+
+    // After a delimiter, only the value is completed
+    char* delimitedArgv[] = { "proj", "build", "--mode=d" };
+    completions = argparse_complete(3, delimitedArgv, &cmd);
+    char const* debug[] = { "debug" };
+    CTEST_ASSERT_TRUE(completions_equal(&completions, debug, 1));
+    argparse_free_completions(&completions);
+
+    // Free-form values have no candidates
+    char* outputArgv[] = { "proj", "build", "--output", "" };
+    completions = argparse_complete(4, outputArgv, &cmd);
+    CTEST_ASSERT_TRUE(completions.length == 0);
+    argparse_free_completions(&completions);
+
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(complete_among_many_options) {
+    static char names[10000][16];
+    Argparse_Command cmd = { .name = "test" };
+    for (size_t i = 0; i < 10000; ++i) {
+        snprintf(names[i], sizeof(names[i]), "--option-%zu", i);
+        argparse_add_option(&cmd, (Argparse_Option){ .long_name = names[i], .arity = ARGPARSE_ARITY_ZERO });
+    }
+    argparse_compile_command(&cmd);
+
+    char* argv[] = { "test", "--option-999" };
+    Argparse_Completions completions = argparse_complete(2, argv, &cmd);
+    char const* expected[] = { "--option-999", "--option-9990", "--option-9991", "--option-9992", "--option-9993",
+        "--option-9994", "--option-9995", "--option-9996", "--option-9997", "--option-9998", "--option-9999" };
+    CTEST_ASSERT_TRUE(completions_equal(&completions, expected, 11));
+    argparse_free_completions(&completions);
+
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(completion_scripts_contain_the_tree) {
+    Argparse_Command cmd = completion_command();
 
-    char* argv[] = { "test", "unknown" };
-    Argparse_Pack pack = argparse_parse(2, argv, &cmd);
+    char* bash = argparse_format_completion_script(&cmd, ARGPARSE_SHELL_BASH);
+    CTEST_ASSERT_TRUE(strstr(bash, "\"proj build\"|\"proj remote\"|\"proj remote add\")") != NULL);
+    CTEST_ASSERT_TRUE(strstr(bash, "\"proj build|--mode\"|\"proj build|-m\") words=\"debug release relwithdebinfo\" ;;") != NULL);
+    CTEST_ASSERT_TRUE(strstr(bash, "\"proj\") words=\"--verbose -v build remote\" ;;") != NULL);
+    CTEST_ASSERT_TRUE(strstr(bash, "complete -F _proj_completion proj\n") != NULL);
+    argparse_free(&cmd.allocator, bash);
 
-    ASSERT_NO_ERRORS(pack);
-    // Should stay at root command since "unknown" is not a subcommand
-    CTEST_ASSERT_TRUE(strcmp(pack.command->name, "test") == 0);
+    char* zsh = argparse_format_completion_script(&cmd, ARGPARSE_SHELL_ZSH);
+    CTEST_ASSERT_TRUE(strncmp(zsh, "#compdef proj\n", 14) == 0);
+    CTEST_ASSERT_TRUE(strstr(zsh, "\"proj remote add\") candidates=(\"--fetch\") ;;") != NULL);
+    CTEST_ASSERT_TRUE(strstr(zsh, "\"proj build|--output\") _files; return ;;") != NULL);
+    argparse_free(&cmd.allocator, zsh);
+
+    char* fish = argparse_format_completion_script(&cmd, ARGPARSE_SHELL_FISH);
+    CTEST_ASSERT_TRUE(strstr(fish, "case 'proj build' 'proj remote' 'proj remote add'\n") != NULL);
+    CTEST_ASSERT_TRUE(strstr(fish, "= \"proj\"' -a 'build' -d 'Builds the project'\n") != NULL);
+    CTEST_ASSERT_TRUE(strstr(fish, "= \"proj build\"' -l 'mode' -s 'm' -x -a 'debug release relwithdebinfo'\n") != NULL);
+    argparse_free(&cmd.allocator, fish);
 
-    argparse_free_pack(&pack);
     argparse_free_command(&cmd);
 }
 
@@ -1774,6 +4050,9 @@ CTEST_CASE(custom_parse_function_failure_reports_error) {
     char* argv[] = { "program", "--count", "not_a_number" };
     Argparse_Pack pack = argparse_parse(3, argv, &cmd);
 
+    // Values are only parsed on access or validation
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(!argparse_validate(&pack));
     ASSERT_HAS_ERRORS(pack);
 
     argparse_free_pack(&pack);
@@ -1798,6 +4077,194 @@ CTEST_CASE(custom_parse_negative_integer) {
     argparse_free_command(&cmd);
 }
 
+// Lazy parsing and default value tests ////////////////////////////////////////
+
+static int g_parse_calls = 0;
+static int g_default_calls = 0;
+
+static Argparse_ParseResult counting_parse_int(Argparse_Allocator* allocator, char const* text, size_t length) {
+    ++g_parse_calls;
+    return parse_int(allocator, text, length);
+}
+
+static void* default_port(Argparse_Allocator* allocator, Argparse_Option* option) {
+    ++g_default_calls;
+    int* value = (int*)argparse_realloc(allocator, NULL, sizeof(int));
+    *value = 8080;
+    return value;
+}
+
+static void* default_timeout(Argparse_Allocator* allocator, Argparse_Option* option) {
+    ++g_default_calls;
+    Argparse_Scalar* value = (Argparse_Scalar*)argparse_realloc(allocator, NULL, sizeof(Argparse_Scalar));
+    value->as_int64 = 30;
+    return value;
+}
+
+static void* no_default(Argparse_Allocator* allocator, Argparse_Option* option) {
+    ++g_default_calls;
+    return NULL;
+}
+
+CTEST_CASE(parse_fn_runs_on_first_access_only) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--a", .arity = ARGPARSE_ARITY_ONE_OR_MORE, .parse_fn = counting_parse_int });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--b", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .parse_fn = counting_parse_int });
+
+    g_parse_calls = 0;
+    char* argv[] = { "program", "--a", "1", "2", "3", "--b", "4" };
+    Argparse_Pack pack = argparse_parse(7, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(g_parse_calls == 0);
+    Argparse_Argument* a = argparse_get_argument(&pack, "--a");
+    CTEST_ASSERT_TRUE(g_parse_calls == 3);
+    CTEST_ASSERT_TRUE(a->values.length == 3);
+    CTEST_ASSERT_TRUE(*(int*)a->values.elements[2] == 3);
+    // Cached, the second access does not parse again
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--a") == a);
+    CTEST_ASSERT_TRUE(g_parse_calls == 3);
+    // Validation only parses what was not accessed yet
+    CTEST_ASSERT_TRUE(argparse_validate(&pack));
+    CTEST_ASSERT_TRUE(g_parse_calls == 4);
+    CTEST_ASSERT_TRUE(get_int_value(&pack, "--b") == 4);
+    CTEST_ASSERT_TRUE(g_parse_calls == 4);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(parse_fn_errors_are_reported_on_access) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--n", .arity = ARGPARSE_ARITY_ONE_OR_MORE, .parse_fn = parse_int });
+
+    char* argv[] = { "program", "--n", "1", "x", "3" };
+    Argparse_Pack pack = argparse_parse(5, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* n = argparse_get_argument(&pack, "--n");
+    // The invalid value is dropped and reported once
+    CTEST_ASSERT_TRUE(pack.errors.length == 1);
+    CTEST_ASSERT_TRUE(n->values.length == 2);
+    CTEST_ASSERT_TRUE(*(int*)n->values.elements[1] == 3);
+    CTEST_ASSERT_TRUE(strncmp(n->values.texts[1].data, "3", n->values.texts[1].length) == 0);
+    CTEST_ASSERT_TRUE(!argparse_validate(&pack));
+    CTEST_ASSERT_TRUE(pack.errors.length == 1);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(default_value_is_produced_on_access) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--verbose", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--port", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .parse_fn = parse_int, .default_value_fn = default_port });
+
+    g_default_calls = 0;
+    char* argv[] = { "program", "--verbose" };
+    Argparse_Pack pack = argparse_parse(2, argv, &cmd);
+
+    // The default satisfies the arity of the option
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(g_default_calls == 0);
+    Argparse_Argument* verbose = argparse_get_argument(&pack, "--verbose");
+    Argparse_Argument* port = argparse_get_argument(&pack, "--port");
+    CTEST_ASSERT_TRUE(g_default_calls == 1);
+    CTEST_ASSERT_TRUE(port->is_default);
+    CTEST_ASSERT_TRUE(!verbose->is_default);
+    CTEST_ASSERT_TRUE(port->values.length == 1);
+    CTEST_ASSERT_TRUE(*(int*)port->values.elements[0] == 8080);
+    // Cached, and earlier arguments stay where they were
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--port") == port);
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--verbose") == verbose);
+    CTEST_ASSERT_TRUE(g_default_calls == 1);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(default_value_is_not_produced_when_specified) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--port", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .parse_fn = parse_int, .default_value_fn = default_port });
+
+    g_default_calls = 0;
+    char* argv[] = { "program", "--port", "1234" };
+    Argparse_Pack pack = argparse_parse(3, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* port = argparse_get_argument(&pack, "--port");
+    CTEST_ASSERT_TRUE(!port->is_default);
+    CTEST_ASSERT_TRUE(*(int*)port->values.elements[0] == 1234);
+    CTEST_ASSERT_TRUE(g_default_calls == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(default_value_of_typed_option_is_stored_inline) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--timeout", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .type = ARGPARSE_TYPE_INT64, .default_value_fn = default_timeout });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_EXACTLY_ONE, .default_value_fn = default_port });
+
+    char* argv[] = { "program" };
+    Argparse_Pack pack = argparse_parse(1, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* timeout = argparse_get_argument(&pack, "--timeout");
+    CTEST_ASSERT_TRUE(timeout->is_default);
+    CTEST_ASSERT_TRUE(timeout->values.scalars[0].as_int64 == 30);
+    CTEST_ASSERT_TRUE(argparse_get_positional(&pack, 0)->is_default);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(default_value_fn_returning_null_of_typed_option_is_no_default) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--timeout", .arity = ARGPARSE_ARITY_ZERO_OR_ONE, .type = ARGPARSE_TYPE_INT64, .default_value_fn = no_default });
+
+    g_default_calls = 0;
+    char* argv[] = { "program" };
+    Argparse_Pack pack = argparse_parse(1, argv, &cmd);
+
+    // The missing default is remembered like a default would be
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--timeout") == NULL);
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--timeout") == NULL);
+    CTEST_ASSERT_TRUE(g_default_calls == 1);
+    CTEST_ASSERT_TRUE(argparse_validate(&pack));
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(required_option_without_default_reports_missing) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--timeout", .arity = ARGPARSE_ARITY_EXACTLY_ONE, .type = ARGPARSE_TYPE_INT64, .default_value_fn = no_default });
+
+    g_default_calls = 0;
+    char* argv[] = { "program" };
+    // Reported on first access
+    Argparse_Pack pack = argparse_parse(1, argv, &cmd);
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--timeout") == NULL);
+    CTEST_ASSERT_TRUE(pack.errors.length == 1);
+    CTEST_ASSERT_TRUE(strcmp(pack.errors.elements[0], "option '--timeout' expects exactly one value(s), but got 0") == 0);
+    CTEST_ASSERT_TRUE(!argparse_validate(&pack));
+    CTEST_ASSERT_TRUE(argparse_get_argument(&pack, "--timeout") == NULL);
+    CTEST_ASSERT_TRUE(pack.errors.length == 1);
+    CTEST_ASSERT_TRUE(g_default_calls == 1);
+    argparse_free_pack(&pack);
+
+    // Reported by validation, without any access
+    pack = argparse_parse(1, argv, &cmd);
+    CTEST_ASSERT_TRUE(!argparse_validate(&pack));
+    CTEST_ASSERT_TRUE(pack.errors.length == 1);
+    CTEST_ASSERT_TRUE(g_default_calls == 2);
+    argparse_free_pack(&pack);
+
+    argparse_free_command(&cmd);
+}
+
 // Error handling tests ////////////////////////////////////////////////////////
 
 CTEST_CASE(unknown_option_reports_error) {
@@ -1811,6 +4278,23 @@ CTEST_CASE(unknown_option_reports_error) {
     argparse_free_pack(&pack);
 }
 
+// Found by fuzzing, this used to trip an assertion
+CTEST_CASE(consecutive_options_ending_in_value_delimiters_report_error) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .arity = ARGPARSE_ARITY_ZERO_OR_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--count", .arity = ARGPARSE_ARITY_ZERO_OR_ONE });
+
+    char* argv[] = { "program", "--name:", "--count=3" };
+    Argparse_Pack pack = argparse_parse(3, argv, &cmd);
+
+    CTEST_ASSERT_TRUE(pack.errors.length == 1);
+    CTEST_ASSERT_TRUE(strcmp(pack.errors.elements[0], "missing value for option '--name' before option '--count'") == 0);
+    CTEST_ASSERT_TRUE(strcmp(get_string_value(&pack, "--count"), "3") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
 CTEST_CASE(unexpected_argument_reports_error) {
     Argparse_Command cmd = { .name = "test" };
     // No positional arguments defined
@@ -2060,6 +4544,54 @@ CTEST_CASE(response_file_mixed_with_argv) {
     argparse_free_command(&cmd);
 }
 
+CTEST_CASE(response_file_referenced_twice_is_loaded_once) {
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){
+        .long_name = "--name",
+        .arity = ARGPARSE_ARITY_ONE_OR_MORE,
+    });
+
+    char* argv[] = { "program", "@test_inputs/argparse/basic_args.txt", "@test_inputs/argparse/basic_args.txt" };
+    Argparse_Pack pack = argparse_parse(3, argv, &cmd);
+
+    ASSERT_NO_ERRORS(pack);
+    Argparse_Argument* arg = argparse_get_argument(&pack, "--name");
+    CTEST_ASSERT_TRUE(arg->values.length == 2);
+    // Both values are views into the same loaded file
+    CTEST_ASSERT_TRUE(arg->values.texts[0].data == arg->values.texts[1].data);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(response_file_large) {
+    char const* path = "argparse_large_response.txt";
+    FILE* file = fopen(path, "wb");
+    CTEST_ASSERT_TRUE(file != NULL);
+    for (int i = 0; i < 100000; ++i) {
+        fprintf(file, "%s\"file %d.txt\"\n", (i % 2 == 0) ? "-v " : "", i);
+    }
+    fclose(file);
+
+    Argparse_Command cmd = { .name = "test" };
+    argparse_add_option(&cmd, (Argparse_Option){ .short_name = "-v", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+
+    char* argv[] = { "program", "@argparse_large_response.txt" };
+    Argparse_Pack pack = argparse_parse(2, argv, &cmd);
+    remove(path);
+
+    ASSERT_NO_ERRORS(pack);
+    CTEST_ASSERT_TRUE(has_option(&pack, "-v"));
+    Argparse_Argument* files = argparse_get_positional(&pack, 0);
+    CTEST_ASSERT_TRUE(files->values.length == 100000);
+    CTEST_ASSERT_TRUE(strcmp((char const*)files->values.elements[0], "file 0.txt") == 0);
+    CTEST_ASSERT_TRUE(strcmp((char const*)files->values.elements[99999], "file 99999.txt") == 0);
+
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
 CTEST_CASE(response_file_not_found_reports_error) {
     Argparse_Command cmd = { .name = "test" };
 
@@ -2274,8 +4806,485 @@ CTEST_CASE(run_handler_return_value_propagates) {
     argparse_free_command(&cmd);
 }
 
+// Fuzzing /////////////////////////////////////////////////////////////////////
+
+static char const* const argparse_fuzz_dictionary[] = { "--name", "-n", "--count", "--level", "--tags", "-v", "sub", "--flag", "--", "=", ":", "\"", "'", "\\", "@", "/" };
+
+static Argparse_EnumValue const argparse_fuzz_levels[] = { { "low", 0 }, { "high", 1 }, { NULL, 0 } };
+
+// Checks that an argument retrieved from a pack without errors holds as many values as its arity allows
+static void check_fuzzed_argument(Argparse_Argument* argument) {
+    if (argument == NULL) return;
+    size_t length = argument->values.length;
+    for (size_t i = 0; i < length; ++i) CTEST_ASSERT_TRUE(argument->values.texts[i].data != NULL);
+    switch (argument->option->arity) {
+    case ARGPARSE_ARITY_ZERO: CTEST_ASSERT_TRUE(length == 0); break;
+    case ARGPARSE_ARITY_ZERO_OR_ONE: CTEST_ASSERT_TRUE(length <= 1); break;
+    case ARGPARSE_ARITY_EXACTLY_ONE: CTEST_ASSERT_TRUE(length == 1); break;
+    case ARGPARSE_ARITY_ONE_OR_MORE: CTEST_ASSERT_TRUE(length >= 1); break;
+    default: break;
+    }
+}
+
+// Any command line has to parse into values or errors, and without errors, the values have to match the arities
+// Run with --fuzz argparse_parse_arbitrary_command_line to fuzz for longer
+CTEST_FUZZ(argparse_parse_arbitrary_command_line, data, size) {
+    char* commandLine = (char*)malloc(size + 1);
+    CTEST_ASSERT_TRUE(commandLine != NULL);
+    memcpy(commandLine, data, size);
+    commandLine[size] = '\0';
+
+    Argparse_Command cmd = { .name = "fuzz" };
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--name", .short_name = "-n", .arity = ARGPARSE_ARITY_ZERO_OR_ONE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--count", .arity = ARGPARSE_ARITY_ZERO_OR_ONE, .type = ARGPARSE_TYPE_INT64 });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--level", .arity = ARGPARSE_ARITY_ZERO_OR_ONE, .type = ARGPARSE_TYPE_ENUM, .enum_values = argparse_fuzz_levels });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--tags", .arity = ARGPARSE_ARITY_ONE_OR_MORE });
+    argparse_add_option(&cmd, (Argparse_Option){ .long_name = "--verbose", .short_name = "-v", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&cmd, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+    Argparse_Command sub = { .name = "sub" };
+    argparse_add_option(&sub, (Argparse_Option){ .long_name = "--flag", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&sub, (Argparse_Option){ .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+    argparse_add_subcommand(&cmd, sub);
+
+    Argparse_Pack pack = argparse_parse_string(commandLine, &cmd);
+    free(commandLine);
+    if (argparse_validate(&pack)) {
+        char const* names[] = { "--name", "--count", "--level", "--tags", "--verbose", "--flag" };
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) check_fuzzed_argument(argparse_get_argument(&pack, names[i]));
+        check_fuzzed_argument(argparse_get_positional(&pack, 0));
+    }
+    argparse_free_pack(&pack);
+    argparse_free_command(&cmd);
+}
+
+CTEST_CASE(parse_survives_fuzzing) {
+    CTest_FuzzTarget target = { .name = "argparse_parse_arbitrary_command_line", .fuzz_fn = argparse_parse_arbitrary_command_line };
+    CTest_FuzzOptions options = {
+        .runs = 5000,
+        .max_input_size = 256,
+        .seed = 1,
+        .dictionary = argparse_fuzz_dictionary,
+        .dictionary_length = sizeof(argparse_fuzz_dictionary) / sizeof(argparse_fuzz_dictionary[0]),
+    };
+    CTest_FuzzResult result = ctest_fuzz(&target, options);
+    if (result.failed || result.slow) ctest_print_fuzz_result(result);
+    bool passed = !result.failed && !result.slow;
+    ctest_free_fuzz_result(&result);
+    CTEST_ASSERT_TRUE(passed);
+}
+
 #endif /* ARGPARSE_SELF_TEST */
 
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark section                                                          //
+////////////////////////////////////////////////////////////////////////////////
+#ifdef ARGPARSE_BENCHMARK
+#undef ARGPARSE_BENCHMARK
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARGPARSE_STATIC
+#define ARGPARSE_IMPLEMENTATION
+#include "argparse.h"
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <time.h>
+#endif
+
+// Seconds elapsed on a monotonic clock
+static double bench_now(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+typedef struct BenchContext {
+    // The number of allocations done through the counting allocator during the measured part
+    size_t alloc_calls;
+    // Accumulates results, so the measured work can't be optimized away
+    size_t sink;
+} BenchContext;
+
+static void* bench_realloc(void* ctx, void* ptr, size_t new_size) {
+    if (ptr == NULL) ++((BenchContext*)ctx)->alloc_calls;
+    return realloc(ptr, new_size);
+}
+
+static void bench_free(void* ctx, void* ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+static Argparse_Command bench_command_create(BenchContext* ctx, char const* name) {
+    Argparse_Command command = {
+        .name = name,
+        .allocator = { .context = ctx, .realloc = bench_realloc, .free = bench_free },
+    };
+    return command;
+}
+
+// A growable list of heap-allocated strings, used for argv and for the names of generated options
+typedef struct BenchStrings {
+    char** elements;
+    size_t length;
+    size_t capacity;
+} BenchStrings;
+
+static char* bench_strings_push(BenchStrings* strings, char const* format, ...) {
+    char buffer[64];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    char* string = (char*)malloc((size_t)length + 1);
+    memcpy(string, buffer, (size_t)length + 1);
+    if (strings->length + 1 > strings->capacity) {
+        strings->capacity = (strings->capacity == 0) ? 64 : (strings->capacity * 2);
+        strings->elements = (char**)realloc(strings->elements, strings->capacity * sizeof(char*));
+    }
+    strings->elements[strings->length++] = string;
+    return string;
+}
+
+static void bench_strings_free(BenchStrings* strings) {
+    for (size_t i = 0; i < strings->length; ++i) free(strings->elements[i]);
+    free(strings->elements);
+    *strings = (BenchStrings){ 0 };
+}
+
+static Argparse_ParseResult bench_parse_level(Argparse_Allocator* allocator, char const* text, size_t length) {
+    size_t* value = (size_t*)argparse_realloc(allocator, NULL, sizeof(size_t));
+    *value = length;
+    return (Argparse_ParseResult){ .value = value, .error = NULL };
+}
+
+// Builds a command with a handful of options, for inputs mixing bundled flags, delimiters and quoted values
+static Argparse_Command bench_mixed_command(BenchContext* ctx) {
+    Argparse_Command command = bench_command_create(ctx, "bench");
+    argparse_add_option(&command, (Argparse_Option){ .short_name = "-a", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&command, (Argparse_Option){ .short_name = "-b", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&command, (Argparse_Option){ .short_name = "-c", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&command, (Argparse_Option){ .short_name = "-d", .arity = ARGPARSE_ARITY_ZERO });
+    argparse_add_option(&command, (Argparse_Option){ .long_name = "--name", .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+    argparse_add_option(&command, (Argparse_Option){ .long_name = "--count", .arity = ARGPARSE_ARITY_ZERO_OR_MORE, .type = ARGPARSE_TYPE_INT64 });
+    argparse_add_option(&command, (Argparse_Option){ .long_name = "--level", .arity = ARGPARSE_ARITY_ZERO_OR_MORE, .parse_fn = bench_parse_level });
+    argparse_add_option(&command, (Argparse_Option){ .arity = ARGPARSE_ARITY_ZERO_OR_MORE });
+    argparse_compile_command(&command);
+    return command;
+}
+
+// Writes the i-th token of the mixed inputs, quoting the positional values when they go into a response file
+static void bench_push_mixed_token(BenchStrings* strings, size_t i, bool quoted) {
+    switch (i % 5) {
+    case 0: bench_strings_push(strings, "-abcd"); break;
+    case 1: bench_strings_push(strings, "--name=value_%zu", i); break;
+    case 2: bench_strings_push(strings, "--count:%zu", i); break;
+    case 3: bench_strings_push(strings, "--level=%zu", i); break;
+    default: bench_strings_push(strings, quoted ? "\"file %zu.txt\"" : "file %zu.txt", i); break;
+    }
+}
+
+static void bench_consume_pack(Argparse_Pack* pack, BenchContext* ctx) {
+    ctx->sink += pack->arguments.length + pack->errors.length;
+}
+
+// Each benchmark works on an input of the given size and returns the seconds spent in the measured part
+
+static double bench_parse_many_options(size_t size, BenchContext* ctx) {
+    // Every one of size options is specified once with a value
+    Argparse_Command command = bench_command_create(ctx, "bench");
+    BenchStrings names = { 0 };
+    BenchStrings argv = { 0 };
+    bench_strings_push(&argv, "bench");
+    for (size_t i = 0; i < size; ++i) {
+        char const* name = bench_strings_push(&names, "--option-%zu", i);
+        argparse_add_option(&command, (Argparse_Option){ .long_name = name, .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+        bench_strings_push(&argv, "--option-%zu", i);
+        bench_strings_push(&argv, "%zu", i);
+    }
+    argparse_compile_command(&command);
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    Argparse_Pack pack = argparse_parse((int)argv.length, argv.elements, &command);
+    double elapsed = bench_now() - start;
+    bench_consume_pack(&pack, ctx);
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    bench_strings_free(&names);
+    bench_strings_free(&argv);
+    return elapsed;
+}
+
+static double bench_parse_positionals(size_t size, BenchContext* ctx) {
+    // Every one of size positional arguments takes exactly one value
+    Argparse_Command command = bench_command_create(ctx, "bench");
+    BenchStrings argv = { 0 };
+    bench_strings_push(&argv, "bench");
+    for (size_t i = 0; i < size; ++i) {
+        argparse_add_option(&command, (Argparse_Option){ .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+        bench_strings_push(&argv, "value_%zu", i);
+    }
+    argparse_compile_command(&command);
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    Argparse_Pack pack = argparse_parse((int)argv.length, argv.elements, &command);
+    double elapsed = bench_now() - start;
+    bench_consume_pack(&pack, ctx);
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    bench_strings_free(&argv);
+    return elapsed;
+}
+
+static double bench_parse_deep_subcommands(size_t size, BenchContext* ctx) {
+    // A chain of size nested subcommands, the input walks all the way down
+    BenchStrings names = { 0 };
+    BenchStrings argv = { 0 };
+    bench_strings_push(&argv, "bench");
+    for (size_t i = 0; i < size; ++i) bench_strings_push(&names, "level%zu", i);
+    for (size_t i = 0; i < size; ++i) bench_strings_push(&argv, "level%zu", i);
+    bench_strings_push(&argv, "--leaf");
+    // Subcommands are copied when added, so the chain is built from the leaf up
+    Argparse_Command child = bench_command_create(ctx, names.elements[size - 1]);
+    argparse_add_option(&child, (Argparse_Option){ .long_name = "--leaf", .arity = ARGPARSE_ARITY_ZERO });
+    for (size_t i = size - 1; i > 0; --i) {
+        Argparse_Command parent = bench_command_create(ctx, names.elements[i - 1]);
+        argparse_add_option(&parent, (Argparse_Option){ .long_name = "--inner", .arity = ARGPARSE_ARITY_ZERO });
+        argparse_add_subcommand(&parent, child);
+        child = parent;
+    }
+    Argparse_Command command = bench_command_create(ctx, "bench");
+    argparse_add_subcommand(&command, child);
+    argparse_compile_command(&command);
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    Argparse_Pack pack = argparse_parse((int)argv.length, argv.elements, &command);
+    double elapsed = bench_now() - start;
+    bench_consume_pack(&pack, ctx);
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    bench_strings_free(&names);
+    bench_strings_free(&argv);
+    return elapsed;
+}
+
+static double bench_parse_mixed_argv(size_t size, BenchContext* ctx) {
+    Argparse_Command command = bench_mixed_command(ctx);
+    BenchStrings argv = { 0 };
+    bench_strings_push(&argv, "bench");
+    for (size_t i = 0; i < size; ++i) bench_push_mixed_token(&argv, i, false);
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    Argparse_Pack pack = argparse_parse((int)argv.length, argv.elements, &command);
+    double elapsed = bench_now() - start;
+    bench_consume_pack(&pack, ctx);
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    bench_strings_free(&argv);
+    return elapsed;
+}
+
+static double bench_parse_response_file(size_t size, BenchContext* ctx) {
+    char const* path = "argparse_bench_response.txt";
+    BenchStrings tokens = { 0 };
+    for (size_t i = 0; i < size; ++i) bench_push_mixed_token(&tokens, i, true);
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        bench_strings_free(&tokens);
+        return 0.0;
+    }
+    for (size_t i = 0; i < tokens.length; ++i) fprintf(file, "%s\n", tokens.elements[i]);
+    fclose(file);
+    bench_strings_free(&tokens);
+
+    Argparse_Command command = bench_mixed_command(ctx);
+    char* argv[] = { "bench", "@argparse_bench_response.txt" };
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    Argparse_Pack pack = argparse_parse(2, argv, &command);
+    double elapsed = bench_now() - start;
+    bench_consume_pack(&pack, ctx);
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    remove(path);
+    return elapsed;
+}
+
+static double bench_parser_reuse(size_t size, BenchContext* ctx) {
+    // Parses size short command strings with a single reused parser
+    Argparse_Command command = bench_mixed_command(ctx);
+    Argparse_Parser parser = argparse_create_parser(&command);
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    for (size_t i = 0; i < size; ++i) {
+        Argparse_Pack* pack = argparse_parser_parse_string(&parser, "-abcd --name=value --count:42 --level=3 \"file 1.txt\" file2.txt");
+        bench_consume_pack(pack, ctx);
+    }
+    double elapsed = bench_now() - start;
+    argparse_free_parser(&parser);
+    argparse_free_command(&command);
+    return elapsed;
+}
+
+// Parses size options for the accessor benchmarks, where only the accessors are measured
+static Argparse_Pack bench_parse_for_access(size_t size, Argparse_Command* command, BenchStrings* names, BenchStrings* argv) {
+    bench_strings_push(argv, "bench");
+    for (size_t i = 0; i < size; ++i) {
+        char const* name = bench_strings_push(names, "--option-%zu", i);
+        argparse_add_option(command, (Argparse_Option){ .long_name = name, .arity = ARGPARSE_ARITY_EXACTLY_ONE, .parse_fn = bench_parse_level });
+        bench_strings_push(argv, "--option-%zu", i);
+        bench_strings_push(argv, "%zu", i);
+    }
+    return argparse_parse((int)argv->length, argv->elements, command);
+}
+
+static double bench_get_argument(size_t size, BenchContext* ctx) {
+    Argparse_Command command = bench_command_create(ctx, "bench");
+    BenchStrings names = { 0 };
+    BenchStrings argv = { 0 };
+    Argparse_Pack pack = bench_parse_for_access(size, &command, &names, &argv);
+
+    // The first access also runs the parse function
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    for (size_t i = 0; i < size; ++i) {
+        Argparse_Argument* argument = argparse_get_argument(&pack, names.elements[i]);
+        ctx->sink += *(size_t*)argument->values.elements[0];
+    }
+    double elapsed = bench_now() - start;
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    bench_strings_free(&names);
+    bench_strings_free(&argv);
+    return elapsed;
+}
+
+static double bench_get_argument_by_slot(size_t size, BenchContext* ctx) {
+    Argparse_Command command = bench_command_create(ctx, "bench");
+    BenchStrings names = { 0 };
+    BenchStrings argv = { 0 };
+    Argparse_Pack pack = bench_parse_for_access(size, &command, &names, &argv);
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    for (size_t i = 0; i < size; ++i) {
+        Argparse_Argument* argument = argparse_get_argument_by_slot(&pack, i);
+        ctx->sink += *(size_t*)argument->values.elements[0];
+    }
+    double elapsed = bench_now() - start;
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    bench_strings_free(&names);
+    bench_strings_free(&argv);
+    return elapsed;
+}
+
+static double bench_get_positional(size_t size, BenchContext* ctx) {
+    Argparse_Command command = bench_command_create(ctx, "bench");
+    BenchStrings argv = { 0 };
+    bench_strings_push(&argv, "bench");
+    for (size_t i = 0; i < size; ++i) {
+        argparse_add_option(&command, (Argparse_Option){ .arity = ARGPARSE_ARITY_EXACTLY_ONE });
+        bench_strings_push(&argv, "value_%zu", i);
+    }
+    Argparse_Pack pack = argparse_parse((int)argv.length, argv.elements, &command);
+
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    for (size_t i = 0; i < size; ++i) {
+        Argparse_Argument* argument = argparse_get_positional(&pack, i);
+        ctx->sink += argument->values.texts[0].length;
+    }
+    double elapsed = bench_now() - start;
+    argparse_free_pack(&pack);
+    argparse_free_command(&command);
+    bench_strings_free(&argv);
+    return elapsed;
+}
+
+typedef struct Benchmark {
+    char const* name;
+    double(*run)(size_t size, BenchContext* ctx);
+    // What the size counts, for the header of the results
+    char const* unit;
+    // Sizes above this are skipped, as the input is unrealistically large for them, 0 means no limit
+    size_t max_size;
+} Benchmark;
+
+static Benchmark const benchmarks[] = {
+    { .name = "parse many options", .run = bench_parse_many_options, .unit = "options", .max_size = 10000 },
+    { .name = "parse positionals", .run = bench_parse_positionals, .unit = "options", .max_size = 10000 },
+    { .name = "parse deep subcommands", .run = bench_parse_deep_subcommands, .unit = "levels", .max_size = 10000 },
+    { .name = "parse mixed argv", .run = bench_parse_mixed_argv, .unit = "tokens" },
+    { .name = "parse response file", .run = bench_parse_response_file, .unit = "tokens" },
+    { .name = "parser reuse (string)", .run = bench_parser_reuse, .unit = "parses" },
+    { .name = "get_argument", .run = bench_get_argument, .unit = "options", .max_size = 10000 },
+    { .name = "get_argument_by_slot", .run = bench_get_argument_by_slot, .unit = "options", .max_size = 10000 },
+    { .name = "get_positional", .run = bench_get_positional, .unit = "options", .max_size = 10000 },
+};
+
+static size_t bench_parse_size(char const* str) {
+    char* end;
+    size_t size = (size_t)strtoull(str, &end, 10);
+    if (*end == 'K' || *end == 'k') size *= 1000;
+    else if (*end == 'M' || *end == 'm') size *= 1000 * 1000;
+    return size;
+}
+
+int main(int argc, char* argv[]) {
+    // Usage: [max size, like 100K or 1M] [benchmark name filters...]
+    size_t maxSize = (argc > 1) ? bench_parse_size(argv[1]) : 1000 * 1000;
+    BenchContext ctx = { 0 };
+
+    printf("%-24s %10s %-8s %14s %12s %10s\n", "benchmark", "size", "unit", "time/iter", "ns/unit", "allocs");
+    for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); ++b) {
+        Benchmark const* bench = &benchmarks[b];
+        bool selected = (argc <= 2);
+        for (int i = 2; i < argc; ++i) {
+            if (strstr(bench->name, argv[i]) != NULL) selected = true;
+        }
+        if (!selected) continue;
+
+        for (size_t size = 10; size <= maxSize; size *= 10) {
+            if (bench->max_size != 0 && size > bench->max_size) break;
+            // Repeat for a stable result, the time limits include the unmeasured setup
+            double total = 0;
+            size_t iterations = 0;
+            double wallStart = bench_now();
+            while (iterations < 3 || bench_now() - wallStart < 0.25) {
+                total += bench->run(size, &ctx);
+                ++iterations;
+                if (iterations >= 3 && bench_now() - wallStart > 5.0) break;
+            }
+            double perIteration = total / (double)iterations;
+            printf("%-24s %10zu %-8s %11.3f us %12.1f %10zu\n",
+                bench->name, size, bench->unit, perIteration * 1e6, perIteration * 1e9 / (double)size, ctx.alloc_calls);
+        }
+    }
+    // Print the sink, so no work can be eliminated
+    printf("(checksum: %zu)\n", ctx.sink);
+    return 0;
+}
+
+#endif /* ARGPARSE_BENCHMARK */
+
 ////////////////////////////////////////////////////////////////////////////////
 // Example section                                                            //
 ////////////////////////////////////////////////////////////////////////////////
@@ -14,6 +14,20 @@
  *  - #define CTEST_STATIC before including this header to make all functions have internal linkage
  *  - #define CTEST_REALLOC and CTEST_FREE to use custom memory allocation functions (by default they use realloc and free from the C standard library)
  *  - #define CTEST_MAIN before including this header to compile a default main program that runs all test cases defined with CTEST_CASE, and accepts optional command-line arguments to filter which cases to run
+ *    and '-j N' to run N cases in parallel, each in its own process, with '--timeout SECONDS' to fail the cases running longer than that
+ *    and '--slowest N' to list the N slowest cases (5 by default)
+ *    '--shard-index I --shard-count N' runs only one of N shards of the suite, '--shuffle' (with '--seed S') runs the cases in a random order,
+ *    and '--repeat N' runs each case N times
+ *    '--format junit|tap|jsonl' streams the results to stdout in a machine-readable format instead of the text report, or to a file with '--output PATH'
+ *    With '--bench', it runs the benchmarks defined with CTEST_BENCH instead, filtered the same way, and '--samples N' sets the number of measured samples
+ *    '--save-baseline PATH' writes the results to a baseline file, '--baseline PATH' compares against one and fails on regressions beyond '--threshold PERCENT'
+ *    and '--counters' collects performance counters per benchmark
+ *    With '--fuzz', it fuzzes the targets defined with CTEST_FUZZ instead, for '--runs N' inputs or '--max-time SECONDS', with '--max-len N' bytes at most,
+ *    failing inputs slower than '--input-timeout SECONDS', loading and growing the corpus in '--corpus DIR', writing failing inputs to '--artifacts DIR',
+ *    and '--reproduce PATH' runs the targets on a single input file
+ *  - #define CTEST_FUZZ_COVERAGE and compile with -fsanitize-coverage=trace-pc (or trace-pc-guard on clang) to guide the fuzzer with coverage feedback
+ *  - #define CTEST_LIBFUZZER and compile with -fsanitize=fuzzer to run the fuzz targets with libFuzzer instead,
+ *    which picks the target named by the CTEST_FUZZ_TARGET environment variable, or the first one, the default main is left out then
  *  - #define CTEST_SELF_TEST before including this header to compile a self-test that verifies the framework's functionality
  *  - #define CTEST_EXAMPLE before including this header to compile a simple example that demonstrates how to use the framework
  *
@@ -21,13 +35,38 @@
  *  - Use CTEST_CASE to define test cases, which automatically registers them in the default test suite
  *  - Use ctest_get_suite to get the default test suite, which contains all cases defined with CTEST_CASE
  *  - Use ctest_run_suite to run a test suite with a filter, which returns a report of the execution
- *  - Use ctest_run_case to run a single test case and get the execution result
+ *  - Use ctest_run_suite_with_options to run the cases in forked processes on POSIX systems, in parallel and with a timeout,
+ *    so crashes and hangs fail only the case that caused them
+ *  - Use ctest_run_case to run a single test case and get the execution result, including its wall-clock and processor time
+ *  - Use ctest_print_slowest_cases to find the cases that dominate the time of a suite
+ *  - Set the reporter option of test and benchmark runs to get each result as soon as it's available,
+ *    and use ctest_format_reporter to stream them as JUnit XML, TAP or JSON lines
  *  - Use ctest_free_suite and ctest_free_report to free the memory allocated for test suites and reports, respectively
  *  - Use CTEST_ASSERT_TRUE and CTEST_ASSERT_FAIL to make assertions in test cases, which will cause the case to fail if they are not met
+ *  - Plug ctest_counting_realloc and ctest_counting_free into the allocator of the tested library to count the allocations of the case,
+ *    then use CTEST_ASSERT_ALLOCATIONS_AT_MOST, CTEST_ASSERT_PEAK_BYTES_AT_MOST and CTEST_ASSERT_NO_LEAKS to check them
+ *  - Use CTEST_BENCH to define benchmarks, which loop state->iterations times over the measured code, with CTEST_DO_NOT_OPTIMIZE to keep results alive
+ *  - Use ctest_get_bench_suite and ctest_run_bench_suite to run the benchmarks, which calibrates the iterations, warms up and
+ *    collects statistics per benchmark, and ctest_print_bench_report to print them
+ *  - Set the counters option of the benchmarks to collect instructions, cycles, cache misses, branch misses, page faults and task-clock per iteration,
+ *    through perf_event_open on Linux, falling back to software counters where hardware events are unavailable
+ *  - Use ctest_write_bench_baseline and ctest_read_bench_baseline to store results in a CSV file, and ctest_print_bench_comparison
+ *    to compare a later run against it with a Mann-Whitney U test
+ *  - Use CTEST_FUZZ to define fuzz targets that get arbitrary bytes, and ctest_fuzz to run one in-process with a built-in mutation engine,
+ *    which stops at the first input failing an assertion or taking longer than the time limit, writes it to a file and keeps crashing inputs
+ *    the same way through signal handlers, then use ctest_run_fuzz_input to turn such an input into a regression test
+ *  - Use ctest_measure_complexity to time a benchmark over growing input sizes and fit the times to O(1), O(log n), O(n), O(n log n) or O(n^2),
+ *    and CTEST_ASSERT_COMPLEXITY to fail a test case when the benchmark scales worse than an upper bound
  *
  * Check the example section at the end of this file for a full example.
  */
 
+// NOTE: We need this for fork, kill and clock_gettime on Linux
+// and apparently we need this before any includes
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // Declaration section                                                        //
 ////////////////////////////////////////////////////////////////////////////////
@@ -37,6 +76,8 @@
 #include <setjmp.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #ifdef CTEST_STATIC
     #define CTEST_DEF static
@@ -44,6 +85,13 @@
     #define CTEST_DEF extern
 #endif
 
+// Marks the few functions the default main program never calls, mostly ones only reached through macros, so a file including this statically might not use them
+#if defined(__GNUC__) || defined(__clang__)
+    #define __CTEST_UNUSED __attribute__((unused))
+#else
+    #define __CTEST_UNUSED
+#endif
+
 #ifndef CTEST_REALLOC
     #define CTEST_REALLOC realloc
     #define CTEST_FREE free
@@ -55,6 +103,26 @@ extern "C" {
 
 struct CTest_Execution;
 
+/**
+ * Allocation statistics collected by the counting allocator.
+ */
+typedef struct CTest_AllocStats {
+    // The number of allocated new blocks
+    size_t allocations;
+    // The number of resized blocks
+    size_t reallocations;
+    // The number of freed blocks
+    size_t frees;
+    // The sum of the sizes requested by allocations and reallocations
+    size_t allocated_bytes;
+    // The number of bytes currently allocated
+    size_t live_bytes;
+    // The highest number of bytes allocated at the same time
+    size_t peak_bytes;
+    // The number of blocks currently allocated, these are leaks at the end of a case
+    size_t live_blocks;
+} CTest_AllocStats;
+
 /**
  * A single test case in the test suite.
  */
@@ -65,6 +133,9 @@ typedef struct CTest_Case {
     void(*test_fn)(void);
     // If true, the test case is expected to fail
     bool should_fail;
+    // The number of seconds the case can take before it's killed and failed, overriding the timeout of the run. If 0, the timeout of the run applies.
+    // On POSIX systems, a case with a timeout runs in its own process even if the run does not use processes, the other cases still run in-process.
+    double timeout;
 } CTest_Case;
 
 /**
@@ -98,6 +169,12 @@ typedef struct CTest_Execution {
         // An optional line number where the failure happened
         int line;
     } fail_info;
+    // The wall-clock time the case took in seconds
+    double wall_time;
+    // The processor time the case took in seconds, 0 if the process of the case died before reporting it
+    double cpu_time;
+    // The allocations made through the counting allocator during the case, the live blocks at the end are leaks
+    CTest_AllocStats alloc_stats;
     // Used internally to be able to catch assertions from within the test functions and even across the SUT code, if necessary
     jmp_buf jmp_env;
 } CTest_Execution;
@@ -112,6 +189,398 @@ typedef struct CTest_Filter {
     void* user;
 } CTest_Filter;
 
+struct CTest_BenchResult;
+
+/**
+ * Callbacks notified while a test or benchmark suite runs, to report the results as soon as they are available.
+ * Each callback is optional.
+ */
+typedef struct CTest_Reporter {
+    // Called before the first case or benchmark runs, with the number that will run
+    void(*begin_fn)(size_t count, void* user);
+    // Called as soon as a test case finished, in the order they finish
+    void(*execution_fn)(CTest_Execution const* execution, void* user);
+    // Called as soon as a benchmark finished
+    void(*bench_result_fn)(struct CTest_BenchResult const* result, void* user);
+    // Called after the last case or benchmark finished
+    void(*end_fn)(void* user);
+    // User data that gets passed to the callbacks
+    void* user;
+} CTest_Reporter;
+
+/**
+ * The machine-readable formats results can be streamed in.
+ */
+typedef enum CTest_Format {
+    // JUnit XML, understood by most CI servers
+    CTEST_FORMAT_JUNIT,
+    // Test Anything Protocol version 13, with YAML diagnostics for failures
+    CTEST_FORMAT_TAP,
+    // One JSON object per line
+    CTEST_FORMAT_JSON_LINES,
+} CTest_Format;
+
+/**
+ * The state of a reporter that streams results in a machine-readable format, see @see ctest_format_reporter.
+ */
+typedef struct CTest_FormatWriter {
+    // The format to write
+    CTest_Format format;
+    // The stream to write to, flushed after each result
+    FILE* out;
+    // Used internally, the number of results written so far
+    size_t written;
+    // Used internally, the number of failed cases written so far
+    size_t failed;
+} CTest_FormatWriter;
+
+/**
+ * Options for running a test suite.
+ */
+typedef struct CTest_Options {
+    // The number of cases to run at the same time, each in its own forked process. If 0, the cases run in-process one after another.
+    // A case that crashes or exits in a process only fails itself. Processes are only supported on POSIX systems, elsewhere the cases run in-process.
+    size_t jobs;
+    // The number of seconds a case can take before it's killed and failed. If 0, there is no limit.
+    // Timeouts are enforced by running the cases in processes, so on POSIX systems this runs all cases in processes even if jobs is 0.
+    double timeout;
+    // The number of shards the suite is split into, each run only runs one of them. If 0 or 1, the suite is not split.
+    // Cases are assigned to shards by a stable hash of their names, so separate processes or machines agree on the split.
+    size_t shard_count;
+    // The shard to run, less than the shard count
+    size_t shard_index;
+    // If true, the cases run in a random order determined by the seed, to find cases that depend on each other
+    bool shuffle;
+    // The seed of the shuffled order, the same seed gives the same order
+    uint64_t seed;
+    // The number of times each case runs, to hunt down flaky cases. If 0, the cases run once.
+    size_t repeat;
+    // Notified of each execution as soon as it finished
+    CTest_Reporter reporter;
+} CTest_Options;
+
+/**
+ * The performance counters a benchmark can collect.
+ */
+typedef enum CTest_Counter {
+    // Retired instructions
+    CTEST_COUNTER_INSTRUCTIONS,
+    // CPU cycles
+    CTEST_COUNTER_CYCLES,
+    // Cache misses, usually of the last level cache
+    CTEST_COUNTER_CACHE_MISSES,
+    // Mispredicted branches
+    CTEST_COUNTER_BRANCH_MISSES,
+    // Page faults
+    CTEST_COUNTER_PAGE_FAULTS,
+    // Processor time in nanoseconds
+    CTEST_COUNTER_TASK_CLOCK,
+    // The number of counters
+    CTEST_COUNTER_COUNT,
+} CTest_Counter;
+
+/**
+ * The state of a running benchmark, passed to the benchmark function.
+ */
+typedef struct CTest_BenchState {
+    // The number of times the benchmark function has to run the measured code
+    size_t iterations;
+    // The number of bytes processed by one iteration, the benchmark can set it to get the throughput in bytes per second
+    size_t bytes_per_iteration;
+    // The input size of a scaling benchmark, see @see ctest_measure_complexity, 0 for other benchmarks
+    size_t size;
+    // The time the measurement started at, see @see ctest_bench_reset_timer
+    double start_time;
+    // Used internally, true if the time is measured in processor time
+    bool cpu_time;
+    // Used internally to read the performance counters, NULL if they are not collected
+    struct CTest_CounterSet* counter_set;
+    // Used internally, the counter values the measurement started at
+    double counter_start[CTEST_COUNTER_COUNT];
+} CTest_BenchState;
+
+/**
+ * A single benchmark in a benchmark suite.
+ */
+typedef struct CTest_Bench {
+    // The name of the benchmark
+    char const* name;
+    // The benchmark function, which runs the measured code the number of iterations in the state
+    void(*bench_fn)(CTest_BenchState*);
+} CTest_Bench;
+
+/**
+ * A benchmark suite, which is a collection of benchmarks.
+ */
+typedef struct CTest_BenchSuite {
+    // The benchmarks in the suite
+    CTest_Bench* benches;
+    // The number of benchmarks in the suite
+    size_t length;
+    // The capacity of the benchmarks array
+    size_t capacity;
+} CTest_BenchSuite;
+
+/**
+ * A filter for benchmarks, used to select which benchmarks to run when running a benchmark suite.
+ */
+typedef struct CTest_BenchFilter {
+    // A function that gets called for each benchmark in the suite, and returns true if the benchmark should be run, or false if it should be skipped
+    bool(*filter_fn)(CTest_Bench const*, void*);
+    // User data that gets passed to the filter function
+    void* user;
+} CTest_BenchFilter;
+
+/**
+ * Options for running benchmarks, zero values select the defaults.
+ */
+typedef struct CTest_BenchOptions {
+    // The minimum number of seconds a sample has to take, the iterations are calibrated to reach it. Defaults to 0.01.
+    double min_sample_time;
+    // The number of measured samples. Defaults to 20.
+    size_t samples;
+    // The number of samples that are run but not measured, after the calibration. Defaults to 2.
+    size_t warmup_samples;
+    // If true, performance counters are collected over the measured samples
+    bool counters;
+    // If true, samples are timed in processor time of the program instead of wall-clock time,
+    // which other processes competing for the processor do not disturb, but which misses the time spent waiting
+    bool cpu_time;
+    // Notified of each result as soon as its benchmark finished
+    CTest_Reporter reporter;
+} CTest_BenchOptions;
+
+/**
+ * The statistics of a benchmark run. All times are in seconds and per iteration.
+ */
+typedef struct CTest_BenchResult {
+    // The benchmark that was run
+    CTest_Bench const* bench;
+    // The number of iterations in each sample
+    size_t iterations;
+    // The number of measured samples
+    size_t samples;
+    // The mean time over the samples
+    double mean;
+    // The median time over the samples
+    double median;
+    // The 99th percentile of the time over the samples
+    double p99;
+    // The standard deviation of the time over the samples
+    double stddev;
+    // The fastest sample
+    double min;
+    // The slowest sample
+    double max;
+    // The number of iterations per second, based on the mean time
+    double ops_per_second;
+    // The number of processed bytes per second, based on the mean time, or 0 if the benchmark did not set the bytes per iteration
+    double bytes_per_second;
+    // The time of each sample, sorted in ascending order, owned by the result
+    double* sample_times;
+    // True for each performance counter that was collected
+    bool counter_available[CTEST_COUNTER_COUNT];
+    // The performance counters per iteration, where available
+    double counters[CTEST_COUNTER_COUNT];
+} CTest_BenchResult;
+
+/**
+ * The report of a benchmark suite execution, containing the results of all ran benchmarks.
+ */
+typedef struct CTest_BenchReport {
+    // The results of the benchmarks, in the order of the suite
+    CTest_BenchResult* results;
+    // The number of results
+    size_t length;
+    // The capacity of the results array
+    size_t capacity;
+} CTest_BenchReport;
+
+/**
+ * A benchmark result stored in a baseline.
+ */
+typedef struct CTest_BenchBaselineEntry {
+    // The name of the benchmark, owned by the baseline
+    char* name;
+    // The time of each sample in seconds and per iteration, owned by the baseline
+    double* sample_times;
+    // The number of samples
+    size_t samples;
+} CTest_BenchBaselineEntry;
+
+/**
+ * The benchmark results of an earlier run to compare against.
+ */
+typedef struct CTest_BenchBaseline {
+    // The stored results
+    CTest_BenchBaselineEntry* entries;
+    // The number of stored results
+    size_t length;
+    // The capacity of the entries array
+    size_t capacity;
+} CTest_BenchBaseline;
+
+/**
+ * Options for comparing benchmark results, zero values select the defaults.
+ */
+typedef struct CTest_BenchCompareOptions {
+    // The relative change of the median that counts as a regression or improvement, like 0.05 for 5%. Defaults to 0.05.
+    double threshold;
+    // The significance level the change has to reach. Defaults to 0.05.
+    double alpha;
+} CTest_BenchCompareOptions;
+
+/**
+ * The comparison of a benchmark result against its baseline.
+ */
+typedef struct CTest_BenchComparison {
+    // The median time of the baseline
+    double baseline_median;
+    // The median time of the current run
+    double current_median;
+    // The relative change of the median, positive means slower
+    double change;
+    // The two-sided p-value of the Mann-Whitney U test, the probability of a difference this large between equal distributions
+    double p_value;
+    // True, if the current run is significantly slower by more than the threshold
+    bool regressed;
+    // True, if the current run is significantly faster by more than the threshold
+    bool improved;
+} CTest_BenchComparison;
+
+/**
+ * The complexity classes a scaling benchmark can be fitted to, in increasing order of growth.
+ */
+typedef enum CTest_Complexity {
+    CTEST_COMPLEXITY_CONSTANT,
+    CTEST_COMPLEXITY_LOG_N,
+    CTEST_COMPLEXITY_N,
+    CTEST_COMPLEXITY_N_LOG_N,
+    CTEST_COMPLEXITY_N_SQUARED,
+    // The number of complexity classes
+    CTEST_COMPLEXITY_COUNT,
+} CTest_Complexity;
+
+// The maximum number of input sizes a complexity can be measured at
+#define CTEST_COMPLEXITY_MAX_SIZES 16
+
+/**
+ * Options for measuring the complexity of a scaling benchmark, zero values select the defaults.
+ */
+typedef struct CTest_ComplexityOptions {
+    // The smallest input size. Defaults to 64.
+    size_t min_size;
+    // The largest input size. Defaults to 4096.
+    size_t max_size;
+    // The number of input sizes, spread geometrically between the smallest and the largest, at most CTEST_COMPLEXITY_MAX_SIZES. Defaults to 7.
+    size_t steps;
+    // The options of the benchmark runs at each size, with defaults of 5 samples of at least 2 milliseconds and a single warmup sample,
+    // so that a measurement fits into a test case. The samples are always timed in processor time.
+    CTest_BenchOptions bench;
+    // The number of measurements a bound check takes before it fails, @see ctest_measure_complexity_at_most. Defaults to 3.
+    size_t attempts;
+} CTest_ComplexityOptions;
+
+/**
+ * The times of a benchmark at different input sizes, fitted to each complexity class.
+ */
+typedef struct CTest_ComplexityFit {
+    // The complexity class that fits the times best
+    CTest_Complexity complexity;
+    // The least-squares coefficient of each complexity class, the time of an iteration is about coefficient * f(n)
+    double coefficients[CTEST_COMPLEXITY_COUNT];
+    // The root mean square error of each fit relative to the mean time, lower fits better
+    double rms[CTEST_COMPLEXITY_COUNT];
+    // The number of measured input sizes
+    size_t count;
+    // The measured input sizes
+    size_t sizes[CTEST_COMPLEXITY_MAX_SIZES];
+    // The time of an iteration at each input size, the fastest sample when measured
+    double times[CTEST_COMPLEXITY_MAX_SIZES];
+} CTest_ComplexityFit;
+
+/**
+ * A fuzz target, which has to handle any input without crashing or failing an assertion.
+ */
+typedef struct CTest_FuzzTarget {
+    // The name of the fuzz target
+    char const* name;
+    // The fuzz function, which gets the input bytes, only valid during the call
+    void(*fuzz_fn)(uint8_t const* data, size_t size);
+} CTest_FuzzTarget;
+
+/**
+ * A collection of fuzz targets.
+ */
+typedef struct CTest_FuzzSuite {
+    // The fuzz targets in the suite
+    CTest_FuzzTarget* targets;
+    // The number of fuzz targets in the suite
+    size_t length;
+    // The capacity of the fuzz targets array
+    size_t capacity;
+} CTest_FuzzSuite;
+
+/**
+ * Options for fuzzing a target, zero values select the defaults.
+ */
+typedef struct CTest_FuzzOptions {
+    // The number of inputs to run, 0 for no limit. If neither this nor max_time is set, defaults to 100000.
+    size_t runs;
+    // The number of seconds to fuzz for, 0 for no limit
+    double max_time;
+    // The maximum size of generated inputs in bytes, larger corpus inputs are truncated. Defaults to 4096.
+    size_t max_input_size;
+    // The number of seconds a single input may take, slower inputs fail the run to surface performance cliffs. Defaults to 1.
+    // On POSIX systems, a watchdog also ends the program when an input exceeded it by more than a second without returning.
+    double input_timeout;
+    // The seed of the mutations, 0 picks one from the current time
+    uint64_t seed;
+    // The directory to load the initial corpus from and to save the inputs reaching new coverage to, NULL to keep the corpus in memory.
+    // Loading needs POSIX directory listing, elsewhere the directory is only written.
+    char const* corpus_dir;
+    // The directory to write failing and crashing inputs to. Defaults to the current directory.
+    char const* artifact_dir;
+    // Tokens the mutations insert into the inputs, like the keywords and punctuation of a parsed format
+    char const* const* dictionary;
+    // The number of tokens in the dictionary
+    size_t dictionary_length;
+} CTest_FuzzOptions;
+
+/**
+ * The result of fuzzing a target.
+ */
+typedef struct CTest_FuzzResult {
+    // The fuzz target
+    CTest_FuzzTarget const* target;
+    // The seed of the mutations, to repeat the run
+    uint64_t seed;
+    // The number of inputs run
+    size_t runs;
+    // The wall-clock time of the run in seconds
+    double elapsed;
+    // The number of inputs run per second
+    double execs_per_second;
+    // The number of inputs in the corpus at the end
+    size_t corpus_size;
+    // The number of distinct coverage features seen, 0 without coverage instrumentation
+    size_t features;
+    // The time of the slowest input in seconds
+    double slowest_input_time;
+    // True, if an input failed an assertion of the target
+    bool failed;
+    // True, if an input took longer than the input timeout
+    bool slow;
+    // The failure of the failed input
+    CTest_Execution execution;
+    // The failed or slow input, NULL if there was none
+    uint8_t* input;
+    // The size of the failed or slow input
+    size_t input_size;
+    // The file the failed or slow input was written to, NULL if it was not written
+    char* artifact_path;
+} CTest_FuzzResult;
+
 /**
  * The report of a test suite execution, containing the results of all ran test cases.
  */
@@ -135,11 +604,27 @@ typedef struct CTest_Report {
         // The capacity of the failing cases array
         size_t capacity;
     } failing;
+
+    // Strings owned by the report, like the failure messages received from processes
+    struct {
+        // The owned strings
+        char** elements;
+        // The number of owned strings
+        size_t length;
+        // The capacity of the strings array
+        size_t capacity;
+    } strings;
 } CTest_Report;
 
 // Used as a target to automatically register the cases
 extern CTest_Suite __ctest_default_suite;
 
+// Used as a target to automatically register the benchmarks
+extern CTest_BenchSuite __ctest_default_bench_suite;
+
+// Used as a target to automatically register the fuzz targets
+extern CTest_FuzzSuite __ctest_default_fuzz_suite;
+
 // The context for the currently running test case
 extern CTest_Execution* __ctest_ctx;
 
@@ -170,6 +655,55 @@ extern CTest_Execution* __ctest_ctx;
         } \
     } while (false)
 
+/**
+ * Asserts that the current case made at most the given number of allocating calls (allocations and reallocations) through the counting allocator,
+ * since the case started or the counts were last reset.
+ */
+#define CTEST_ASSERT_ALLOCATIONS_AT_MOST(n) \
+    do { \
+        CTest_AllocStats __ctest_stats = ctest_alloc_stats(); \
+        if (__ctest_stats.allocations + __ctest_stats.reallocations > (size_t)(n)) { \
+            CTEST_ASSERT_FAIL("expected at most " #n " allocations"); \
+        } \
+    } while (false)
+
+/**
+ * Asserts that the peak of the bytes allocated at the same time through the counting allocator was at most the given number of bytes in the current case,
+ * since the case started or the counts were last reset.
+ */
+#define CTEST_ASSERT_PEAK_BYTES_AT_MOST(n) \
+    do { \
+        if (ctest_alloc_stats().peak_bytes > (size_t)(n)) { \
+            CTEST_ASSERT_FAIL("expected at most " #n " bytes allocated at the same time"); \
+        } \
+    } while (false)
+
+/**
+ * Asserts that every block allocated through the counting allocator in the current case has been freed.
+ */
+#define CTEST_ASSERT_NO_LEAKS() \
+    do { \
+        if (ctest_alloc_stats().live_blocks != 0) { \
+            CTEST_ASSERT_FAIL("expected every allocated block to be freed"); \
+        } \
+    } while (false)
+
+/**
+ * Measures the complexity of the given benchmark function, which reads its input size from state->size, with the default options,
+ * and asserts that it scales at most as the given complexity class. A measurement above the bound is repeated before the case fails.
+ * @param fn The benchmark function, which is not registered in the benchmark suite.
+ * @param bound The complexity class the benchmark has to fit into, like CTEST_COMPLEXITY_N_LOG_N.
+ */
+#define CTEST_ASSERT_COMPLEXITY(fn, bound) \
+    do { \
+        CTest_Bench __ctest_bench = { .name = #fn, .bench_fn = fn }; \
+        CTest_ComplexityFit __ctest_fit; \
+        if (!ctest_measure_complexity_at_most(&__ctest_bench, (CTest_ComplexityOptions){ 0 }, bound, &__ctest_fit)) { \
+            ctest_print_complexity_fit(#fn, __ctest_fit); \
+            CTEST_ASSERT_FAIL("expected " #fn " to scale at most as " #bound); \
+        } \
+    } while (false)
+
 /**
  * Defines a test case with the given identifier as a name.
  * @param ... First the function identifier, followed by any extra configuration passed onto the test case.
@@ -177,14 +711,44 @@ extern CTest_Execution* __ctest_ctx;
 #define CTEST_CASE(...) __CTEST_CASE_IMPL(__VA_ARGS__,)
 #define __CTEST_CASE_IMPL(n, ...) \
 static void n(void); \
-__CTEST_AUTOREGISTER_CASE(n, __VA_ARGS__) \
+__CTEST_AUTOREGISTER(n, ctest_register_case(&__ctest_default_suite, (CTest_Case){ .name = #n, .test_fn = n, __VA_ARGS__ })) \
 void n(void)
 
+/**
+ * Defines a benchmark with the given identifier as a name.
+ * The body can use the benchmark state through the parameter named state, and has to run the measured code state->iterations times.
+ * @param n The function identifier.
+ */
+#define CTEST_BENCH(n) \
+static void n(CTest_BenchState* state); \
+__CTEST_AUTOREGISTER(n, ctest_register_bench(&__ctest_default_bench_suite, (CTest_Bench){ .name = #n, .bench_fn = n })) \
+void n(CTest_BenchState* state)
+
+/**
+ * Defines a fuzz target with the given identifier as a name, in the style of a libFuzzer target.
+ * @param n The function identifier.
+ * @param data The name of the parameter holding the input bytes.
+ * @param size The name of the parameter holding the size of the input.
+ */
+#define CTEST_FUZZ(n, data, size) \
+static void n(uint8_t const* data, size_t size); \
+__CTEST_AUTOREGISTER(n, ctest_register_fuzz_target(&__ctest_default_fuzz_suite, (CTest_FuzzTarget){ .name = #n, .fuzz_fn = n })) \
+void n(uint8_t const* data, size_t size)
+
+/**
+ * Forces the compiler to assume the given lvalue is read and written, so computing it can not be optimized away in a benchmark.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CTEST_DO_NOT_OPTIMIZE(value) __asm__ __volatile__("" : : "r"(&(value)) : "memory")
+#else
+    #define CTEST_DO_NOT_OPTIMIZE(value) ctest_do_not_optimize((void const*)&(value))
+#endif
+
 #if defined(__GNUC__) || defined(__clang__)
-    #define __CTEST_AUTOREGISTER_CASE(n, ...) \
+    #define __CTEST_AUTOREGISTER(n, ...) \
     __attribute__((constructor)) \
     static void __ctest_register_ ## n(void) { \
-        ctest_register_case(&__ctest_default_suite, (CTest_Case){ .name = #n, .test_fn = n, __VA_ARGS__ }); \
+        __VA_ARGS__; \
     }
 #elif defined(_MSC_VER)
     #ifdef _WIN64
@@ -194,12 +758,12 @@ void n(void)
     #endif
 
     #pragma section(".CRT$XCU",read)
-    #define __CTEST_AUTOREGISTER_CASE(n, ...) \
+    #define __CTEST_AUTOREGISTER(n, ...) \
     static void __ctest_register_ ## n(void); \
     __declspec(allocate(".CRT$XCU")) void (*__ctest_register_ ## n ## _)(void) = __ctest_register_ ## n; \
     __pragma(comment(linker,"/include:" __CTEST_LINKER_PREFIX "__ctest_register_" #n "_")) \
     static void __ctest_register_ ## n(void) { \
-        ctest_register_case(&__ctest_default_suite, (CTest_Case){ .name = #n, .test_fn = n, __VA_ARGS__ }); \
+        __VA_ARGS__; \
     }
 #else
     #error "unsupported C compiler"
@@ -216,6 +780,34 @@ void n(void)
  */
 CTEST_DEF void ctest_fail(char const* message, char const* file, char const* function, int line);
 
+/**
+ * A realloc with the signature of the library allocators, which counts the calls into the allocation statistics.
+ * @param ctx The statistics to count into, or NULL to count into the current case.
+ * @param ptr The block to resize, or NULL to allocate a new one.
+ * @param newSize The new size of the block.
+ * @returns The resized or allocated block, or NULL if the allocation failed.
+ */
+__CTEST_UNUSED CTEST_DEF void* ctest_counting_realloc(void* ctx, void* ptr, size_t newSize);
+
+/**
+ * A free with the signature of the library allocators, which counts the calls into the allocation statistics.
+ * @param ctx The statistics to count into, or NULL to count into the current case.
+ * @param ptr The block to free, which has to be allocated by @see ctest_counting_realloc.
+ */
+__CTEST_UNUSED CTEST_DEF void ctest_counting_free(void* ctx, void* ptr);
+
+/**
+ * Returns the allocation statistics of the current case.
+ * @returns The allocation statistics of the current case, or zeroes if no case is running.
+ */
+__CTEST_UNUSED CTEST_DEF CTest_AllocStats ctest_alloc_stats(void);
+
+/**
+ * Resets the allocation counts of the current case, so only the allocations of the code after this call are checked.
+ * The blocks that are still allocated remain counted as live.
+ */
+__CTEST_UNUSED CTEST_DEF void ctest_reset_alloc_stats(void);
+
 /**
  * Registers the given test case in the given test suite.
  * @param suite The test suite to register the case in.
@@ -235,7 +827,17 @@ CTEST_DEF CTest_Suite ctest_get_suite(void);
  * @param filter The filter to use when running the test suite.
  * @returns A report of the test suite execution.
  */
-CTEST_DEF CTest_Report ctest_run_suite(CTest_Suite suite, CTest_Filter filter);
+__CTEST_UNUSED CTEST_DEF CTest_Report ctest_run_suite(CTest_Suite suite, CTest_Filter filter);
+
+/**
+ * Runs the given test suite with the given filter and options, and returns a report of the execution.
+ * The executions in the report are in the order the cases were started in, which is the order of the suite unless they are shuffled, even if they ran in parallel.
+ * @param suite The test suite to run.
+ * @param filter The filter to use when running the test suite.
+ * @param options The options to run the test suite with.
+ * @returns A report of the test suite execution.
+ */
+CTEST_DEF CTest_Report ctest_run_suite_with_options(CTest_Suite suite, CTest_Filter filter, CTest_Options options);
 
 /**
  * Runs the given test case and returns the execution result.
@@ -262,107 +864,795 @@ CTEST_DEF void ctest_free_report(CTest_Report* report);
  */
 CTEST_DEF void ctest_print_report(CTest_Report report);
 
-#ifdef __cplusplus
-}
-#endif
+/**
+ * Prints the slowest cases of the given test report to stdout, by wall-clock time.
+ * @param report The test report to print the slowest cases of.
+ * @param count The maximum number of cases to print.
+ */
+CTEST_DEF void ctest_print_slowest_cases(CTest_Report report, size_t count);
 
-#endif /* CTEST_H */
+/**
+ * Creates a reporter that streams the results in the format of the writer.
+ * @param writer The writer, which has to outlive the run the reporter is used for.
+ * @returns A reporter writing through the writer.
+ */
+CTEST_DEF CTest_Reporter ctest_format_reporter(CTest_FormatWriter* writer);
 
-////////////////////////////////////////////////////////////////////////////////
-// Implementation section                                                     //
-////////////////////////////////////////////////////////////////////////////////
-#ifdef CTEST_IMPLEMENTATION
+/**
+ * Reads a monotonic, high-resolution clock.
+ * Without POSIX or Windows support, it falls back to the processor time of the program.
+ * @returns The current time in seconds, only meaningful relative to another reading.
+ */
+CTEST_DEF double ctest_now(void);
 
-#include <assert.h>
-#include <stdlib.h>
-#include <stdio.h>
+/**
+ * Makes the pointed value observable, so the computation producing it can not be optimized away.
+ * Used by @see CTEST_DO_NOT_OPTIMIZE on compilers without inline assembly.
+ * @param value The pointer to the value.
+ */
+__CTEST_UNUSED CTEST_DEF void ctest_do_not_optimize(void const* value);
 
-#define CTEST_INTERNAL_ASSERT(condition, message) assert(((void)message, condition))
+/**
+ * Registers the given benchmark in the given benchmark suite.
+ * @param suite The benchmark suite to register the benchmark in.
+ * @param bench The benchmark to register.
+ */
+__CTEST_UNUSED CTEST_DEF void ctest_register_bench(CTest_BenchSuite* suite, CTest_Bench bench);
 
-#ifdef __cplusplus
-extern "C" {
-#endif
+/**
+ * Automatically collects all benchmarks defined with @see CTEST_BENCH and returns them as a benchmark suite.
+ * @returns A benchmark suite containing all benchmarks defined with @see CTEST_BENCH.
+ */
+CTEST_DEF CTest_BenchSuite ctest_get_bench_suite(void);
 
-CTest_Suite __ctest_default_suite;
-CTest_Execution* __ctest_ctx;
+/**
+ * Returns the name of the given performance counter.
+ * @param counter The performance counter.
+ * @returns The name of the counter, in the style of perf.
+ */
+CTEST_DEF char const* ctest_counter_name(CTest_Counter counter);
 
-void ctest_fail(char const* message, char const* file, char const* function, int line) {
-    __ctest_ctx->passed = false;
-    __ctest_ctx->fail_info.message = message;
-    __ctest_ctx->fail_info.file = file;
-    __ctest_ctx->fail_info.function = function;
-    __ctest_ctx->fail_info.line = line;
-    longjmp(__ctest_ctx->jmp_env, 1);
-}
+/**
+ * Restarts the measurement of the current sample, so the setup done by the benchmark before its loop is not measured.
+ * This includes the performance counters, if they are collected.
+ * @param state The state of the running benchmark.
+ */
+CTEST_DEF void ctest_bench_reset_timer(CTest_BenchState* state);
 
-void ctest_register_case(CTest_Suite* suite, CTest_Case testCase) {
-    if (suite->length + 1 > suite->capacity) {
-        size_t newCapacity = (suite->capacity == 0) ? 8 : (suite->capacity * 2);
-        CTest_Case* newCases = (CTest_Case*)CTEST_REALLOC((void*)suite->cases, sizeof(CTest_Case) * newCapacity);
-        CTEST_INTERNAL_ASSERT(newCases != NULL, "failed to allocate memory for test suite");
-        suite->cases = newCases;
-        suite->capacity = newCapacity;
-    }
-    suite->cases[suite->length] = testCase;
-    ++suite->length;
-}
+/**
+ * Runs a single benchmark: calibrates the iterations, runs the warmup samples, then measures the samples.
+ * @param bench The benchmark to run.
+ * @param options The options to run the benchmark with.
+ * @returns The statistics of the run.
+ */
+CTEST_DEF CTest_BenchResult ctest_run_bench(CTest_Bench const* bench, CTest_BenchOptions options);
 
-CTest_Suite ctest_get_suite(void) {
-    return __ctest_default_suite;
-}
+/**
+ * Runs the given benchmark suite with the given filter and options, and returns a report of the execution.
+ * @param suite The benchmark suite to run.
+ * @param filter The filter to use when running the benchmark suite.
+ * @param options The options to run the benchmarks with.
+ * @returns A report of the benchmark suite execution.
+ */
+CTEST_DEF CTest_BenchReport ctest_run_bench_suite(CTest_BenchSuite suite, CTest_BenchFilter filter, CTest_BenchOptions options);
 
-CTest_Report ctest_run_suite(CTest_Suite suite, CTest_Filter filter) {
-    CTest_Report report = {
-        .passing = {
-            .cases = NULL,
-            .length = 0,
-            .capacity = 0,
-        },
-        .failing = {
-            .cases = NULL,
-            .length = 0,
-            .capacity = 0,
-        },
-    };
-    for (size_t i = 0; i < suite.length; ++i) {
-        CTest_Case const* testCase = &suite.cases[i];
+/**
+ * Frees the memory allocated for the given benchmark result.
+ * @param result The benchmark result to free.
+ */
+CTEST_DEF void ctest_free_bench_result(CTest_BenchResult* result);
 
-        // Use filter function, if specified
-        if (filter.filter_fn != NULL && !filter.filter_fn(testCase, filter.user)) continue;
+/**
+ * Writes the results of the given report as a baseline CSV file, with the samples of each benchmark.
+ * @param report The benchmark report to write.
+ * @param path The path of the file to write.
+ * @returns True, if the file was written successfully.
+ */
+CTEST_DEF bool ctest_write_bench_baseline(CTest_BenchReport report, char const* path);
 
-        CTest_Execution execution = ctest_run_case(testCase);
+/**
+ * Reads a baseline CSV file written by @see ctest_write_bench_baseline.
+ * @param path The path of the file to read.
+ * @param baseline The baseline to read into, which has to be freed with @see ctest_free_bench_baseline even if reading failed.
+ * @returns True, if the file was read successfully.
+ */
+CTEST_DEF bool ctest_read_bench_baseline(char const* path, CTest_BenchBaseline* baseline);
 
-        // Add execution to report
-        CTest_Execution** targetList = execution.passed ? &report.passing.cases : &report.failing.cases;
-        size_t* targetListLength = execution.passed ? &report.passing.length : &report.failing.length;
-        size_t* targetListCapacity = execution.passed ? &report.passing.capacity : &report.failing.capacity;
-        if (*targetListLength + 1 > *targetListCapacity) {
-            size_t newCapacity = (*targetListCapacity == 0) ? 8 : (*targetListCapacity * 2);
-            CTest_Execution* newList = (CTest_Execution*)CTEST_REALLOC(*targetList, newCapacity * sizeof(CTest_Execution));
-            CTEST_INTERNAL_ASSERT(newList != NULL, "failed to allocate memory for test report");
-            *targetList = newList;
-            *targetListCapacity = newCapacity;
-        }
-        (*targetList)[*targetListLength] = execution;
-        ++(*targetListLength);
-    }
-    return report;
-}
+/**
+ * Finds the entry of the benchmark with the given name in the baseline.
+ * @param baseline The baseline to search.
+ * @param name The name of the benchmark.
+ * @returns The entry of the benchmark, or NULL if the baseline does not contain it.
+ */
+CTEST_DEF CTest_BenchBaselineEntry const* ctest_find_bench_baseline_entry(CTest_BenchBaseline baseline, char const* name);
 
-CTest_Execution ctest_run_case(CTest_Case const* testCase) {
-    // Create execution context for the test case
-    CTest_Execution execution = {
-        .test_case = testCase,
-        // By default, tests are passing until an assertion fail happens
-        .passed = true,
-    };
-    if (setjmp(execution.jmp_env) == 0) {
-        // Set up environment
-        __ctest_ctx = &execution;
-        // Actually run it
-        testCase->test_fn();
-        // If we got here but the test case was expected to fail, it means that it didn't fail as expected, so we mark it as a failure
-        if (testCase->should_fail) {
+/**
+ * Compares the sample times of a benchmark against its baseline with a Mann-Whitney U test.
+ * @param baselineTimes The sample times of the baseline.
+ * @param baselineCount The number of baseline samples.
+ * @param currentTimes The sample times of the current run.
+ * @param currentCount The number of current samples.
+ * @param options The options of the comparison.
+ * @returns The comparison of the two runs.
+ */
+CTEST_DEF CTest_BenchComparison ctest_compare_bench(double const* baselineTimes, size_t baselineCount, double const* currentTimes, size_t currentCount, CTest_BenchCompareOptions options);
+
+/**
+ * Compares each result of the given report against the baseline, and prints the comparisons to stdout.
+ * @param report The benchmark report of the current run.
+ * @param baseline The baseline to compare against.
+ * @param options The options of the comparison.
+ * @returns The number of regressed benchmarks.
+ */
+CTEST_DEF size_t ctest_print_bench_comparison(CTest_BenchReport report, CTest_BenchBaseline baseline, CTest_BenchCompareOptions options);
+
+/**
+ * Frees the memory allocated for the given benchmark baseline.
+ * @param baseline The benchmark baseline to free.
+ */
+CTEST_DEF void ctest_free_bench_baseline(CTest_BenchBaseline* baseline);
+
+/**
+ * Frees the memory allocated for the given benchmark suite.
+ * @param suite The benchmark suite to free.
+ */
+CTEST_DEF void ctest_free_bench_suite(CTest_BenchSuite* suite);
+
+/**
+ * Frees the memory allocated for the given benchmark report.
+ * @param report The benchmark report to free.
+ */
+CTEST_DEF void ctest_free_bench_report(CTest_BenchReport* report);
+
+/**
+ * Prints a human-readable report of the given benchmark report to stdout.
+ * @param report The benchmark report to print.
+ */
+CTEST_DEF void ctest_print_bench_report(CTest_BenchReport report);
+
+/**
+ * Fits the given times to each complexity class with least squares, and picks the one with the lowest error.
+ * @param sizes The input sizes, at least 2 each.
+ * @param times The time at each input size.
+ * @param count The number of input sizes, at most CTEST_COMPLEXITY_MAX_SIZES are used.
+ * @returns The fit of the times.
+ */
+CTEST_DEF CTest_ComplexityFit ctest_fit_complexity(size_t const* sizes, double const* times, size_t count);
+
+/**
+ * Runs the given benchmark at growing input sizes, passed in state->size, and fits the fastest sample times to each complexity class.
+ * @param bench The benchmark to run, which has to scale its work with state->size.
+ * @param options The options of the measurement.
+ * @returns The fit of the measured times.
+ */
+CTEST_DEF CTest_ComplexityFit ctest_measure_complexity(CTest_Bench const* bench, CTest_ComplexityOptions options);
+
+/**
+ * Checks if a fit scales at most as the given complexity class.
+ * Timing noise can make a neighbouring class fit slightly better than the real one,
+ * so a fit above the bound still passes if the bound fits it almost as well.
+ * @param fit The fit to check.
+ * @param bound The highest complexity class accepted.
+ * @returns True, if the fit is within the bound.
+ */
+CTEST_DEF bool ctest_complexity_at_most(CTest_ComplexityFit fit, CTest_Complexity bound);
+
+/**
+ * Measures the complexity of the given benchmark and checks if it scales at most as the given complexity class.
+ * A measurement above the bound is repeated, up to the attempts of the options,
+ * so that a loaded machine or an instrumented build only fails the check if the bound is exceeded every time.
+ * @param bench The benchmark to run, which has to scale its work with state->size.
+ * @param options The options of the measurements.
+ * @param bound The highest complexity class accepted.
+ * @param fit If not NULL, receives the fit of the last measurement.
+ * @returns True, if the benchmark is within the bound.
+ */
+__CTEST_UNUSED CTEST_DEF bool ctest_measure_complexity_at_most(CTest_Bench const* bench, CTest_ComplexityOptions options, CTest_Complexity bound, CTest_ComplexityFit* fit);
+
+/**
+ * Gets the name of a complexity class, like "O(n log n)".
+ * @param complexity The complexity class.
+ * @returns The name of the complexity class.
+ */
+CTEST_DEF char const* ctest_complexity_name(CTest_Complexity complexity);
+
+/**
+ * Prints the times of a complexity measurement and the fit of each complexity class to stdout.
+ * @param name The name to print the fit under.
+ * @param fit The fit to print.
+ */
+__CTEST_UNUSED CTEST_DEF void ctest_print_complexity_fit(char const* name, CTest_ComplexityFit fit);
+
+/**
+ * Registers the given fuzz target in the given suite.
+ * @param suite The suite to register the fuzz target in.
+ * @param target The fuzz target to register.
+ */
+__CTEST_UNUSED CTEST_DEF void ctest_register_fuzz_target(CTest_FuzzSuite* suite, CTest_FuzzTarget target);
+
+/**
+ * Automatically collects all fuzz targets defined with @see CTEST_FUZZ and returns them as a suite.
+ * @returns A suite containing all fuzz targets defined with @see CTEST_FUZZ.
+ */
+CTEST_DEF CTest_FuzzSuite ctest_get_fuzz_suite(void);
+
+/**
+ * Frees the memory allocated for the given fuzz suite.
+ * @param suite The fuzz suite to free.
+ */
+CTEST_DEF void ctest_free_fuzz_suite(CTest_FuzzSuite* suite);
+
+/**
+ * Runs the fuzz target on a single input in-process, catching the assertions like a test case would.
+ * Crashes are not caught, so a crashing input can be inspected with a debugger or a sanitizer.
+ * @param target The fuzz target to run.
+ * @param data The input bytes, which are copied into an allocation of exactly the given size, so sanitizers catch reads past its end.
+ * @param size The size of the input.
+ * @returns The execution, with no test case set.
+ */
+CTEST_DEF CTest_Execution ctest_run_fuzz_input(CTest_FuzzTarget const* target, uint8_t const* data, size_t size);
+
+/**
+ * Fuzzes the target in-process, mutating the inputs of the corpus and keeping the ones reaching new coverage, until the limits of the options are reached
+ * or an input fails. An input failing an assertion or exceeding the input timeout is written to the artifact directory and stops the run.
+ * While fuzzing, crashing signals write the crashing input the same way before the program goes down.
+ * @param target The fuzz target to fuzz.
+ * @param options The options of the run.
+ * @returns The result of the run, which has to be freed with @see ctest_free_fuzz_result.
+ */
+CTEST_DEF CTest_FuzzResult ctest_fuzz(CTest_FuzzTarget const* target, CTest_FuzzOptions options);
+
+/**
+ * Reads a whole file, like an input written by @see ctest_fuzz.
+ * @param path The path of the file.
+ * @param data The read bytes, which have to be freed with CTEST_FREE.
+ * @param size The number of read bytes.
+ * @returns True, if the file could be read.
+ */
+CTEST_DEF bool ctest_read_fuzz_input(char const* path, uint8_t** data, size_t* size);
+
+/**
+ * Prints the statistics of a fuzzing run to stdout, and the failing input as a C string literal ready to be pasted into a regression test.
+ * @param result The result to print.
+ */
+CTEST_DEF void ctest_print_fuzz_result(CTest_FuzzResult result);
+
+/**
+ * Frees the memory allocated for the given fuzzing result.
+ * @param result The result to free.
+ */
+CTEST_DEF void ctest_free_fuzz_result(CTest_FuzzResult* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CTEST_H */
+
+////////////////////////////////////////////////////////////////////////////////
+// Implementation section                                                     //
+////////////////////////////////////////////////////////////////////////////////
+#ifdef CTEST_IMPLEMENTATION
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
+// Running cases in processes and the monotonic clock need the POSIX declarations,
+// which are hidden in strict C mode if system headers were included before us
+#if defined(__APPLE__) || (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L)
+    #include <errno.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <sys/wait.h>
+    #define __CTEST_POSIX
+#endif
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#endif
+
+#include <time.h>
+
+#ifdef __CTEST_POSIX
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/resource.h>
+    #include <sys/stat.h>
+#endif
+
+// The crash handlers of the fuzzer only need the standard signals
+#include <signal.h>
+
+// Performance counters through perf_event_open, which is called through syscall, so it also needs the default extensions
+#if defined(__linux__) && defined(__CTEST_POSIX) && (defined(_GNU_SOURCE) || defined(_DEFAULT_SOURCE)) && defined(__has_include)
+    #if __has_include(<linux/perf_event.h>)
+        #include <linux/perf_event.h>
+        #include <sys/syscall.h>
+        #define __CTEST_PERF
+    #endif
+#endif
+
+#define CTEST_INTERNAL_ASSERT(condition, message) assert(((void)message, condition))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CTest_Suite __ctest_default_suite;
+CTest_BenchSuite __ctest_default_bench_suite;
+CTest_FuzzSuite __ctest_default_fuzz_suite;
+CTest_Execution* __ctest_ctx;
+
+void ctest_fail(char const* message, char const* file, char const* function, int line) {
+    __ctest_ctx->passed = false;
+    __ctest_ctx->fail_info.message = message;
+    __ctest_ctx->fail_info.file = file;
+    __ctest_ctx->fail_info.function = function;
+    __ctest_ctx->fail_info.line = line;
+    longjmp(__ctest_ctx->jmp_env, 1);
+}
+
+void ctest_register_case(CTest_Suite* suite, CTest_Case testCase) {
+    if (suite->length + 1 > suite->capacity) {
+        size_t newCapacity = (suite->capacity == 0) ? 8 : (suite->capacity * 2);
+        CTest_Case* newCases = (CTest_Case*)CTEST_REALLOC((void*)suite->cases, sizeof(CTest_Case) * newCapacity);
+        CTEST_INTERNAL_ASSERT(newCases != NULL, "failed to allocate memory for test suite");
+        suite->cases = newCases;
+        suite->capacity = newCapacity;
+    }
+    suite->cases[suite->length] = testCase;
+    ++suite->length;
+}
+
+CTest_Suite ctest_get_suite(void) {
+    return __ctest_default_suite;
+}
+
+static void ctest_notify_execution(CTest_Reporter const* reporter, CTest_Execution const* execution) {
+    if (reporter->execution_fn != NULL) reporter->execution_fn(execution, reporter->user);
+}
+
+static void ctest_add_execution_to_report(CTest_Report* report, CTest_Execution execution) {
+    CTest_Execution** targetList = execution.passed ? &report->passing.cases : &report->failing.cases;
+    size_t* targetListLength = execution.passed ? &report->passing.length : &report->failing.length;
+    size_t* targetListCapacity = execution.passed ? &report->passing.capacity : &report->failing.capacity;
+    if (*targetListLength + 1 > *targetListCapacity) {
+        size_t newCapacity = (*targetListCapacity == 0) ? 8 : (*targetListCapacity * 2);
+        CTest_Execution* newList = (CTest_Execution*)CTEST_REALLOC(*targetList, newCapacity * sizeof(CTest_Execution));
+        CTEST_INTERNAL_ASSERT(newList != NULL, "failed to allocate memory for test report");
+        *targetList = newList;
+        *targetListCapacity = newCapacity;
+    }
+    (*targetList)[*targetListLength] = execution;
+    ++(*targetListLength);
+}
+
+#ifdef __CTEST_POSIX
+
+// Copies the string into the report, so it lives as long as the report
+static char const* ctest_add_string_to_report(CTest_Report* report, char const* text, size_t length) {
+    if (report->strings.length + 1 > report->strings.capacity) {
+        size_t newCapacity = (report->strings.capacity == 0) ? 8 : (report->strings.capacity * 2);
+        char** newStrings = (char**)CTEST_REALLOC((void*)report->strings.elements, newCapacity * sizeof(char*));
+        CTEST_INTERNAL_ASSERT(newStrings != NULL, "failed to allocate memory for test report");
+        report->strings.elements = newStrings;
+        report->strings.capacity = newCapacity;
+    }
+    char* copy = (char*)CTEST_REALLOC(NULL, length + 1);
+    CTEST_INTERNAL_ASSERT(copy != NULL, "failed to allocate memory for test report");
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    report->strings.elements[report->strings.length++] = copy;
+    return copy;
+}
+
+// The result of a case as it's sent from its process, followed by the failure strings
+typedef struct CTest_ProcessResult {
+    bool passed;
+    int line;
+    double wall_time;
+    double cpu_time;
+    CTest_AllocStats alloc_stats;
+    // The lengths of the message, file and function strings, SIZE_MAX for NULL
+    size_t lengths[3];
+} CTest_ProcessResult;
+
+// A process running a single case
+typedef struct CTest_Process {
+    // The index of the case among the selected cases
+    size_t index;
+    pid_t pid;
+    // The read end of the pipe the result is sent through
+    int fd;
+    // The bytes received so far
+    char* buffer;
+    size_t length;
+    size_t capacity;
+    // The time the case was started at
+    double start_time;
+    // The time the case has to finish by, 0 if there is no limit
+    double deadline;
+    // The timeout the deadline was set with
+    double timeout;
+    bool timed_out;
+} CTest_Process;
+
+static void ctest_write_all(int fd, void const* data, size_t length) {
+    char const* bytes = (char const*)data;
+    while (length > 0) {
+        ssize_t written = write(fd, bytes, length);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return;
+        bytes += written;
+        length -= (size_t)written;
+    }
+}
+
+static void ctest_run_case_in_process(CTest_Case const* testCase, int fd) {
+    CTest_Execution execution = ctest_run_case(testCase);
+    char const* strings[3] = { execution.fail_info.message, execution.fail_info.file, execution.fail_info.function };
+    CTest_ProcessResult result = {
+        .passed = execution.passed,
+        .line = execution.fail_info.line,
+        .wall_time = execution.wall_time,
+        .cpu_time = execution.cpu_time,
+        .alloc_stats = execution.alloc_stats,
+    };
+    for (size_t i = 0; i < 3; ++i) result.lengths[i] = (strings[i] == NULL) ? SIZE_MAX : strlen(strings[i]);
+    ctest_write_all(fd, &result, sizeof(result));
+    for (size_t i = 0; i < 3; ++i) {
+        if (strings[i] != NULL) ctest_write_all(fd, strings[i], result.lengths[i]);
+    }
+    // We skip atexit handlers of the parent, but the output of the case should still show up
+    fflush(stdout);
+    fflush(stderr);
+    _exit(0);
+}
+
+static bool ctest_start_process(CTest_Process* process, CTest_Case const* testCase, size_t index, double timeout) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    // Anything buffered would be printed by both processes otherwise
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        ctest_run_case_in_process(testCase, fds[1]);
+    }
+    close(fds[1]);
+    double now = ctest_now();
+    *process = (CTest_Process){
+        .index = index,
+        .pid = pid,
+        .fd = fds[0],
+        .start_time = now,
+        .deadline = (timeout > 0) ? now + timeout : 0,
+        .timeout = timeout,
+    };
+    return true;
+}
+
+static char const* ctest_signal_name(int signal) {
+    switch (signal) {
+    case SIGABRT: return "SIGABRT";
+    case SIGBUS: return "SIGBUS";
+    case SIGFPE: return "SIGFPE";
+    case SIGILL: return "SIGILL";
+    case SIGKILL: return "SIGKILL";
+    case SIGSEGV: return "SIGSEGV";
+    case SIGTERM: return "SIGTERM";
+    default: return "unknown signal";
+    }
+}
+
+// Waits for the finished process and turns what it sent, or how it ended, into an execution
+static CTest_Execution ctest_finish_process(CTest_Report* report, CTest_Process* process, CTest_Case const* testCase) {
+    close(process->fd);
+    int status = 0;
+    while (waitpid(process->pid, &status, 0) < 0 && errno == EINTR) {}
+
+    CTest_Execution execution = {
+        .test_case = testCase,
+        .passed = false,
+        .wall_time = ctest_now() - process->start_time,
+    };
+    CTest_ProcessResult result;
+    if (!process->timed_out && process->length >= sizeof(result)) {
+        memcpy(&result, process->buffer, sizeof(result));
+        char const** strings[3] = { &execution.fail_info.message, &execution.fail_info.file, &execution.fail_info.function };
+        size_t offset = sizeof(result);
+        bool complete = true;
+        for (size_t i = 0; i < 3; ++i) {
+            if (result.lengths[i] == SIZE_MAX) continue;
+            if (offset + result.lengths[i] > process->length) {
+                complete = false;
+                break;
+            }
+            *strings[i] = ctest_add_string_to_report(report, process->buffer + offset, result.lengths[i]);
+            offset += result.lengths[i];
+        }
+        if (complete) {
+            execution.passed = result.passed;
+            execution.fail_info.line = result.line;
+            execution.wall_time = result.wall_time;
+            execution.cpu_time = result.cpu_time;
+            execution.alloc_stats = result.alloc_stats;
+            CTEST_FREE(process->buffer);
+            return execution;
+        }
+    }
+    CTEST_FREE(process->buffer);
+
+    // No result, so the process died before it could report
+    char message[128];
+    if (process->timed_out) {
+        snprintf(message, sizeof(message), "timed out after %g seconds", process->timeout);
+    }
+    else if (WIFSIGNALED(status)) {
+        snprintf(message, sizeof(message), "terminated by signal %d (%s)", WTERMSIG(status), ctest_signal_name(WTERMSIG(status)));
+    }
+    else {
+        snprintf(message, sizeof(message), "exited with code %d without reporting a result", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    }
+    execution.fail_info.message = ctest_add_string_to_report(report, message, strlen(message));
+    execution.fail_info.function = testCase->name;
+    // A case that is expected to fail may also do so by crashing
+    execution.passed = testCase->should_fail;
+    return execution;
+}
+
+static void ctest_read_from_process(CTest_Process* process, bool* finished) {
+    if (process->length + 4096 > process->capacity) {
+        size_t newCapacity = (process->capacity == 0) ? 4096 : (process->capacity * 2);
+        char* newBuffer = (char*)CTEST_REALLOC(process->buffer, newCapacity);
+        CTEST_INTERNAL_ASSERT(newBuffer != NULL, "failed to allocate memory for process result");
+        process->buffer = newBuffer;
+        process->capacity = newCapacity;
+    }
+    ssize_t received = read(process->fd, process->buffer + process->length, process->capacity - process->length);
+    if (received < 0 && errno == EINTR) return;
+    if (received <= 0) {
+        *finished = true;
+        return;
+    }
+    process->length += (size_t)received;
+}
+
+// An execution of a case that could not run to the end for reasons outside of the case
+static CTest_Execution ctest_abandoned_execution(CTest_Report* report, CTest_Case const* testCase, char const* message) {
+    CTest_Execution execution = {
+        .test_case = testCase,
+        .passed = false,
+    };
+    execution.fail_info.message = ctest_add_string_to_report(report, message, strlen(message));
+    execution.fail_info.function = testCase->name;
+    return execution;
+}
+
+// Runs the cases in processes, at most jobs at a time, and stores their executions in the order of the cases
+static void ctest_run_cases_in_processes(CTest_Report* report, CTest_Case const** cases, size_t caseCount, CTest_Execution* executions, CTest_Options options) {
+    CTest_Process* processes = (CTest_Process*)CTEST_REALLOC(NULL, options.jobs * sizeof(CTest_Process));
+    struct pollfd* pollFds = (struct pollfd*)CTEST_REALLOC(NULL, options.jobs * sizeof(struct pollfd));
+    CTEST_INTERNAL_ASSERT(processes != NULL && pollFds != NULL, "failed to allocate memory for processes");
+    size_t running = 0;
+    size_t next = 0;
+    while (next < caseCount || running > 0) {
+        // Keep all slots busy
+        while (running < options.jobs && next < caseCount) {
+            double timeout = (cases[next]->timeout > 0) ? cases[next]->timeout : options.timeout;
+            if (ctest_start_process(&processes[running], cases[next], next, timeout)) {
+                ++running;
+            }
+            else {
+                // We could not start a process, fall back to running in-process
+                executions[next] = ctest_run_case(cases[next]);
+                ctest_notify_execution(&options.reporter, &executions[next]);
+            }
+            ++next;
+        }
+        if (running == 0) continue;
+
+        // Wait until a process sends something, or the earliest deadline passes
+        double now = ctest_now();
+        int waitMs = -1;
+        for (size_t i = 0; i < running; ++i) {
+            pollFds[i] = (struct pollfd){ .fd = processes[i].fd, .events = POLLIN };
+            if (processes[i].deadline == 0 || processes[i].timed_out) continue;
+            double remainingMs = (processes[i].deadline - now) * 1000.0 + 1.0;
+            int processWaitMs = (remainingMs < 0) ? 0 : (remainingMs > (double)INT_MAX) ? INT_MAX : (int)remainingMs;
+            if (waitMs < 0 || processWaitMs < waitMs) waitMs = processWaitMs;
+        }
+        if (poll(pollFds, (nfds_t)running, waitMs) < 0 && errno != EINTR) {
+            // We can't wait for the processes anymore, the running and remaining cases fail instead of going missing from the report
+            char message[128];
+            snprintf(message, sizeof(message), "could not wait for the case process: %s", strerror(errno));
+            for (size_t i = 0; i < running; ++i) {
+                kill(processes[i].pid, SIGKILL);
+                close(processes[i].fd);
+                while (waitpid(processes[i].pid, NULL, 0) < 0 && errno == EINTR) {}
+                CTEST_FREE(processes[i].buffer);
+                executions[processes[i].index] = ctest_abandoned_execution(report, cases[processes[i].index], message);
+                ctest_notify_execution(&options.reporter, &executions[processes[i].index]);
+            }
+            for (; next < caseCount; ++next) {
+                executions[next] = ctest_abandoned_execution(report, cases[next], "not run, waiting for the case processes failed");
+                ctest_notify_execution(&options.reporter, &executions[next]);
+            }
+            break;
+        }
+
+        now = ctest_now();
+        for (size_t i = 0; i < running;) {
+            CTest_Process* process = &processes[i];
+            bool finished = false;
+            if (pollFds[i].revents != 0) ctest_read_from_process(process, &finished);
+            if (!finished && !process->timed_out && process->deadline != 0 && now >= process->deadline) {
+                // The pipe closes when the process dies, which finishes it
+                kill(process->pid, SIGKILL);
+                process->timed_out = true;
+            }
+            if (!finished) {
+                ++i;
+                continue;
+            }
+            executions[process->index] = ctest_finish_process(report, process, cases[process->index]);
+            ctest_notify_execution(&options.reporter, &executions[process->index]);
+            // Swap in the last one, its poll state moves along with it
+            --running;
+            processes[i] = processes[running];
+            pollFds[i] = pollFds[running];
+        }
+    }
+    CTEST_FREE(pollFds);
+    CTEST_FREE(processes);
+}
+
+#endif /* __CTEST_POSIX */
+
+// A stable hash of the case names for sharding (64-bit FNV-1a), so every shard agrees on the partitioning
+static uint64_t ctest_hash_name(char const* name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (; *name != '\0'; ++name) {
+        hash ^= (uint64_t)(unsigned char)*name;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// The next number of a seeded sequence (splitmix64), the same on every platform
+static uint64_t ctest_next_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Collects the cases to run in order: filtered, sharded, then repeated and shuffled as the options say
+static CTest_Case const** ctest_select_cases(CTest_Suite suite, CTest_Filter filter, CTest_Options options, size_t* caseCount) {
+    size_t repeat = (options.repeat == 0) ? 1 : options.repeat;
+    size_t selectedCount = 0;
+    CTest_Case const** cases = (CTest_Case const**)CTEST_REALLOC(NULL, (suite.length * repeat + 1) * sizeof(CTest_Case const*));
+    CTEST_INTERNAL_ASSERT(cases != NULL, "failed to allocate memory for test cases");
+    for (size_t i = 0; i < suite.length; ++i) {
+        CTest_Case const* testCase = &suite.cases[i];
+        // Use filter function, if specified
+        if (filter.filter_fn != NULL && !filter.filter_fn(testCase, filter.user)) continue;
+        if (options.shard_count > 1 && ctest_hash_name(testCase->name) % options.shard_count != options.shard_index) continue;
+        cases[selectedCount++] = testCase;
+    }
+
+    uint64_t random = options.seed;
+    for (size_t r = 0; r < repeat; ++r) {
+        CTest_Case const** round = cases + r * selectedCount;
+        if (r > 0) memcpy((void*)round, (void*)cases, selectedCount * sizeof(CTest_Case const*));
+        if (!options.shuffle) continue;
+        // Fisher-Yates, each repetition gets a different order
+        for (size_t i = selectedCount; i > 1; --i) {
+            size_t j = (size_t)(ctest_next_random(&random) % i);
+            CTest_Case const* tmp = round[i - 1];
+            round[i - 1] = round[j];
+            round[j] = tmp;
+        }
+    }
+    *caseCount = selectedCount * repeat;
+    return cases;
+}
+
+CTest_Report ctest_run_suite_with_options(CTest_Suite suite, CTest_Filter filter, CTest_Options options) {
+    CTest_Report report = {
+        .passing = {
+            .cases = NULL,
+            .length = 0,
+            .capacity = 0,
+        },
+        .failing = {
+            .cases = NULL,
+            .length = 0,
+            .capacity = 0,
+        },
+        .strings = {
+            .elements = NULL,
+            .length = 0,
+            .capacity = 0,
+        },
+    };
+    size_t caseCount;
+    CTest_Case const** cases = ctest_select_cases(suite, filter, options, &caseCount);
+    if (options.reporter.begin_fn != NULL) options.reporter.begin_fn(caseCount, options.reporter.user);
+
+#ifdef __CTEST_POSIX
+    // Timeouts can only be enforced in processes, a timeout of the run applies to all cases
+    if (options.jobs == 0 && options.timeout > 0) options.jobs = 1;
+
+    if (options.jobs > 0) {
+        // The processes finish in any order, their results are put back in the order of the cases
+        CTest_Execution* executions = (CTest_Execution*)CTEST_REALLOC(NULL, (caseCount + 1) * sizeof(CTest_Execution));
+        CTEST_INTERNAL_ASSERT(executions != NULL, "failed to allocate memory for test executions");
+        ctest_run_cases_in_processes(&report, cases, caseCount, executions, options);
+        for (size_t i = 0; i < caseCount; ++i) ctest_add_execution_to_report(&report, executions[i]);
+        CTEST_FREE(executions);
+        CTEST_FREE((void*)cases);
+        if (options.reporter.end_fn != NULL) options.reporter.end_fn(options.reporter.user);
+        return report;
+    }
+#endif
+
+    // Without processes, the cases run in this process one after another
+    for (size_t i = 0; i < caseCount; ++i) {
+#ifdef __CTEST_POSIX
+        // Only the cases with their own timeout go to a process, one at a time, so the others keep their in-process state
+        if (cases[i]->timeout > 0) {
+            CTest_Options caseOptions = options;
+            caseOptions.jobs = 1;
+            CTest_Execution processExecution;
+            ctest_run_cases_in_processes(&report, &cases[i], 1, &processExecution, caseOptions);
+            ctest_add_execution_to_report(&report, processExecution);
+            continue;
+        }
+#endif
+        CTest_Execution execution = ctest_run_case(cases[i]);
+        ctest_notify_execution(&options.reporter, &execution);
+        ctest_add_execution_to_report(&report, execution);
+    }
+    CTEST_FREE((void*)cases);
+    if (options.reporter.end_fn != NULL) options.reporter.end_fn(options.reporter.user);
+    return report;
+}
+
+CTest_Report ctest_run_suite(CTest_Suite suite, CTest_Filter filter) {
+    return ctest_run_suite_with_options(suite, filter, (CTest_Options){ 0 });
+}
+
+CTest_Execution ctest_run_case(CTest_Case const* testCase) {
+    // Create execution context for the test case
+    CTest_Execution execution = {
+        .test_case = testCase,
+        // By default, tests are passing until an assertion fail happens
+        .passed = true,
+    };
+    double startTime = ctest_now();
+    clock_t startCpuTime = clock();
+    if (setjmp(execution.jmp_env) == 0) {
+        // Set up environment
+        __ctest_ctx = &execution;
+        // Actually run it
+        testCase->test_fn();
+        // If we got here but the test case was expected to fail, it means that it didn't fail as expected, so we mark it as a failure
+        if (testCase->should_fail) {
             execution.passed = false;
             execution.fail_info.message = "test case was expected to fail, but it passed";
             execution.fail_info.function = testCase->name;
@@ -378,6 +1668,10 @@ CTest_Execution ctest_run_case(CTest_Case const* testCase) {
             // Actual failure
         }
     }
+    execution.wall_time = ctest_now() - startTime;
+    execution.cpu_time = (double)(clock() - startCpuTime) / (double)CLOCKS_PER_SEC;
+    // The execution is returned by copy, allocations after this are not counted into it anymore
+    __ctest_ctx = NULL;
     return execution;
 }
 
@@ -390,6 +1684,11 @@ void ctest_free_suite(CTest_Suite* suite) {
 void ctest_free_report(CTest_Report* report) {
     CTEST_FREE(report->passing.cases);
     CTEST_FREE(report->failing.cases);
+    for (size_t i = 0; i < report->strings.length; ++i) CTEST_FREE(report->strings.elements[i]);
+    CTEST_FREE((void*)report->strings.elements);
+    report->strings.elements = NULL;
+    report->strings.length = 0;
+    report->strings.capacity = 0;
     report->passing.cases = NULL;
     report->failing.cases = NULL;
     report->passing.length = 0;
@@ -398,12 +1697,25 @@ void ctest_free_report(CTest_Report* report) {
     report->failing.capacity = 0;
 }
 
+// Formats a duration in seconds with a fitting unit
+static void ctest_format_time(char* buffer, size_t size, double seconds) {
+    if (seconds < 1e-6) snprintf(buffer, size, "%.2f ns", seconds * 1e9);
+    else if (seconds < 1e-3) snprintf(buffer, size, "%.2f us", seconds * 1e6);
+    else if (seconds < 1) snprintf(buffer, size, "%.2f ms", seconds * 1e3);
+    else snprintf(buffer, size, "%.2f s", seconds);
+}
+
 void ctest_print_report(CTest_Report report) {
     printf("Test report:\n");
     printf("  Passing cases (%zu):\n", report.passing.length);
     for (size_t i = 0; i < report.passing.length; ++i) {
         CTest_Execution execution = report.passing.cases[i];
-        printf("    - %s\n", execution.test_case->name);
+        if (execution.alloc_stats.live_blocks > 0) {
+            printf("    - %s (leaked %zu bytes in %zu blocks)\n", execution.test_case->name, execution.alloc_stats.live_bytes, execution.alloc_stats.live_blocks);
+        }
+        else {
+            printf("    - %s\n", execution.test_case->name);
+        }
     }
     printf("  Failing cases (%zu):\n", report.failing.length);
     for (size_t i = 0; i < report.failing.length; ++i) {
@@ -418,56 +1730,2075 @@ void ctest_print_report(CTest_Report report) {
     }
 }
 
-#ifdef __cplusplus
+static int ctest_compare_executions_by_wall_time(void const* a, void const* b) {
+    double x = (*(CTest_Execution const* const*)a)->wall_time;
+    double y = (*(CTest_Execution const* const*)b)->wall_time;
+    // Slowest first
+    return (x < y) - (x > y);
 }
-#endif
 
-#undef CTEST_ASSERT
+void ctest_print_slowest_cases(CTest_Report report, size_t count) {
+    size_t total = report.passing.length + report.failing.length;
+    if (count > total) count = total;
+    if (count == 0) return;
+
+    CTest_Execution const** executions = (CTest_Execution const**)CTEST_REALLOC(NULL, total * sizeof(CTest_Execution const*));
+    CTEST_INTERNAL_ASSERT(executions != NULL, "failed to allocate memory for slowest cases");
+    double totalTime = 0;
+    for (size_t i = 0; i < report.passing.length; ++i) executions[i] = &report.passing.cases[i];
+    for (size_t i = 0; i < report.failing.length; ++i) executions[report.passing.length + i] = &report.failing.cases[i];
+    for (size_t i = 0; i < total; ++i) totalTime += executions[i]->wall_time;
+    qsort((void*)executions, total, sizeof(CTest_Execution const*), ctest_compare_executions_by_wall_time);
+
+    char wallTime[32], cpuTime[32];
+    printf("Slowest cases (%zu):\n", count);
+    for (size_t i = 0; i < count; ++i) {
+        CTest_Execution const* execution = executions[i];
+        ctest_format_time(wallTime, sizeof(wallTime), execution->wall_time);
+        ctest_format_time(cpuTime, sizeof(cpuTime), execution->cpu_time);
+        double share = (totalTime > 0) ? execution->wall_time / totalTime * 100.0 : 0;
+        printf("  - %s: %s (cpu %s, %.1f%% of the total)\n", execution->test_case->name, wallTime, cpuTime, share);
+    }
+    CTEST_FREE((void*)executions);
+}
+
+// Reporters ///////////////////////////////////////////////////////////////////
+
+static void ctest_write_xml_escaped(FILE* out, char const* text) {
+    for (; *text != '\0'; ++text) {
+        switch (*text) {
+        case '&': fputs("&amp;", out); break;
+        case '<': fputs("&lt;", out); break;
+        case '>': fputs("&gt;", out); break;
+        case '"': fputs("&quot;", out); break;
+        case '\'': fputs("&apos;", out); break;
+        default: fputc(*text, out); break;
+        }
+    }
+}
+
+// Writes the text as a JSON string, or null if it's NULL
+static void ctest_write_json_string(FILE* out, char const* text) {
+    if (text == NULL) {
+        fputs("null", out);
+        return;
+    }
+    fputc('"', out);
+    for (; *text != '\0'; ++text) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c == '\n') fputs("\\n", out);
+        else if (c < 0x20) fprintf(out, "\\u%04x", c);
+        else fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+// TAP comments and directives end at the line, so the text is kept on one
+static void ctest_write_tap_text(FILE* out, char const* text) {
+    for (; *text != '\0'; ++text) fputc((*text == '\n' || *text == '\r') ? ' ' : *text, out);
+}
+
+static void ctest_format_begin(size_t count, void* user) {
+    CTest_FormatWriter* writer = (CTest_FormatWriter*)user;
+    writer->written = 0;
+    writer->failed = 0;
+    switch (writer->format) {
+    case CTEST_FORMAT_JUNIT:
+        fprintf(writer->out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n  <testsuite name=\"ctest\" tests=\"%zu\">\n", count);
+        break;
+    case CTEST_FORMAT_TAP:
+        fprintf(writer->out, "TAP version 13\n1..%zu\n", count);
+        break;
+    case CTEST_FORMAT_JSON_LINES:
+        fprintf(writer->out, "{\"type\":\"begin\",\"count\":%zu}\n", count);
+        break;
+    }
+    fflush(writer->out);
+}
+
+static void ctest_format_execution(CTest_Execution const* execution, void* user) {
+    CTest_FormatWriter* writer = (CTest_FormatWriter*)user;
+    FILE* out = writer->out;
+    ++writer->written;
+    if (!execution->passed) ++writer->failed;
+    char const* message = (execution->fail_info.message == NULL) ? "" : execution->fail_info.message;
+    switch (writer->format) {
+    case CTEST_FORMAT_JUNIT:
+        fputs("    <testcase classname=\"ctest\" name=\"", out);
+        ctest_write_xml_escaped(out, execution->test_case->name);
+        fprintf(out, "\" time=\"%.6f\"", execution->wall_time);
+        if (execution->passed) {
+            fputs("/>\n", out);
+            break;
+        }
+        fputs(">\n      <failure message=\"", out);
+        ctest_write_xml_escaped(out, message);
+        fputs("\">", out);
+        if (execution->fail_info.file != NULL) {
+            ctest_write_xml_escaped(out, execution->fail_info.file);
+            fprintf(out, ":%d", execution->fail_info.line);
+        }
+        fputs("</failure>\n    </testcase>\n", out);
+        break;
+    case CTEST_FORMAT_TAP:
+        fprintf(out, "%s %zu - ", execution->passed ? "ok" : "not ok", writer->written);
+        ctest_write_tap_text(out, execution->test_case->name);
+        fprintf(out, " # time=%.3fms\n", execution->wall_time * 1e3);
+        if (execution->passed) break;
+        fputs("  ---\n  message: ", out);
+        ctest_write_json_string(out, message);
+        if (execution->fail_info.file != NULL) {
+            fputs("\n  file: ", out);
+            ctest_write_json_string(out, execution->fail_info.file);
+            fprintf(out, "\n  line: %d", execution->fail_info.line);
+        }
+        fputs("\n  ...\n", out);
+        break;
+    case CTEST_FORMAT_JSON_LINES:
+        fputs("{\"type\":\"case\",\"name\":", out);
+        ctest_write_json_string(out, execution->test_case->name);
+        fprintf(out, ",\"passed\":%s,\"wall_time\":%.9g,\"cpu_time\":%.9g", execution->passed ? "true" : "false", execution->wall_time, execution->cpu_time);
+        fprintf(out, ",\"allocations\":%zu,\"leaked_blocks\":%zu", execution->alloc_stats.allocations + execution->alloc_stats.reallocations, execution->alloc_stats.live_blocks);
+        fputs(",\"message\":", out);
+        ctest_write_json_string(out, execution->fail_info.message);
+        fputs(",\"file\":", out);
+        ctest_write_json_string(out, execution->fail_info.file);
+        fputs(",\"function\":", out);
+        ctest_write_json_string(out, execution->fail_info.function);
+        fprintf(out, ",\"line\":%d}\n", execution->fail_info.line);
+        break;
+    }
+    fflush(out);
+}
+
+static void ctest_format_bench_result(struct CTest_BenchResult const* result, void* user) {
+    CTest_FormatWriter* writer = (CTest_FormatWriter*)user;
+    FILE* out = writer->out;
+    ++writer->written;
+    switch (writer->format) {
+    case CTEST_FORMAT_JUNIT:
+        // The time of a benchmark is the median time of an iteration, the rest goes into properties
+        fputs("    <testcase classname=\"ctest.bench\" name=\"", out);
+        ctest_write_xml_escaped(out, result->bench->name);
+        fprintf(out, "\" time=\"%.9f\">\n      <properties>\n", result->median);
+        fprintf(out, "        <property name=\"mean\" value=\"%.9g\"/>\n        <property name=\"p99\" value=\"%.9g\"/>\n", result->mean, result->p99);
+        fprintf(out, "        <property name=\"stddev\" value=\"%.9g\"/>\n        <property name=\"ops_per_second\" value=\"%.9g\"/>\n", result->stddev, result->ops_per_second);
+        for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) {
+            if (result->counter_available[i]) fprintf(out, "        <property name=\"%s\" value=\"%.9g\"/>\n", ctest_counter_name((CTest_Counter)i), result->counters[i]);
+        }
+        fputs("      </properties>\n    </testcase>\n", out);
+        break;
+    case CTEST_FORMAT_TAP:
+        fprintf(out, "ok %zu - ", writer->written);
+        ctest_write_tap_text(out, result->bench->name);
+        fprintf(out, " # mean=%.3fns median=%.3fns p99=%.3fns\n", result->mean * 1e9, result->median * 1e9, result->p99 * 1e9);
+        break;
+    case CTEST_FORMAT_JSON_LINES:
+        fputs("{\"type\":\"bench\",\"name\":", out);
+        ctest_write_json_string(out, result->bench->name);
+        fprintf(out, ",\"iterations\":%zu,\"samples\":%zu,\"mean\":%.9g,\"median\":%.9g,\"p99\":%.9g,\"stddev\":%.9g,\"min\":%.9g,\"max\":%.9g",
+            result->iterations, result->samples, result->mean, result->median, result->p99, result->stddev, result->min, result->max);
+        fprintf(out, ",\"ops_per_second\":%.9g,\"bytes_per_second\":%.9g,\"counters\":{", result->ops_per_second, result->bytes_per_second);
+        bool first = true;
+        for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) {
+            if (!result->counter_available[i]) continue;
+            fprintf(out, first ? "\"%s\":%.9g" : ",\"%s\":%.9g", ctest_counter_name((CTest_Counter)i), result->counters[i]);
+            first = false;
+        }
+        fputs("}}\n", out);
+        break;
+    }
+    fflush(out);
+}
+
+static void ctest_format_end(void* user) {
+    CTest_FormatWriter* writer = (CTest_FormatWriter*)user;
+    switch (writer->format) {
+    case CTEST_FORMAT_JUNIT:
+        fputs("  </testsuite>\n</testsuites>\n", writer->out);
+        break;
+    case CTEST_FORMAT_TAP:
+        break;
+    case CTEST_FORMAT_JSON_LINES:
+        fprintf(writer->out, "{\"type\":\"end\",\"count\":%zu,\"failed\":%zu}\n", writer->written, writer->failed);
+        break;
+    }
+    fflush(writer->out);
+}
+
+CTest_Reporter ctest_format_reporter(CTest_FormatWriter* writer) {
+    return (CTest_Reporter){
+        .begin_fn = ctest_format_begin,
+        .execution_fn = ctest_format_execution,
+        .bench_result_fn = ctest_format_bench_result,
+        .end_fn = ctest_format_end,
+        .user = writer,
+    };
+}
+
+// Allocation counting /////////////////////////////////////////////////////////
+
+// Prefixed to each counted block to know its size when it's resized or freed, aligned for any type
+typedef union CTest_AllocHeader {
+    size_t size;
+    long double align_long_double;
+    long long align_long_long;
+    void* align_pointer;
+} CTest_AllocHeader;
+
+static CTest_AllocStats* ctest_alloc_stats_target(void* ctx) {
+    if (ctx != NULL) return (CTest_AllocStats*)ctx;
+    if (__ctest_ctx != NULL) return &__ctest_ctx->alloc_stats;
+    return NULL;
+}
+
+// Blocks can outlive the case that allocated them, so live counts saturate instead of wrapping around
+static void ctest_remove_live_bytes(CTest_AllocStats* stats, size_t size) {
+    stats->live_bytes = (stats->live_bytes > size) ? stats->live_bytes - size : 0;
+}
+
+void* ctest_counting_realloc(void* ctx, void* ptr, size_t newSize) {
+    CTest_AllocStats* stats = ctest_alloc_stats_target(ctx);
+    CTest_AllocHeader* header = (ptr == NULL) ? NULL : (CTest_AllocHeader*)ptr - 1;
+    size_t oldSize = (header == NULL) ? 0 : header->size;
+    if (newSize > SIZE_MAX - sizeof(CTest_AllocHeader)) return NULL;
+    CTest_AllocHeader* newHeader = (CTest_AllocHeader*)CTEST_REALLOC(header, sizeof(CTest_AllocHeader) + newSize);
+    if (newHeader == NULL) return NULL;
+    newHeader->size = newSize;
+    if (stats != NULL) {
+        if (ptr == NULL) {
+            ++stats->allocations;
+            ++stats->live_blocks;
+        }
+        else {
+            ++stats->reallocations;
+        }
+        stats->allocated_bytes += newSize;
+        ctest_remove_live_bytes(stats, oldSize);
+        stats->live_bytes += newSize;
+        if (stats->live_bytes > stats->peak_bytes) stats->peak_bytes = stats->live_bytes;
+    }
+    return newHeader + 1;
+}
+
+void ctest_counting_free(void* ctx, void* ptr) {
+    if (ptr == NULL) return;
+    CTest_AllocHeader* header = (CTest_AllocHeader*)ptr - 1;
+    CTest_AllocStats* stats = ctest_alloc_stats_target(ctx);
+    if (stats != NULL) {
+        ++stats->frees;
+        if (stats->live_blocks > 0) --stats->live_blocks;
+        ctest_remove_live_bytes(stats, header->size);
+    }
+    CTEST_FREE(header);
+}
+
+CTest_AllocStats ctest_alloc_stats(void) {
+    if (__ctest_ctx == NULL) return (CTest_AllocStats){ 0 };
+    return __ctest_ctx->alloc_stats;
+}
+
+void ctest_reset_alloc_stats(void) {
+    if (__ctest_ctx == NULL) return;
+    CTest_AllocStats* stats = &__ctest_ctx->alloc_stats;
+    *stats = (CTest_AllocStats){
+        .live_bytes = stats->live_bytes,
+        .peak_bytes = stats->live_bytes,
+        .live_blocks = stats->live_blocks,
+    };
+}
+
+// Benchmarks ///////////////////////////////////////////////////////////////////
+
+double ctest_now(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#elif defined(__CTEST_POSIX)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / (double)CLOCKS_PER_SEC;
+#endif
+}
+
+// Reads the processor time of the program in seconds, with clock_gettime where available, because clock() can be coarse
+static double ctest_cpu_now(void) {
+#if defined(__CTEST_POSIX) && defined(CLOCK_PROCESS_CPUTIME_ID)
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / (double)CLOCKS_PER_SEC;
+#endif
+}
+
+static void const* volatile ctest_do_not_optimize_sink;
+
+void ctest_do_not_optimize(void const* value) {
+    ctest_do_not_optimize_sink = value;
+}
+
+void ctest_register_bench(CTest_BenchSuite* suite, CTest_Bench bench) {
+    if (suite->length + 1 > suite->capacity) {
+        size_t newCapacity = (suite->capacity == 0) ? 8 : (suite->capacity * 2);
+        CTest_Bench* newBenches = (CTest_Bench*)CTEST_REALLOC(suite->benches, newCapacity * sizeof(CTest_Bench));
+        CTEST_INTERNAL_ASSERT(newBenches != NULL, "failed to allocate memory for benchmark suite");
+        suite->benches = newBenches;
+        suite->capacity = newCapacity;
+    }
+    suite->benches[suite->length++] = bench;
+}
+
+CTest_BenchSuite ctest_get_bench_suite(void) {
+    return __ctest_default_bench_suite;
+}
+
+// Performance counters ////////////////////////////////////////////////////////
+
+// The open performance counters of a benchmark
+typedef struct CTest_CounterSet {
+    // The perf event of each counter, -1 if it's not open
+    int fds[CTEST_COUNTER_COUNT];
+    // True for each counter that can be read, either from perf or from a software fallback
+    bool available[CTEST_COUNTER_COUNT];
+} CTest_CounterSet;
+
+char const* ctest_counter_name(CTest_Counter counter) {
+    switch (counter) {
+    case CTEST_COUNTER_INSTRUCTIONS: return "instructions";
+    case CTEST_COUNTER_CYCLES: return "cycles";
+    case CTEST_COUNTER_CACHE_MISSES: return "cache-misses";
+    case CTEST_COUNTER_BRANCH_MISSES: return "branch-misses";
+    case CTEST_COUNTER_PAGE_FAULTS: return "page-faults";
+    case CTEST_COUNTER_TASK_CLOCK: return "task-clock";
+    default: return "unknown";
+    }
+}
+
+#ifdef __CTEST_PERF
+static int ctest_open_perf_event(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = type;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    // Values are scaled by these if the kernel has to multiplex the counters
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Only count the benchmark itself, which is also what unprivileged users are allowed to
+    attr.exclude_kernel = (type == PERF_TYPE_HARDWARE);
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static void ctest_open_counters(CTest_CounterSet* set) {
+    for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) set->fds[i] = -1;
+#ifdef __CTEST_PERF
+    // In containers and virtual machines the hardware events are often unavailable, but the software ones still work
+    set->fds[CTEST_COUNTER_INSTRUCTIONS] = ctest_open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    set->fds[CTEST_COUNTER_CYCLES] = ctest_open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    set->fds[CTEST_COUNTER_CACHE_MISSES] = ctest_open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    set->fds[CTEST_COUNTER_BRANCH_MISSES] = ctest_open_perf_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    set->fds[CTEST_COUNTER_PAGE_FAULTS] = ctest_open_perf_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+    set->fds[CTEST_COUNTER_TASK_CLOCK] = ctest_open_perf_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+#endif
+    for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) set->available[i] = set->fds[i] >= 0;
+    // Without perf, the software counters come from the C library and the operating system
+    set->available[CTEST_COUNTER_TASK_CLOCK] = true;
+#ifdef __CTEST_POSIX
+    set->available[CTEST_COUNTER_PAGE_FAULTS] = true;
+#endif
+}
+
+static void ctest_close_counters(CTest_CounterSet* set) {
+#ifdef __CTEST_PERF
+    for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) {
+        if (set->fds[i] >= 0) close(set->fds[i]);
+    }
+#else
+    (void)set;
+#endif
+}
+
+// Reads the current value of each available counter
+static void ctest_read_counters(CTest_CounterSet const* set, double* values) {
+#ifndef __CTEST_PERF
+    (void)set;
+#endif
+    for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) {
+        values[i] = 0;
+#ifdef __CTEST_PERF
+        if (set->fds[i] >= 0) {
+            // The value, the time enabled and the time running
+            uint64_t data[3];
+            if (read(set->fds[i], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2] > 0) {
+                values[i] = (double)data[0] * ((double)data[1] / (double)data[2]);
+            }
+            continue;
+        }
+#endif
+        if (i == CTEST_COUNTER_TASK_CLOCK) {
+            values[i] = (double)clock() / (double)CLOCKS_PER_SEC * 1e9;
+        }
+#ifdef __CTEST_POSIX
+        else if (i == CTEST_COUNTER_PAGE_FAULTS) {
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0) values[i] = (double)usage.ru_minflt + (double)usage.ru_majflt;
+        }
+#endif
+    }
+}
+
+void ctest_bench_reset_timer(CTest_BenchState* state) {
+    if (state->counter_set != NULL) ctest_read_counters(state->counter_set, state->counter_start);
+    state->start_time = state->cpu_time ? ctest_cpu_now() : ctest_now();
+}
+
+// Runs one sample of the benchmark and returns its duration in seconds, adding up the counters of the sample if given
+static double ctest_run_bench_sample(CTest_Bench const* bench, CTest_BenchState* state, size_t iterations, double* counterTotals) {
+    state->iterations = iterations;
+    ctest_bench_reset_timer(state);
+    bench->bench_fn(state);
+    double elapsed = (state->cpu_time ? ctest_cpu_now() : ctest_now()) - state->start_time;
+    if (counterTotals != NULL && state->counter_set != NULL) {
+        double counterEnd[CTEST_COUNTER_COUNT];
+        ctest_read_counters(state->counter_set, counterEnd);
+        for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) counterTotals[i] += counterEnd[i] - state->counter_start[i];
+    }
+    return elapsed;
+}
+
+// We whip up our own square root to avoid depending on math.h, which might need extra linker flags on some platforms
+static double ctest_sqrt(double x) {
+    if (x <= 0) return 0;
+    double guess = (x > 1) ? x : 1;
+    for (int i = 0; i < 100; ++i) {
+        double next = (guess + x / guess) / 2;
+        if (next >= guess) break;
+        guess = next;
+    }
+    return guess;
+}
+
+static int ctest_compare_doubles(void const* a, void const* b) {
+    double x = *(double const*)a;
+    double y = *(double const*)b;
+    return (x > y) - (x < y);
+}
+
+// Runs a benchmark with the given input size in its state
+static CTest_BenchResult ctest_run_bench_with_size(CTest_Bench const* bench, CTest_BenchOptions options, size_t size) {
+    if (options.min_sample_time <= 0) options.min_sample_time = 0.01;
+    if (options.samples == 0) options.samples = 20;
+    if (options.warmup_samples == 0) options.warmup_samples = 2;
+
+    CTest_BenchState state = { 0 };
+    state.size = size;
+    state.cpu_time = options.cpu_time;
+    CTest_CounterSet counterSet;
+    double counterTotals[CTEST_COUNTER_COUNT] = { 0 };
+    if (options.counters) {
+        ctest_open_counters(&counterSet);
+        state.counter_set = &counterSet;
+    }
+
+    // Calibrate the iterations, so a sample takes at least the minimum time, which also warms up caches
+    size_t iterations = 1;
+    while (true) {
+        double elapsed = ctest_run_bench_sample(bench, &state, iterations, NULL);
+        if (elapsed >= options.min_sample_time) break;
+        // Overshoot the prediction a bit, but don't trust very short measurements too much
+        double predicted = (elapsed > 0) ? (double)iterations * options.min_sample_time * 1.2 / elapsed : (double)iterations * 100.0;
+        double limit = (double)iterations * 100.0;
+        if (predicted > limit) predicted = limit;
+        if (predicted >= (double)(SIZE_MAX / 2)) break;
+        size_t next = (size_t)predicted;
+        iterations = (next > iterations) ? next : iterations + 1;
+    }
+
+    for (size_t i = 0; i < options.warmup_samples; ++i) ctest_run_bench_sample(bench, &state, iterations, NULL);
+
+    double* times = (double*)CTEST_REALLOC(NULL, options.samples * sizeof(double));
+    CTEST_INTERNAL_ASSERT(times != NULL, "failed to allocate memory for benchmark samples");
+    double sum = 0;
+    for (size_t i = 0; i < options.samples; ++i) {
+        times[i] = ctest_run_bench_sample(bench, &state, iterations, counterTotals) / (double)iterations;
+        sum += times[i];
+    }
+    qsort(times, options.samples, sizeof(double), ctest_compare_doubles);
+
+    CTest_BenchResult result = {
+        .bench = bench,
+        .iterations = iterations,
+        .samples = options.samples,
+        .mean = sum / (double)options.samples,
+        .min = times[0],
+        .max = times[options.samples - 1],
+    };
+    size_t middle = options.samples / 2;
+    result.median = (options.samples % 2 == 1) ? times[middle] : (times[middle - 1] + times[middle]) / 2;
+    // Nearest-rank percentile
+    size_t p99Rank = (options.samples * 99 + 99) / 100;
+    result.p99 = times[p99Rank - 1];
+    double squares = 0;
+    for (size_t i = 0; i < options.samples; ++i) squares += (times[i] - result.mean) * (times[i] - result.mean);
+    result.stddev = (options.samples > 1) ? ctest_sqrt(squares / (double)(options.samples - 1)) : 0;
+    if (result.mean > 0) {
+        result.ops_per_second = 1.0 / result.mean;
+        result.bytes_per_second = (double)state.bytes_per_iteration / result.mean;
+    }
+    // The samples are kept for comparisons against baselines
+    result.sample_times = times;
+    if (options.counters) {
+        double totalIterations = (double)iterations * (double)options.samples;
+        for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) {
+            result.counter_available[i] = counterSet.available[i];
+            if (counterSet.available[i]) result.counters[i] = counterTotals[i] / totalIterations;
+        }
+        ctest_close_counters(&counterSet);
+    }
+    return result;
+}
+
+CTest_BenchResult ctest_run_bench(CTest_Bench const* bench, CTest_BenchOptions options) {
+    return ctest_run_bench_with_size(bench, options, 0);
+}
+
+CTest_BenchReport ctest_run_bench_suite(CTest_BenchSuite suite, CTest_BenchFilter filter, CTest_BenchOptions options) {
+    CTest_BenchReport report = {
+        .results = NULL,
+        .length = 0,
+        .capacity = 0,
+    };
+    if (options.reporter.begin_fn != NULL) {
+        size_t benchCount = 0;
+        for (size_t i = 0; i < suite.length; ++i) {
+            if (filter.filter_fn == NULL || filter.filter_fn(&suite.benches[i], filter.user)) ++benchCount;
+        }
+        options.reporter.begin_fn(benchCount, options.reporter.user);
+    }
+    for (size_t i = 0; i < suite.length; ++i) {
+        CTest_Bench const* bench = &suite.benches[i];
+
+        // Use filter function, if specified
+        if (filter.filter_fn != NULL && !filter.filter_fn(bench, filter.user)) continue;
+
+        CTest_BenchResult result = ctest_run_bench(bench, options);
+        if (options.reporter.bench_result_fn != NULL) options.reporter.bench_result_fn(&result, options.reporter.user);
+
+        if (report.length + 1 > report.capacity) {
+            size_t newCapacity = (report.capacity == 0) ? 8 : (report.capacity * 2);
+            CTest_BenchResult* newResults = (CTest_BenchResult*)CTEST_REALLOC(report.results, newCapacity * sizeof(CTest_BenchResult));
+            CTEST_INTERNAL_ASSERT(newResults != NULL, "failed to allocate memory for benchmark report");
+            report.results = newResults;
+            report.capacity = newCapacity;
+        }
+        report.results[report.length++] = result;
+    }
+    if (options.reporter.end_fn != NULL) options.reporter.end_fn(options.reporter.user);
+    return report;
+}
+
+void ctest_free_bench_suite(CTest_BenchSuite* suite) {
+    CTEST_FREE(suite->benches);
+    suite->benches = NULL;
+    suite->length = 0;
+    suite->capacity = 0;
+}
+
+void ctest_free_bench_result(CTest_BenchResult* result) {
+    CTEST_FREE(result->sample_times);
+    result->sample_times = NULL;
+}
+
+void ctest_free_bench_report(CTest_BenchReport* report) {
+    for (size_t i = 0; i < report->length; ++i) ctest_free_bench_result(&report->results[i]);
+    CTEST_FREE(report->results);
+    report->results = NULL;
+    report->length = 0;
+    report->capacity = 0;
+}
+
+// Baselines ///////////////////////////////////////////////////////////////////
+
+bool ctest_write_bench_baseline(CTest_BenchReport report, char const* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return false;
+    fprintf(file, "name,iterations,mean,median,p99,stddev,min,max,ops_per_second,bytes_per_second,samples\n");
+    for (size_t i = 0; i < report.length; ++i) {
+        CTest_BenchResult const* result = &report.results[i];
+        fprintf(file, "%s,%zu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,", result->bench->name, result->iterations,
+            result->mean, result->median, result->p99, result->stddev, result->min, result->max, result->ops_per_second, result->bytes_per_second);
+        // The samples are the last column, separated by spaces
+        for (size_t j = 0; j < result->samples; ++j) fprintf(file, (j == 0) ? "%.17g" : " %.17g", result->sample_times[j]);
+        fprintf(file, "\n");
+    }
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    return ok;
+}
+
+// Reads a line of any length into the buffer, without the newline, returns false at the end of the file
+static bool ctest_read_line(FILE* file, char** buffer, size_t* capacity) {
+    size_t length = 0;
+    int c;
+    while ((c = fgetc(file)) != EOF && c != '\n') {
+        if (length + 2 > *capacity) {
+            size_t newCapacity = (*capacity == 0) ? 256 : (*capacity * 2);
+            char* newBuffer = (char*)CTEST_REALLOC(*buffer, newCapacity);
+            CTEST_INTERNAL_ASSERT(newBuffer != NULL, "failed to allocate memory for baseline line");
+            *buffer = newBuffer;
+            *capacity = newCapacity;
+        }
+        (*buffer)[length++] = (char)c;
+    }
+    if (c == EOF && length == 0) return false;
+    if (length > 0 && (*buffer)[length - 1] == '\r') --length;
+    if (*capacity == 0) {
+        *buffer = (char*)CTEST_REALLOC(NULL, 1);
+        CTEST_INTERNAL_ASSERT(*buffer != NULL, "failed to allocate memory for baseline line");
+        *capacity = 1;
+    }
+    (*buffer)[length] = '\0';
+    return true;
+}
+
+// Parses a baseline line into an entry, only the name and samples are needed for comparisons
+static bool ctest_parse_baseline_line(char* line, CTest_BenchBaselineEntry* entry) {
+    *entry = (CTest_BenchBaselineEntry){ 0 };
+    char* nameEnd = strchr(line, ',');
+    // The samples follow the last comma
+    char* samples = strrchr(line, ',');
+    if (nameEnd == NULL || nameEnd == line) return false;
+    ++samples;
+
+    size_t nameLength = (size_t)(nameEnd - line);
+    entry->name = (char*)CTEST_REALLOC(NULL, nameLength + 1);
+    CTEST_INTERNAL_ASSERT(entry->name != NULL, "failed to allocate memory for baseline entry");
+    memcpy(entry->name, line, nameLength);
+    entry->name[nameLength] = '\0';
+
+    size_t capacity = 0;
+    char* cursor = samples;
+    while (true) {
+        char* end;
+        double time = strtod(cursor, &end);
+        if (end == cursor) break;
+        if (entry->samples + 1 > capacity) {
+            capacity = (capacity == 0) ? 32 : (capacity * 2);
+            double* newTimes = (double*)CTEST_REALLOC(entry->sample_times, capacity * sizeof(double));
+            CTEST_INTERNAL_ASSERT(newTimes != NULL, "failed to allocate memory for baseline samples");
+            entry->sample_times = newTimes;
+        }
+        entry->sample_times[entry->samples++] = time;
+        cursor = end;
+    }
+    return entry->samples > 0;
+}
+
+bool ctest_read_bench_baseline(char const* path, CTest_BenchBaseline* baseline) {
+    *baseline = (CTest_BenchBaseline){ 0 };
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return false;
+
+    char* line = NULL;
+    size_t lineCapacity = 0;
+    bool ok = true;
+    // Skip the header
+    bool isHeader = true;
+    while (ctest_read_line(file, &line, &lineCapacity)) {
+        if (isHeader || line[0] == '\0') {
+            isHeader = false;
+            continue;
+        }
+        CTest_BenchBaselineEntry entry = { 0 };
+        bool parsed = ctest_parse_baseline_line(line, &entry);
+        if (!parsed) {
+            CTEST_FREE(entry.name);
+            CTEST_FREE(entry.sample_times);
+            ok = false;
+            break;
+        }
+        if (baseline->length + 1 > baseline->capacity) {
+            size_t newCapacity = (baseline->capacity == 0) ? 8 : (baseline->capacity * 2);
+            CTest_BenchBaselineEntry* newEntries = (CTest_BenchBaselineEntry*)CTEST_REALLOC(baseline->entries, newCapacity * sizeof(CTest_BenchBaselineEntry));
+            CTEST_INTERNAL_ASSERT(newEntries != NULL, "failed to allocate memory for baseline");
+            baseline->entries = newEntries;
+            baseline->capacity = newCapacity;
+        }
+        baseline->entries[baseline->length++] = entry;
+    }
+    if (ferror(file)) ok = false;
+    CTEST_FREE(line);
+    fclose(file);
+    return ok;
+}
+
+CTest_BenchBaselineEntry const* ctest_find_bench_baseline_entry(CTest_BenchBaseline baseline, char const* name) {
+    for (size_t i = 0; i < baseline.length; ++i) {
+        if (strcmp(baseline.entries[i].name, name) == 0) return &baseline.entries[i];
+    }
+    return NULL;
+}
+
+// e^x without math.h, by halving x until the series converges fast, then squaring back
+static double ctest_exp(double x) {
+    int halvings = 0;
+    while (x > 0.5 || x < -0.5) {
+        x /= 2;
+        ++halvings;
+    }
+    double term = 1, sum = 1;
+    for (int i = 1; i < 20; ++i) {
+        term *= x / i;
+        sum += term;
+    }
+    for (int i = 0; i < halvings; ++i) sum *= sum;
+    return sum;
+}
+
+// The complementary error function for x >= 0, with the approximation 7.1.26 of Abramowitz and Stegun (error below 1.5e-7)
+static double ctest_erfc(double x) {
+    double t = 1.0 / (1.0 + 0.3275911 * x);
+    double poly = t * (0.254829592 + t * (-0.284496736 + t * (1.421413741 + t * (-1.453152027 + t * 1.061405429))));
+    return poly * ctest_exp(-x * x);
+}
+
+// A time tagged with the run it belongs to, for ranking both runs together
+typedef struct CTest_RankedTime {
+    double time;
+    bool is_current;
+} CTest_RankedTime;
+
+static int ctest_compare_ranked_times(void const* a, void const* b) {
+    return ctest_compare_doubles(&((CTest_RankedTime const*)a)->time, &((CTest_RankedTime const*)b)->time);
+}
+
+static double ctest_median_of(double const* times, size_t count) {
+    double* sorted = (double*)CTEST_REALLOC(NULL, count * sizeof(double));
+    CTEST_INTERNAL_ASSERT(sorted != NULL, "failed to allocate memory for median");
+    memcpy(sorted, times, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), ctest_compare_doubles);
+    double median = (count % 2 == 1) ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2;
+    CTEST_FREE(sorted);
+    return median;
+}
+
+CTest_BenchComparison ctest_compare_bench(double const* baselineTimes, size_t baselineCount, double const* currentTimes, size_t currentCount, CTest_BenchCompareOptions options) {
+    if (options.threshold <= 0) options.threshold = 0.05;
+    if (options.alpha <= 0) options.alpha = 0.05;
+
+    CTest_BenchComparison comparison = { .p_value = 1 };
+    if (baselineCount == 0 || currentCount == 0) return comparison;
+    comparison.baseline_median = ctest_median_of(baselineTimes, baselineCount);
+    comparison.current_median = ctest_median_of(currentTimes, currentCount);
+    if (comparison.baseline_median > 0) comparison.change = comparison.current_median / comparison.baseline_median - 1;
+
+    // Rank all samples together, ties get the average of their ranks
+    size_t total = baselineCount + currentCount;
+    CTest_RankedTime* ranked = (CTest_RankedTime*)CTEST_REALLOC(NULL, total * sizeof(CTest_RankedTime));
+    CTEST_INTERNAL_ASSERT(ranked != NULL, "failed to allocate memory for ranks");
+    for (size_t i = 0; i < baselineCount; ++i) ranked[i] = (CTest_RankedTime){ .time = baselineTimes[i], .is_current = false };
+    for (size_t i = 0; i < currentCount; ++i) ranked[baselineCount + i] = (CTest_RankedTime){ .time = currentTimes[i], .is_current = true };
+    qsort(ranked, total, sizeof(CTest_RankedTime), ctest_compare_ranked_times);
+    double currentRankSum = 0;
+    double tieCorrection = 0;
+    for (size_t i = 0; i < total;) {
+        size_t j = i;
+        while (j < total && ranked[j].time == ranked[i].time) ++j;
+        double averageRank = (double)(i + 1 + j) / 2;
+        for (size_t k = i; k < j; ++k) {
+            if (ranked[k].is_current) currentRankSum += averageRank;
+        }
+        double ties = (double)(j - i);
+        tieCorrection += ties * ties * ties - ties;
+        i = j;
+    }
+    CTEST_FREE(ranked);
+
+    // Normal approximation of the U statistic, with continuity correction
+    double n1 = (double)currentCount;
+    double n2 = (double)baselineCount;
+    double n = n1 + n2;
+    double u = currentRankSum - n1 * (n1 + 1) / 2;
+    double mean = n1 * n2 / 2;
+    double variance = n1 * n2 / 12 * ((n + 1) - tieCorrection / (n * (n - 1)));
+    if (variance > 0) {
+        double distance = u - mean;
+        distance = (distance > 0) ? distance - 0.5 : -distance - 0.5;
+        if (distance < 0) distance = 0;
+        double z = distance / ctest_sqrt(variance);
+        comparison.p_value = ctest_erfc(z / 1.4142135623730951);
+    }
+
+    bool significant = comparison.p_value < options.alpha;
+    comparison.regressed = significant && comparison.change > options.threshold;
+    comparison.improved = significant && comparison.change < -options.threshold;
+    return comparison;
+}
+
+size_t ctest_print_bench_comparison(CTest_BenchReport report, CTest_BenchBaseline baseline, CTest_BenchCompareOptions options) {
+    if (options.threshold <= 0) options.threshold = 0.05;
+    size_t regressions = 0;
+    printf("Benchmark comparison against baseline (threshold %.1f%%):\n", options.threshold * 100.0);
+    for (size_t i = 0; i < report.length; ++i) {
+        CTest_BenchResult const* result = &report.results[i];
+        CTest_BenchBaselineEntry const* entry = ctest_find_bench_baseline_entry(baseline, result->bench->name);
+        if (entry == NULL) {
+            printf("  - %s: not in the baseline\n", result->bench->name);
+            continue;
+        }
+        CTest_BenchComparison comparison = ctest_compare_bench(entry->sample_times, entry->samples, result->sample_times, result->samples, options);
+        char baselineMedian[32], currentMedian[32];
+        ctest_format_time(baselineMedian, sizeof(baselineMedian), comparison.baseline_median);
+        ctest_format_time(currentMedian, sizeof(currentMedian), comparison.current_median);
+        char const* verdict = comparison.regressed ? " REGRESSION" : (comparison.improved ? " improvement" : "");
+        printf("  - %s: %s -> %s (%+.1f%%, p = %.3g)%s\n", result->bench->name, baselineMedian, currentMedian, comparison.change * 100.0, comparison.p_value, verdict);
+        if (comparison.regressed) ++regressions;
+    }
+    if (regressions > 0) printf(" Regressions (%zu)!\n", regressions);
+    return regressions;
+}
+
+void ctest_free_bench_baseline(CTest_BenchBaseline* baseline) {
+    for (size_t i = 0; i < baseline->length; ++i) {
+        CTEST_FREE(baseline->entries[i].name);
+        CTEST_FREE(baseline->entries[i].sample_times);
+    }
+    CTEST_FREE(baseline->entries);
+    baseline->entries = NULL;
+    baseline->length = 0;
+    baseline->capacity = 0;
+}
+
+// Formats a rate with a decimal suffix
+static void ctest_format_rate(char* buffer, size_t size, double rate, char const* unit) {
+    if (rate >= 1e9) snprintf(buffer, size, "%.2f G%s/s", rate / 1e9, unit);
+    else if (rate >= 1e6) snprintf(buffer, size, "%.2f M%s/s", rate / 1e6, unit);
+    else if (rate >= 1e3) snprintf(buffer, size, "%.2f K%s/s", rate / 1e3, unit);
+    else snprintf(buffer, size, "%.2f %s/s", rate, unit);
+}
+
+void ctest_print_bench_report(CTest_BenchReport report) {
+    printf("Benchmark report (%zu):\n", report.length);
+    for (size_t i = 0; i < report.length; ++i) {
+        CTest_BenchResult result = report.results[i];
+        char mean[32], median[32], p99[32], stddev[32], ops[32], bytes[32];
+        ctest_format_time(mean, sizeof(mean), result.mean);
+        ctest_format_time(median, sizeof(median), result.median);
+        ctest_format_time(p99, sizeof(p99), result.p99);
+        ctest_format_time(stddev, sizeof(stddev), result.stddev);
+        ctest_format_rate(ops, sizeof(ops), result.ops_per_second, "ops");
+        printf("  - %s: %s/iter (median %s, p99 %s, stddev %s), %s", result.bench->name, mean, median, p99, stddev, ops);
+        if (result.bytes_per_second > 0) {
+            ctest_format_rate(bytes, sizeof(bytes), result.bytes_per_second, "B");
+            printf(", %s", bytes);
+        }
+        printf(" [%zu samples x %zu iterations]\n", result.samples, result.iterations);
+
+        bool anyCounter = false;
+        for (size_t j = 0; j < CTEST_COUNTER_COUNT; ++j) {
+            if (!result.counter_available[j]) continue;
+            printf(anyCounter ? ", %.2f %s" : "    per iteration: %.2f %s", result.counters[j], ctest_counter_name((CTest_Counter)j));
+            anyCounter = true;
+        }
+        if (result.counter_available[CTEST_COUNTER_INSTRUCTIONS] && result.counter_available[CTEST_COUNTER_CYCLES] && result.counters[CTEST_COUNTER_CYCLES] > 0) {
+            printf(" (%.2f instructions per cycle)", result.counters[CTEST_COUNTER_INSTRUCTIONS] / result.counters[CTEST_COUNTER_CYCLES]);
+        }
+        if (anyCounter) printf("\n");
+    }
+}
+
+// Complexity //////////////////////////////////////////////////////////////////
+
+// The natural logarithm without math.h, by scaling x into [1, 2) and summing the series of 2 * atanh((x - 1) / (x + 1))
+static double ctest_log(double x) {
+    if (x <= 0) return 0;
+    double const ln2 = 0.69314718055994530942;
+    double result = 0;
+    while (x >= 2) {
+        x /= 2;
+        result += ln2;
+    }
+    while (x < 1) {
+        x *= 2;
+        result -= ln2;
+    }
+    double y = (x - 1) / (x + 1);
+    double term = y, sum = 0;
+    for (int i = 1; i < 40; i += 2) {
+        sum += term / i;
+        term *= y * y;
+    }
+    return result + 2 * sum;
+}
+
+// The growth function of a complexity class
+static double ctest_complexity_term(CTest_Complexity complexity, double n) {
+    switch (complexity) {
+    case CTEST_COMPLEXITY_CONSTANT: return 1;
+    case CTEST_COMPLEXITY_LOG_N: return ctest_log(n);
+    case CTEST_COMPLEXITY_N: return n;
+    case CTEST_COMPLEXITY_N_LOG_N: return n * ctest_log(n);
+    case CTEST_COMPLEXITY_N_SQUARED: return n * n;
+    default: return 0;
+    }
+}
+
+char const* ctest_complexity_name(CTest_Complexity complexity) {
+    switch (complexity) {
+    case CTEST_COMPLEXITY_CONSTANT: return "O(1)";
+    case CTEST_COMPLEXITY_LOG_N: return "O(log n)";
+    case CTEST_COMPLEXITY_N: return "O(n)";
+    case CTEST_COMPLEXITY_N_LOG_N: return "O(n log n)";
+    case CTEST_COMPLEXITY_N_SQUARED: return "O(n^2)";
+    default: return "unknown";
+    }
+}
+
+CTest_ComplexityFit ctest_fit_complexity(size_t const* sizes, double const* times, size_t count) {
+    CTest_ComplexityFit fit = { .complexity = CTEST_COMPLEXITY_CONSTANT };
+    if (count > CTEST_COMPLEXITY_MAX_SIZES) count = CTEST_COMPLEXITY_MAX_SIZES;
+    fit.count = count;
+    if (count == 0) return fit;
+
+    double meanTime = 0;
+    for (size_t i = 0; i < count; ++i) {
+        fit.sizes[i] = sizes[i];
+        fit.times[i] = times[i];
+        meanTime += times[i];
+    }
+    meanTime /= (double)count;
+
+    for (size_t c = 0; c < CTEST_COMPLEXITY_COUNT; ++c) {
+        // Least squares through the origin, the coefficient minimizes the sum of (t - coefficient * f(n))^2
+        double timesTerms = 0, termsSquared = 0;
+        for (size_t i = 0; i < count; ++i) {
+            double term = ctest_complexity_term((CTest_Complexity)c, (double)sizes[i]);
+            timesTerms += times[i] * term;
+            termsSquared += term * term;
+        }
+        double coefficient = (termsSquared > 0) ? timesTerms / termsSquared : 0;
+        double squaredError = 0;
+        for (size_t i = 0; i < count; ++i) {
+            double error = times[i] - coefficient * ctest_complexity_term((CTest_Complexity)c, (double)sizes[i]);
+            squaredError += error * error;
+        }
+        fit.coefficients[c] = coefficient;
+        // Relative to the mean, so the error is comparable between benchmarks
+        fit.rms[c] = (meanTime > 0) ? ctest_sqrt(squaredError / (double)count) / meanTime : 0;
+        // On a tie, the slower growing class wins
+        if (fit.rms[c] < fit.rms[fit.complexity]) fit.complexity = (CTest_Complexity)c;
+    }
+    return fit;
+}
+
+CTest_ComplexityFit ctest_measure_complexity(CTest_Bench const* bench, CTest_ComplexityOptions options) {
+    if (options.min_size < 2) options.min_size = (options.min_size == 0) ? 64 : 2;
+    if (options.max_size == 0) options.max_size = 4096;
+    if (options.max_size < options.min_size) options.max_size = options.min_size;
+    if (options.steps == 0) options.steps = 7;
+    if (options.steps > CTEST_COMPLEXITY_MAX_SIZES) options.steps = CTEST_COMPLEXITY_MAX_SIZES;
+    if (options.bench.min_sample_time <= 0) options.bench.min_sample_time = 0.002;
+    if (options.bench.samples == 0) options.bench.samples = 5;
+    if (options.bench.warmup_samples == 0) options.bench.warmup_samples = 1;
+    // The counters are meant for the benchmark suite, not the individual sizes
+    options.bench.counters = false;
+    // Complexity assertions run in test suites, often next to other processes, which must not bend the curve
+    options.bench.cpu_time = true;
+
+    size_t sizes[CTEST_COMPLEXITY_MAX_SIZES];
+    double times[CTEST_COMPLEXITY_MAX_SIZES];
+    size_t count = 0;
+    // The sizes grow geometrically, so every doubling weighs the same
+    double ratio = (options.steps > 1) ? (double)options.max_size / (double)options.min_size : 1;
+    for (size_t i = 0; i < options.steps; ++i) {
+        double exponent = (options.steps > 1) ? (double)i / (double)(options.steps - 1) : 0;
+        size_t size = (size_t)((double)options.min_size * ctest_exp(exponent * ctest_log(ratio)) + 0.5);
+        if (count > 0 && size <= sizes[count - 1]) continue;
+        CTest_BenchResult result = ctest_run_bench_with_size(bench, options.bench, size);
+        sizes[count] = size;
+        // Interruptions only ever add time, so the fastest sample is the least noisy estimate of the work done
+        times[count] = result.min;
+        ++count;
+        ctest_free_bench_result(&result);
+    }
+    return ctest_fit_complexity(sizes, times, count);
+}
+
+bool ctest_complexity_at_most(CTest_ComplexityFit fit, CTest_Complexity bound) {
+    if (fit.complexity <= bound) return true;
+    // O(n) and O(n log n) are only about 0.09 apart over a 64-fold range of sizes, while O(n^2) is further than 0.3 from both
+    return fit.rms[bound] <= fit.rms[fit.complexity] + 0.05;
+}
+
+bool ctest_measure_complexity_at_most(CTest_Bench const* bench, CTest_ComplexityOptions options, CTest_Complexity bound, CTest_ComplexityFit* fit) {
+    if (options.attempts == 0) options.attempts = 3;
+    // Each attempt is fitted on its own, mixing the times of attempts would pile up the outliers of processor time accounting on a busy machine
+    CTest_ComplexityFit measured = ctest_measure_complexity(bench, options);
+    for (size_t attempt = 1; attempt < options.attempts && !ctest_complexity_at_most(measured, bound); ++attempt) {
+        measured = ctest_measure_complexity(bench, options);
+    }
+    if (fit != NULL) *fit = measured;
+    return ctest_complexity_at_most(measured, bound);
+}
+
+void ctest_print_complexity_fit(char const* name, CTest_ComplexityFit fit) {
+    printf("Complexity of %s: %s\n", name, ctest_complexity_name(fit.complexity));
+    for (size_t i = 0; i < fit.count; ++i) {
+        char time[32];
+        ctest_format_time(time, sizeof(time), fit.times[i]);
+        printf("  - n = %zu: %s/iter\n", fit.sizes[i], time);
+    }
+    for (size_t c = 0; c < CTEST_COMPLEXITY_COUNT; ++c) {
+        printf("  %s %s: rms %.3f\n", (c == (size_t)fit.complexity) ? "*" : " ", ctest_complexity_name((CTest_Complexity)c), fit.rms[c]);
+    }
+}
+
+// Fuzzing /////////////////////////////////////////////////////////////////////
+
+void ctest_register_fuzz_target(CTest_FuzzSuite* suite, CTest_FuzzTarget target) {
+    if (suite->length + 1 > suite->capacity) {
+        size_t newCapacity = (suite->capacity == 0) ? 8 : (suite->capacity * 2);
+        CTest_FuzzTarget* newTargets = (CTest_FuzzTarget*)CTEST_REALLOC(suite->targets, newCapacity * sizeof(CTest_FuzzTarget));
+        CTEST_INTERNAL_ASSERT(newTargets != NULL, "failed to allocate memory for fuzz suite");
+        suite->targets = newTargets;
+        suite->capacity = newCapacity;
+    }
+    suite->targets[suite->length++] = target;
+}
+
+CTest_FuzzSuite ctest_get_fuzz_suite(void) {
+    return __ctest_default_fuzz_suite;
+}
+
+void ctest_free_fuzz_suite(CTest_FuzzSuite* suite) {
+    CTEST_FREE(suite->targets);
+    suite->targets = NULL;
+    suite->length = 0;
+    suite->capacity = 0;
+}
+
+// The number of coverage counters, the edges or blocks of the program are hashed into them
+#define __CTEST_COVERAGE_SIZE (1 << 16)
+
+// The hit counts of the input that is running, filled by the coverage callbacks
+static uint8_t ctest_coverage_counters[__CTEST_COVERAGE_SIZE];
+// The hit count buckets seen so far for each counter, one bit per bucket
+static uint8_t ctest_coverage_seen[__CTEST_COVERAGE_SIZE];
+// True while the fuzz target runs, so the fuzzer itself does not add to the coverage
+static bool ctest_coverage_tracing;
+// True, once a coverage callback was called
+static bool ctest_coverage_available;
+
+#if defined(CTEST_FUZZ_COVERAGE) && (defined(__GNUC__) || defined(__clang__))
+
+// The callbacks must not be instrumented themselves, or they would call themselves
+#if defined(__clang__)
+    #define __CTEST_NO_COVERAGE __attribute__((no_sanitize("coverage")))
+#elif __GNUC__ >= 12
+    #define __CTEST_NO_COVERAGE __attribute__((no_sanitize_coverage))
+#else
+    #define __CTEST_NO_COVERAGE
+#endif
+
+__CTEST_NO_COVERAGE static void ctest_hit_coverage(size_t index) {
+    if (!ctest_coverage_tracing) return;
+    ctest_coverage_available = true;
+    uint8_t* counter = &ctest_coverage_counters[index % __CTEST_COVERAGE_SIZE];
+    if (*counter != 255) ++*counter;
+}
+
+// Called by -fsanitize-coverage=trace-pc-guard once per module, numbers its edges
+__CTEST_NO_COVERAGE void __sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* stop);
+__CTEST_NO_COVERAGE void __sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* stop) {
+    static uint32_t guardCount = 0;
+    if (start == stop || *start != 0) return;
+    for (uint32_t* guard = start; guard < stop; ++guard) *guard = ++guardCount;
+}
+
+// Called by -fsanitize-coverage=trace-pc-guard on every edge
+__CTEST_NO_COVERAGE void __sanitizer_cov_trace_pc_guard(uint32_t* guard);
+__CTEST_NO_COVERAGE void __sanitizer_cov_trace_pc_guard(uint32_t* guard) {
+    ctest_hit_coverage(*guard);
+}
+
+// Called by -fsanitize-coverage=trace-pc on every basic block, which is told apart by the return address
+__CTEST_NO_COVERAGE void __sanitizer_cov_trace_pc(void);
+__CTEST_NO_COVERAGE void __sanitizer_cov_trace_pc(void) {
+    uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+    ctest_hit_coverage((size_t)(pc ^ (pc >> 16)));
+}
+
+#endif /* CTEST_FUZZ_COVERAGE */
+
+// Buckets hit counts like AFL, so an input is only interesting for reaching a block, or for looping over it notably more often
+static uint8_t ctest_coverage_bucket(uint8_t count) {
+    if (count <= 2) return count;
+    if (count == 3) return 4;
+    if (count <= 7) return 8;
+    if (count <= 15) return 16;
+    if (count <= 31) return 32;
+    if (count <= 127) return 64;
+    return 128;
+}
+
+// Merges the hit counts of the last input into the seen buckets and clears them, returning the number of new features
+static size_t ctest_collect_coverage(void) {
+    size_t newFeatures = 0;
+    for (size_t i = 0; i < __CTEST_COVERAGE_SIZE; i += sizeof(uint64_t)) {
+        // Most counters are zero, so they are skipped a word at a time
+        uint64_t word;
+        memcpy(&word, &ctest_coverage_counters[i], sizeof(word));
+        if (word == 0) continue;
+        for (size_t j = i; j < i + sizeof(uint64_t); ++j) {
+            if (ctest_coverage_counters[j] == 0) continue;
+            uint8_t bucket = ctest_coverage_bucket(ctest_coverage_counters[j]);
+            ctest_coverage_counters[j] = 0;
+            if ((ctest_coverage_seen[j] & bucket) != 0) continue;
+            ctest_coverage_seen[j] |= bucket;
+            ++newFeatures;
+        }
+    }
+    return newFeatures;
+}
+
+static uint8_t* ctest_copy_fuzz_bytes(uint8_t const* data, size_t size) {
+    uint8_t* copy = (uint8_t*)CTEST_REALLOC(NULL, (size == 0) ? 1 : size);
+    CTEST_INTERNAL_ASSERT(copy != NULL, "failed to allocate memory for fuzz input");
+    if (size > 0) memcpy(copy, data, size);
+    return copy;
+}
+
+CTest_Execution ctest_run_fuzz_input(CTest_FuzzTarget const* target, uint8_t const* data, size_t size) {
+    CTest_Execution execution = {
+        .test_case = NULL,
+        .passed = true,
+    };
+    // Like libFuzzer, the input gets its own allocation of its exact size
+    uint8_t* input = ctest_copy_fuzz_bytes(data, size);
+    // Fuzzing can run inside a test case, whose assertions have to keep working afterwards
+    CTest_Execution* enclosingCtx = __ctest_ctx;
+    double startTime = ctest_now();
+    if (setjmp(execution.jmp_env) == 0) {
+        __ctest_ctx = &execution;
+        ctest_coverage_tracing = true;
+        target->fuzz_fn(input, size);
+    }
+    ctest_coverage_tracing = false;
+    execution.wall_time = ctest_now() - startTime;
+    __ctest_ctx = enclosingCtx;
+    CTEST_FREE(input);
+    return execution;
+}
+
+bool ctest_read_fuzz_input(char const* path, uint8_t** data, size_t* size) {
+    *data = NULL;
+    *size = 0;
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return false;
+    size_t capacity = 0;
+    while (true) {
+        if (*size == capacity) {
+            capacity = (capacity == 0) ? 256 : (capacity * 2);
+            uint8_t* newData = (uint8_t*)CTEST_REALLOC(*data, capacity);
+            CTEST_INTERNAL_ASSERT(newData != NULL, "failed to allocate memory for fuzz input");
+            *data = newData;
+        }
+        size_t readSize = fread(*data + *size, 1, capacity - *size, file);
+        if (readSize == 0) break;
+        *size += readSize;
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+// A stable hash of an input (64-bit FNV-1a) to name its file
+static uint64_t ctest_hash_bytes(uint8_t const* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= (uint64_t)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Writes an input to <dir>/<prefix><hash>, returning the allocated path, or NULL if the file could not be written
+static char* ctest_write_fuzz_file(char const* dir, char const* prefix, uint8_t const* data, size_t size) {
+    size_t pathSize = strlen(dir) + strlen(prefix) + 24;
+    char* path = (char*)CTEST_REALLOC(NULL, pathSize);
+    CTEST_INTERNAL_ASSERT(path != NULL, "failed to allocate memory for fuzz input path");
+    snprintf(path, pathSize, "%s/%s%016llx", dir, prefix, (unsigned long long)ctest_hash_bytes(data, size));
+    FILE* file = fopen(path, "wb");
+    bool ok = file != NULL && fwrite(data, 1, size, file) == size;
+    if (file != NULL && fclose(file) != 0) ok = false;
+    if (!ok) {
+        CTEST_FREE(path);
+        return NULL;
+    }
+    return path;
+}
+
+// An input in the corpus of a fuzzing run
+typedef struct CTest_FuzzInput {
+    uint8_t* data;
+    size_t size;
+} CTest_FuzzInput;
+
+typedef struct CTest_FuzzCorpus {
+    CTest_FuzzInput* inputs;
+    size_t length;
+    size_t capacity;
+} CTest_FuzzCorpus;
+
+static void ctest_add_fuzz_input(CTest_FuzzCorpus* corpus, uint8_t const* data, size_t size) {
+    if (corpus->length + 1 > corpus->capacity) {
+        size_t newCapacity = (corpus->capacity == 0) ? 64 : (corpus->capacity * 2);
+        CTest_FuzzInput* newInputs = (CTest_FuzzInput*)CTEST_REALLOC(corpus->inputs, newCapacity * sizeof(CTest_FuzzInput));
+        CTEST_INTERNAL_ASSERT(newInputs != NULL, "failed to allocate memory for fuzz corpus");
+        corpus->inputs = newInputs;
+        corpus->capacity = newCapacity;
+    }
+    corpus->inputs[corpus->length++] = (CTest_FuzzInput){ .data = ctest_copy_fuzz_bytes(data, size), .size = size };
+}
+
+static void ctest_free_fuzz_corpus(CTest_FuzzCorpus* corpus) {
+    for (size_t i = 0; i < corpus->length; ++i) CTEST_FREE(corpus->inputs[i].data);
+    CTEST_FREE(corpus->inputs);
+    corpus->inputs = NULL;
+    corpus->length = 0;
+    corpus->capacity = 0;
+}
+
+#ifdef __CTEST_POSIX
+// Adds every regular file of the directory to the corpus, truncated to the maximum size, in the order of their names for repeatable runs
+static void ctest_load_fuzz_corpus(char const* dir, CTest_FuzzCorpus* corpus, size_t maxSize) {
+    DIR* handle = opendir(dir);
+    if (handle == NULL) return;
+    CTest_FuzzCorpus loaded = { 0 };
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        size_t pathSize = strlen(dir) + strlen(entry->d_name) + 2;
+        char* path = (char*)CTEST_REALLOC(NULL, pathSize);
+        CTEST_INTERNAL_ASSERT(path != NULL, "failed to allocate memory for fuzz input path");
+        snprintf(path, pathSize, "%s/%s", dir, entry->d_name);
+        struct stat info;
+        uint8_t* data;
+        size_t size;
+        if (stat(path, &info) == 0 && S_ISREG(info.st_mode) && ctest_read_fuzz_input(path, &data, &size)) {
+            // The path is kept in front of the data for sorting, and dropped when the inputs are added
+            ctest_add_fuzz_input(&loaded, (uint8_t const*)path, strlen(path) + 1);
+            ctest_add_fuzz_input(&loaded, data, (size > maxSize) ? maxSize : size);
+            CTEST_FREE(data);
+        }
+        CTEST_FREE(path);
+    }
+    closedir(handle);
+    // Insertion sort of the (path, data) pairs, corpora are small enough
+    for (size_t i = 2; i < loaded.length; i += 2) {
+        for (size_t j = i; j >= 2 && strcmp((char const*)loaded.inputs[j - 2].data, (char const*)loaded.inputs[j].data) > 0; j -= 2) {
+            CTest_FuzzInput path = loaded.inputs[j];
+            CTest_FuzzInput data = loaded.inputs[j + 1];
+            loaded.inputs[j] = loaded.inputs[j - 2];
+            loaded.inputs[j + 1] = loaded.inputs[j - 1];
+            loaded.inputs[j - 2] = path;
+            loaded.inputs[j - 1] = data;
+        }
+    }
+    for (size_t i = 0; i < loaded.length; i += 2) ctest_add_fuzz_input(corpus, loaded.inputs[i + 1].data, loaded.inputs[i + 1].size);
+    ctest_free_fuzz_corpus(&loaded);
+}
+#endif
+
+// Inserts bytes into the input at the given position, as many as fit into the maximum size, the source must not overlap the input
+static void ctest_insert_fuzz_bytes(uint8_t* data, size_t* size, size_t maxSize, size_t position, uint8_t const* bytes, size_t count) {
+    if (count > maxSize - *size) count = maxSize - *size;
+    if (count == 0) return;
+    memmove(data + position + count, data + position, *size - position);
+    memcpy(data + position, bytes, count);
+    *size += count;
+}
+
+// Applies a few random mutations to the input, keeping it at most the maximum size
+static void ctest_mutate_fuzz_input(uint8_t* data, size_t* size, size_t maxSize, CTest_FuzzCorpus const* corpus, CTest_FuzzOptions const* options, uint64_t* random) {
+    static uint8_t const interestingBytes[] = { 0x00, 0x01, 0x10, 0x20, 0x40, 0x64, 0x7f, 0x80, 0xff };
+    uint8_t chunk[64];
+    size_t mutationCount = 1 + (size_t)(ctest_next_random(random) % 4);
+    for (size_t m = 0; m < mutationCount; ++m) {
+        uint64_t r = ctest_next_random(random);
+        size_t position = (*size == 0) ? 0 : (size_t)((r >> 8) % *size);
+        size_t insertPosition = (size_t)((r >> 8) % (*size + 1));
+        switch (r % 10) {
+        case 0:
+            // Flip a bit
+            if (*size > 0) data[position] ^= (uint8_t)(1u << ((r >> 40) % 8));
+            break;
+        case 1:
+            // Set a random byte
+            if (*size > 0) data[position] = (uint8_t)(r >> 40);
+            break;
+        case 2:
+            // Set a byte to a boundary value
+            if (*size > 0) data[position] = interestingBytes[(r >> 40) % sizeof(interestingBytes)];
+            break;
+        case 3:
+            // Add or subtract a small number
+            if (*size > 0) data[position] = (uint8_t)(data[position] + (uint8_t)((r >> 40) % 35) - 17);
+            break;
+        case 4: {
+            // Insert random bytes
+            size_t count = 1 + (size_t)((r >> 40) % 8);
+            for (size_t i = 0; i < count; ++i) chunk[i] = (uint8_t)(ctest_next_random(random));
+            ctest_insert_fuzz_bytes(data, size, maxSize, insertPosition, chunk, count);
+            break;
+        }
+        case 5: {
+            // Erase a range
+            if (*size == 0) break;
+            size_t count = 1 + (size_t)((r >> 40) % 16);
+            if (count > *size - position) count = *size - position;
+            memmove(data + position, data + position + count, *size - position - count);
+            *size -= count;
+            break;
+        }
+        case 6: {
+            // Copy a range of the input to another place
+            if (*size == 0) break;
+            size_t count = 1 + (size_t)((r >> 40) % sizeof(chunk));
+            if (count > *size - position) count = *size - position;
+            memcpy(chunk, data + position, count);
+            ctest_insert_fuzz_bytes(data, size, maxSize, (size_t)((r >> 20) % (*size + 1)), chunk, count);
+            break;
+        }
+        case 7: {
+            // Splice in a range of another input from the corpus
+            CTest_FuzzInput const* other = &corpus->inputs[(r >> 40) % corpus->length];
+            if (other->size == 0) break;
+            size_t start = (size_t)((r >> 20) % other->size);
+            size_t count = 1 + (size_t)(ctest_next_random(random) % sizeof(chunk));
+            if (count > other->size - start) count = other->size - start;
+            memcpy(chunk, other->data + start, count);
+            ctest_insert_fuzz_bytes(data, size, maxSize, insertPosition, chunk, count);
+            break;
+        }
+        case 8: {
+            // Repeat a byte of the input, long runs of the same byte reach limits and nesting depths
+            if (*size == 0) break;
+            size_t count = 1 + (size_t)((r >> 40) % sizeof(chunk));
+            memset(chunk, data[position], count);
+            ctest_insert_fuzz_bytes(data, size, maxSize, position, chunk, count);
+            break;
+        }
+        case 9: {
+            // Insert a token from the dictionary
+            if (options->dictionary_length == 0) break;
+            char const* token = options->dictionary[(r >> 40) % options->dictionary_length];
+            size_t count = strlen(token);
+            if (count > sizeof(chunk)) count = sizeof(chunk);
+            memcpy(chunk, token, count);
+            ctest_insert_fuzz_bytes(data, size, maxSize, insertPosition, chunk, count);
+            break;
+        }
+        }
+    }
+}
+
+// The longest artifact path the signal handlers can write to
+#define __CTEST_FUZZ_PATH_CAPACITY 4096
+
+// The state of the running fuzzer, read by the signal handlers
+// Everything the handlers print or write is prepared before each input, because formatting and allocating is not async-signal-safe
+static struct {
+    CTest_FuzzTarget const* target;
+    uint8_t const* data;
+    size_t size;
+    char const* artifact_dir;
+    double input_timeout;
+    // When the running input started, 0 between inputs
+    double volatile start_time;
+    // The artifact paths of the running input, empty if they did not fit
+    char crash_path[__CTEST_FUZZ_PATH_CAPACITY];
+    char timeout_path[__CTEST_FUZZ_PATH_CAPACITY];
+    // Like " on an input of 12 bytes\n"
+    char input_description[64];
+    // Like "did not return within 1 seconds", the same for the whole run
+    char timeout_reason[64];
+} ctest_fuzz_state;
+
+static int const ctest_crash_signals[] = { SIGSEGV, SIGILL, SIGFPE, SIGABRT,
+#ifdef SIGBUS
+    SIGBUS,
+#endif
+};
+#define __CTEST_CRASH_SIGNAL_COUNT (sizeof(ctest_crash_signals) / sizeof(ctest_crash_signals[0]))
+static void(*ctest_previous_crash_handlers[__CTEST_CRASH_SIGNAL_COUNT])(int);
+
+// Prepares the artifact paths and the description of the input that is about to run, for the signal handlers
+static void ctest_prepare_fuzz_crash_report(uint8_t const* data, size_t size) {
+    unsigned long long hash = (unsigned long long)ctest_hash_bytes(data, size);
+    int length = snprintf(ctest_fuzz_state.crash_path, __CTEST_FUZZ_PATH_CAPACITY, "%s/crash-%s-%016llx", ctest_fuzz_state.artifact_dir, ctest_fuzz_state.target->name, hash);
+    if (length < 0 || length >= __CTEST_FUZZ_PATH_CAPACITY) ctest_fuzz_state.crash_path[0] = '\0';
+    length = snprintf(ctest_fuzz_state.timeout_path, __CTEST_FUZZ_PATH_CAPACITY, "%s/timeout-%s-%016llx", ctest_fuzz_state.artifact_dir, ctest_fuzz_state.target->name, hash);
+    if (length < 0 || length >= __CTEST_FUZZ_PATH_CAPACITY) ctest_fuzz_state.timeout_path[0] = '\0';
+    snprintf(ctest_fuzz_state.input_description, sizeof(ctest_fuzz_state.input_description), " on an input of %zu bytes\n", size);
+}
+
+// Writes the text to stderr from a signal handler
+static void ctest_write_signal_safe(char const* text) {
+#ifdef __CTEST_POSIX
+    size_t length = strlen(text);
+    while (length > 0) {
+        ssize_t written = write(STDERR_FILENO, text, length);
+        if (written <= 0) return;
+        text += written;
+        length -= (size_t)written;
+    }
+#else
+    // Without POSIX there is nothing async-signal-safe to write with, this is best effort
+    fputs(text, stderr);
+#endif
+}
+
+// Writes the input to the prepared path from a signal handler, returns false if it could not be written
+static bool ctest_write_fuzz_file_signal_safe(char const* path, uint8_t const* data, size_t size) {
+    if (path[0] == '\0') return false;
+#ifdef __CTEST_POSIX
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written <= 0) break;
+        data += written;
+        size -= (size_t)written;
+    }
+    return close(fd) == 0 && size == 0;
+#else
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return false;
+    bool ok = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && ok;
+#endif
+}
+
+// Writes the running input as an artifact on the way down, this is best effort, the process might be in a bad state
+static void ctest_report_fuzz_crash(char const* path, char const* reason, char const* detail) {
+    if (ctest_fuzz_state.target == NULL) return;
+    bool written = ctest_write_fuzz_file_signal_safe(path, ctest_fuzz_state.data, ctest_fuzz_state.size);
+    ctest_write_signal_safe("\nFuzz target ");
+    ctest_write_signal_safe(ctest_fuzz_state.target->name);
+    ctest_write_signal_safe(" ");
+    ctest_write_signal_safe(reason);
+    ctest_write_signal_safe(detail);
+    ctest_write_signal_safe(ctest_fuzz_state.input_description);
+    if (!written) return;
+    ctest_write_signal_safe("Input written to ");
+    ctest_write_signal_safe(path);
+    ctest_write_signal_safe(", reproduce with '--fuzz ");
+    ctest_write_signal_safe(ctest_fuzz_state.target->name);
+    ctest_write_signal_safe(" --reproduce ");
+    ctest_write_signal_safe(path);
+    ctest_write_signal_safe("'\n");
+}
+
+static void ctest_fuzz_crash_handler(int signalNumber) {
+    // The signal number in decimal, without the formatting functions
+    char digits[16];
+    size_t digitIndex = sizeof(digits) - 1;
+    digits[digitIndex] = '\0';
+    unsigned value = (signalNumber < 0) ? 0u : (unsigned)signalNumber;
+    do {
+        digits[--digitIndex] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0 && digitIndex > 0);
+    ctest_report_fuzz_crash(ctest_fuzz_state.crash_path, "crashed with signal ", &digits[digitIndex]);
+    ctest_fuzz_state.target = NULL;
+    // Returning with the previous handler restored faults again, or finishes the abort, so sanitizers still get to report the crash
+    for (size_t i = 0; i < __CTEST_CRASH_SIGNAL_COUNT; ++i) {
+        if (ctest_crash_signals[i] == signalNumber) signal(signalNumber, ctest_previous_crash_handlers[i]);
+    }
+}
+
+#ifdef __CTEST_POSIX
+static void(*ctest_previous_alarm_handler)(int);
+
+// Checks every second if the running input exceeded its time limit without returning, which can't be reported any other way.
+// Inputs get a second of grace, slow inputs that still return are reported as slow instead.
+static void ctest_fuzz_watchdog(int signalNumber) {
+    (void)signalNumber;
+    double startTime = ctest_fuzz_state.start_time;
+    if (startTime > 0 && ctest_now() - startTime > ctest_fuzz_state.input_timeout + 1) {
+        ctest_report_fuzz_crash(ctest_fuzz_state.timeout_path, ctest_fuzz_state.timeout_reason, "");
+        _exit(1);
+    }
+    alarm(1);
+}
+#endif
+
+// Copies the failing or slow input into the result and writes it as an artifact
+static void ctest_record_fuzz_input(CTest_FuzzResult* result, char const* prefix, uint8_t const* data, size_t size, char const* artifactDir) {
+    result->input = ctest_copy_fuzz_bytes(data, size);
+    result->input_size = size;
+    char fullPrefix[256];
+    snprintf(fullPrefix, sizeof(fullPrefix), "%s-%s-", prefix, result->target->name);
+    result->artifact_path = ctest_write_fuzz_file(artifactDir, fullPrefix, data, size);
+}
+
+// Runs one input of the fuzzing run, returns true if it ended the run
+static bool ctest_fuzz_one(CTest_FuzzResult* result, CTest_FuzzCorpus* corpus, CTest_FuzzOptions const* options, uint8_t const* data, size_t size, bool keepNewCoverage) {
+    ctest_fuzz_state.data = data;
+    ctest_fuzz_state.size = size;
+    ctest_prepare_fuzz_crash_report(data, size);
+    ctest_fuzz_state.start_time = ctest_now();
+    CTest_Execution execution = ctest_run_fuzz_input(result->target, data, size);
+    ctest_fuzz_state.start_time = 0;
+    ++result->runs;
+    if (execution.wall_time > result->slowest_input_time) result->slowest_input_time = execution.wall_time;
+
+    if (!execution.passed) {
+        result->failed = true;
+        result->execution = execution;
+        ctest_record_fuzz_input(result, "failure", data, size, options->artifact_dir);
+        return true;
+    }
+    if (execution.wall_time > options->input_timeout) {
+        result->slow = true;
+        result->execution = execution;
+        ctest_record_fuzz_input(result, "slow", data, size, options->artifact_dir);
+        return true;
+    }
+    size_t newFeatures = ctest_coverage_available ? ctest_collect_coverage() : 0;
+    result->features += newFeatures;
+    if (keepNewCoverage && newFeatures > 0) {
+        ctest_add_fuzz_input(corpus, data, size);
+        if (options->corpus_dir != NULL) CTEST_FREE(ctest_write_fuzz_file(options->corpus_dir, "", data, size));
+    }
+    return false;
+}
+
+CTest_FuzzResult ctest_fuzz(CTest_FuzzTarget const* target, CTest_FuzzOptions options) {
+    if (options.runs == 0 && options.max_time <= 0) options.runs = 100000;
+    if (options.max_input_size == 0) options.max_input_size = 4096;
+    if (options.input_timeout <= 0) options.input_timeout = 1;
+    if (options.seed == 0) options.seed = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32);
+    if (options.artifact_dir == NULL) options.artifact_dir = ".";
+
+    CTest_FuzzResult result = {
+        .target = target,
+        .seed = options.seed,
+    };
+    uint64_t random = options.seed;
+    memset(ctest_coverage_counters, 0, sizeof(ctest_coverage_counters));
+    memset(ctest_coverage_seen, 0, sizeof(ctest_coverage_seen));
+
+    ctest_fuzz_state.target = target;
+    ctest_fuzz_state.artifact_dir = options.artifact_dir;
+    ctest_fuzz_state.input_timeout = options.input_timeout;
+    ctest_fuzz_state.start_time = 0;
+    snprintf(ctest_fuzz_state.timeout_reason, sizeof(ctest_fuzz_state.timeout_reason), "did not return within %g seconds", options.input_timeout);
+    for (size_t i = 0; i < __CTEST_CRASH_SIGNAL_COUNT; ++i) {
+        ctest_previous_crash_handlers[i] = signal(ctest_crash_signals[i], ctest_fuzz_crash_handler);
+    }
+#ifdef __CTEST_POSIX
+    ctest_previous_alarm_handler = signal(SIGALRM, ctest_fuzz_watchdog);
+    alarm(1);
+#endif
+
+    double startTime = ctest_now();
+    CTest_FuzzCorpus corpus = { 0 };
+#ifdef __CTEST_POSIX
+    if (options.corpus_dir != NULL) ctest_load_fuzz_corpus(options.corpus_dir, &corpus, options.max_input_size);
+#endif
+    if (corpus.length == 0) ctest_add_fuzz_input(&corpus, NULL, 0);
+
+    // The initial corpus runs first, which collects its coverage and catches inputs that fail already
+    bool stop = false;
+    for (size_t i = 0; i < corpus.length && !stop; ++i) {
+        stop = ctest_fuzz_one(&result, &corpus, &options, corpus.inputs[i].data, corpus.inputs[i].size, false);
+    }
+
+    uint8_t* buffer = (uint8_t*)CTEST_REALLOC(NULL, options.max_input_size);
+    CTEST_INTERNAL_ASSERT(buffer != NULL, "failed to allocate memory for fuzz input");
+    while (!stop) {
+        if (options.runs > 0 && result.runs >= options.runs) break;
+        if (options.max_time > 0 && ctest_now() - startTime >= options.max_time) break;
+        CTest_FuzzInput const* parent = &corpus.inputs[ctest_next_random(&random) % corpus.length];
+        size_t size = parent->size;
+        memcpy(buffer, parent->data, size);
+        ctest_mutate_fuzz_input(buffer, &size, options.max_input_size, &corpus, &options, &random);
+        stop = ctest_fuzz_one(&result, &corpus, &options, buffer, size, true);
+        // Without coverage feedback, some inputs are kept at random, so the inputs still grow beyond a few mutations
+        if (!stop && !ctest_coverage_available && ctest_next_random(&random) % 8 == 0) {
+            if (corpus.length < 1024) {
+                ctest_add_fuzz_input(&corpus, buffer, size);
+            }
+            else {
+                CTest_FuzzInput* replaced = &corpus.inputs[ctest_next_random(&random) % corpus.length];
+                CTEST_FREE(replaced->data);
+                replaced->data = ctest_copy_fuzz_bytes(buffer, size);
+                replaced->size = size;
+            }
+        }
+    }
+    CTEST_FREE(buffer);
+
+#ifdef __CTEST_POSIX
+    alarm(0);
+    signal(SIGALRM, ctest_previous_alarm_handler);
+#endif
+    for (size_t i = 0; i < __CTEST_CRASH_SIGNAL_COUNT; ++i) signal(ctest_crash_signals[i], ctest_previous_crash_handlers[i]);
+    ctest_fuzz_state.target = NULL;
+
+    result.elapsed = ctest_now() - startTime;
+    if (result.elapsed > 0) result.execs_per_second = (double)result.runs / result.elapsed;
+    result.corpus_size = corpus.length;
+    ctest_free_fuzz_corpus(&corpus);
+    return result;
+}
+
+void ctest_print_fuzz_result(CTest_FuzzResult result) {
+    char elapsed[32], slowest[32];
+    ctest_format_time(elapsed, sizeof(elapsed), result.elapsed);
+    ctest_format_time(slowest, sizeof(slowest), result.slowest_input_time);
+    printf("Fuzzing %s: %zu runs in %s (%.0f exec/s), seed %llu, %zu inputs in the corpus", result.target->name, result.runs, elapsed, result.execs_per_second, (unsigned long long)result.seed, result.corpus_size);
+    if (result.features > 0) printf(", %zu coverage features", result.features);
+    printf(", slowest input %s\n", slowest);
+    if (!result.failed && !result.slow) return;
+
+    if (result.failed) {
+        CTest_Execution const* execution = &result.execution;
+        printf("  Failed: %s (file: %s, function: %s, line: %d)\n", execution->fail_info.message, execution->fail_info.file, execution->fail_info.function, execution->fail_info.line);
+    }
+    else {
+        char inputTime[32];
+        ctest_format_time(inputTime, sizeof(inputTime), result.execution.wall_time);
+        printf("  Slow input: took %s\n", inputTime);
+    }
+    // As a C string literal, so it can be pasted into a regression test
+    size_t printedSize = (result.input_size > 256) ? 256 : result.input_size;
+    printf("  Input (%zu bytes): \"", result.input_size);
+    for (size_t i = 0; i < printedSize; ++i) {
+        uint8_t c = result.input[i];
+        if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (c >= 0x20 && c < 0x7f) putchar(c);
+        // Octal escapes end after 3 digits, unlike hexadecimal ones which would swallow the next character
+        else printf("\\%03o", c);
+    }
+    printf((printedSize < result.input_size) ? "\"...\n" : "\"\n");
+    if (result.artifact_path != NULL) printf("  Written to %s, reproduce with '--fuzz %s --reproduce %s'\n", result.artifact_path, result.target->name, result.artifact_path);
+}
+
+void ctest_free_fuzz_result(CTest_FuzzResult* result) {
+    CTEST_FREE(result->input);
+    CTEST_FREE(result->artifact_path);
+    result->input = NULL;
+    result->artifact_path = NULL;
+}
+
+#ifdef CTEST_LIBFUZZER
+// Called by libFuzzer for every input, the target is picked by the CTEST_FUZZ_TARGET environment variable, or the first one
+int LLVMFuzzerTestOneInput(uint8_t const* data, size_t size);
+int LLVMFuzzerTestOneInput(uint8_t const* data, size_t size) {
+    static CTest_FuzzTarget const* target = NULL;
+    if (target == NULL) {
+        char const* name = getenv("CTEST_FUZZ_TARGET");
+        for (size_t i = 0; i < __ctest_default_fuzz_suite.length && target == NULL; ++i) {
+            if (name == NULL || strcmp(__ctest_default_fuzz_suite.targets[i].name, name) == 0) target = &__ctest_default_fuzz_suite.targets[i];
+        }
+        if (target == NULL) {
+            fprintf(stderr, "no fuzz target named '%s'\n", (name == NULL) ? "" : name);
+            abort();
+        }
+    }
+    CTest_Execution execution = ctest_run_fuzz_input(target, data, size);
+    if (!execution.passed) {
+        fprintf(stderr, "Fuzz target %s failed: %s (file: %s, function: %s, line: %d)\n", target->name, execution.fail_info.message, execution.fail_info.file, execution.fail_info.function, execution.fail_info.line);
+        // libFuzzer writes the input of crashes
+        abort();
+    }
+    return 0;
+}
+#endif /* CTEST_LIBFUZZER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#undef CTEST_ASSERT
+
+#endif /* CTEST_IMPLEMENTATION */
+
+////////////////////////////////////////////////////////////////////////////////
+// Main-program section                                                       //
+////////////////////////////////////////////////////////////////////////////////
+// libFuzzer brings its own main
+#if defined(CTEST_MAIN) && !defined(CTEST_LIBFUZZER)
+
+#include <string.h>
+
+typedef struct CliFilters {
+    char** words;
+    size_t word_count;
+} CliFilters;
+
+// Parses the value of an option either from the rest of the current argument, or from the next one
+static char const* cli_option_value(int argc, char* argv[], int* index, char const* option) {
+    char const* arg = argv[*index];
+    size_t optionLength = strlen(option);
+    if (arg[optionLength] == '=') return arg + optionLength + 1;
+    // Short options can be followed directly by their value, like -j4
+    if (arg[optionLength] != '\0' && optionLength == 2) return arg + optionLength;
+    if (arg[optionLength] != '\0' || *index + 1 >= argc) return NULL;
+    ++*index;
+    return argv[*index];
+}
+
+static bool cli_is_option(char const* arg, char const* option) {
+    size_t optionLength = strlen(option);
+    if (strncmp(arg, option, optionLength) != 0) return false;
+    return arg[optionLength] == '\0' || arg[optionLength] == '=' || optionLength == 2;
+}
+
+static bool filter_by_name(char const* name, CliFilters* filters) {
+    for (size_t i = 0; i < filters->word_count; ++i) {
+        if (strstr(name, filters->words[i]) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool filter_cases_by_name(CTest_Case const* testCase, void* user) {
+    return filter_by_name(testCase->name, (CliFilters*)user);
+}
+
+static bool filter_benches_by_name(CTest_Bench const* bench, void* user) {
+    return filter_by_name(bench->name, (CliFilters*)user);
+}
+
+typedef struct CliBenchArgs {
+    CTest_BenchOptions options;
+    CTest_BenchCompareOptions compare_options;
+    // The baseline file to write the results to, if any
+    char const* save_baseline;
+    // The baseline file to compare the results against, if any
+    char const* baseline;
+    // True, if stdout is reserved for a machine-readable format, so the text report is not printed
+    bool quiet;
+} CliBenchArgs;
+
+// Counts the regressions like ctest_print_bench_comparison, without printing anything
+static size_t count_bench_regressions(CTest_BenchReport report, CTest_BenchBaseline baseline, CTest_BenchCompareOptions options) {
+    size_t regressions = 0;
+    for (size_t i = 0; i < report.length; ++i) {
+        CTest_BenchResult const* result = &report.results[i];
+        CTest_BenchBaselineEntry const* entry = ctest_find_bench_baseline_entry(baseline, result->bench->name);
+        if (entry == NULL) continue;
+        CTest_BenchComparison comparison = ctest_compare_bench(entry->sample_times, entry->samples, result->sample_times, result->samples, options);
+        if (comparison.regressed) ++regressions;
+    }
+    return regressions;
+}
+
+static bool filter_fuzz_targets_by_name(char const* name, CliFilters* filters) {
+    return filters->word_count == 0 || filter_by_name(name, filters);
+}
+
+typedef struct CliFuzzArgs {
+    CTest_FuzzOptions options;
+    // The input file to run the targets on instead of fuzzing, if any
+    char const* reproduce;
+} CliFuzzArgs;
+
+static int run_fuzzers(CliFilters* cliFilters, CliFuzzArgs args) {
+    uint8_t* input = NULL;
+    size_t inputSize = 0;
+    if (args.reproduce != NULL && !ctest_read_fuzz_input(args.reproduce, &input, &inputSize)) {
+        fprintf(stderr, "failed to read input '%s'\n", args.reproduce);
+        CTEST_FREE(input);
+        return 1;
+    }
+
+    int exitCode = 0;
+    CTest_FuzzSuite suite = ctest_get_fuzz_suite();
+    for (size_t i = 0; i < suite.length; ++i) {
+        CTest_FuzzTarget const* target = &suite.targets[i];
+        if (!filter_fuzz_targets_by_name(target->name, cliFilters)) continue;
+        if (args.reproduce != NULL) {
+            CTest_Execution execution = ctest_run_fuzz_input(target, input, inputSize);
+            char inputTime[32];
+            ctest_format_time(inputTime, sizeof(inputTime), execution.wall_time);
+            if (execution.passed) {
+                printf("Fuzz target %s passed on %s in %s\n", target->name, args.reproduce, inputTime);
+            }
+            else {
+                printf("Fuzz target %s failed on %s: %s (file: %s, function: %s, line: %d)\n", target->name, args.reproduce, execution.fail_info.message, execution.fail_info.file, execution.fail_info.function, execution.fail_info.line);
+                exitCode = 1;
+            }
+            continue;
+        }
+        CTest_FuzzResult result = ctest_fuzz(target, args.options);
+        ctest_print_fuzz_result(result);
+        if (result.failed || result.slow) exitCode = 1;
+        ctest_free_fuzz_result(&result);
+    }
+
+    ctest_free_fuzz_suite(&suite);
+    CTEST_FREE(input);
+    return exitCode;
+}
 
-#endif /* CTEST_IMPLEMENTATION */
+// Parses the name of a machine-readable format
+static bool cli_parse_format(char const* name, CTest_Format* format) {
+    if (strcmp(name, "junit") == 0) *format = CTEST_FORMAT_JUNIT;
+    else if (strcmp(name, "tap") == 0) *format = CTEST_FORMAT_TAP;
+    else if (strcmp(name, "jsonl") == 0) *format = CTEST_FORMAT_JSON_LINES;
+    else return false;
+    return true;
+}
 
-////////////////////////////////////////////////////////////////////////////////
-// Main-program section                                                       //
-////////////////////////////////////////////////////////////////////////////////
-#ifdef CTEST_MAIN
+static int run_benches(CliFilters* cliFilters, CliBenchArgs args) {
+    CTest_BenchFilter filter = { 0 };
+    if (cliFilters->word_count > 0) {
+        filter.filter_fn = filter_benches_by_name;
+        filter.user = cliFilters;
+    }
 
-#include <string.h>
+    // Read the baseline first, so a missing file is reported before spending time on the benchmarks
+    CTest_BenchBaseline baseline = { 0 };
+    if (args.baseline != NULL && !ctest_read_bench_baseline(args.baseline, &baseline)) {
+        fprintf(stderr, "failed to read baseline '%s'\n", args.baseline);
+        ctest_free_bench_baseline(&baseline);
+        return 1;
+    }
 
-typedef struct CliFilters {
-    char** words;
-    size_t word_count;
-} CliFilters;
+    CTest_BenchSuite suite = ctest_get_bench_suite();
+    CTest_BenchReport report = ctest_run_bench_suite(suite, filter, args.options);
+    if (!args.quiet) ctest_print_bench_report(report);
 
-static bool filter_cases_by_name(CTest_Case const* testCase, void* user) {
-    CliFilters* filters = (CliFilters*)user;
-    for (size_t i = 0; i < filters->word_count; ++i) {
-        if (strstr(testCase->name, filters->words[i]) != NULL) {
-            return true;
-        }
+    int exitCode = 0;
+    if (args.baseline != NULL) {
+        size_t regressions = args.quiet
+            ? count_bench_regressions(report, baseline, args.compare_options)
+            : ctest_print_bench_comparison(report, baseline, args.compare_options);
+        if (regressions > 0) exitCode = 1;
     }
-    return false;
+    if (args.save_baseline != NULL && !ctest_write_bench_baseline(report, args.save_baseline)) {
+        fprintf(stderr, "failed to write baseline '%s'\n", args.save_baseline);
+        exitCode = 1;
+    }
+
+    ctest_free_bench_baseline(&baseline);
+    ctest_free_bench_report(&report);
+    ctest_free_bench_suite(&suite);
+    return exitCode;
 }
 
 int main(int argc, char* argv[]) {
     // We implement a default main program that runs all test cases, if no arguments are specified
     // If there are arguments, we use them as filters and only run the cases that contain any of the arguments as a substring in their name
+    // The options '-j N' (or '--jobs N') and '--timeout SECONDS' configure running the cases in processes
+    // The option '--slowest N' sets how many of the slowest cases are listed
+    // The options '--shard-index I' and '--shard-count N' split the suite, '--shuffle' and '--seed S' randomize the order, '--repeat N' repeats the cases
+    // The option '--bench' runs the benchmarks instead, with '--samples N' measured samples each
+    // The options '--save-baseline PATH', '--baseline PATH' and '--threshold PERCENT' store and compare the benchmark results
+    // The option '--counters' collects performance counters for the benchmarks
+    // The option '--format junit|tap|jsonl' streams the results in a machine-readable format, to stdout or to '--output PATH'
+    // The option '--fuzz' fuzzes the targets instead, configured with '--runs N', '--max-time SECONDS', '--max-len N', '--input-timeout SECONDS',
+    // '--corpus DIR' and '--artifacts DIR', or runs them on one input with '--reproduce PATH', the seed is shared with '--seed S'
 
     CTest_Filter filter = { 0 };
+    CTest_Options options = { 0 };
+    CliBenchArgs benchArgs = { 0 };
+    CliFuzzArgs fuzzArgs = { 0 };
+    bool runBenches = false;
+    bool runFuzzers = false;
+    size_t slowestCount = 5;
+    bool hasSeed = false;
+    char const* formatName = NULL;
+    char const* outputPath = NULL;
     CliFilters cliFilters = { 0 };
-    if (argc > 1) {
-        cliFilters.words = &argv[1];
-        cliFilters.word_count = (size_t)(argc - 1);
+    cliFilters.words = (char**)CTEST_REALLOC(NULL, (size_t)argc * sizeof(char*));
+    for (int i = 1; i < argc; ++i) {
+        char const* value = NULL;
+        if (cli_is_option(argv[i], "-j") || cli_is_option(argv[i], "--jobs")) {
+            value = cli_option_value(argc, argv, &i, argv[i][1] == 'j' ? "-j" : "--jobs");
+            if (value != NULL) options.jobs = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (cli_is_option(argv[i], "--timeout")) {
+            value = cli_option_value(argc, argv, &i, "--timeout");
+            if (value != NULL) options.timeout = strtod(value, NULL);
+        }
+        else if (cli_is_option(argv[i], "--slowest")) {
+            value = cli_option_value(argc, argv, &i, "--slowest");
+            if (value != NULL) slowestCount = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (cli_is_option(argv[i], "--shard-index")) {
+            value = cli_option_value(argc, argv, &i, "--shard-index");
+            if (value != NULL) options.shard_index = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (cli_is_option(argv[i], "--shard-count")) {
+            value = cli_option_value(argc, argv, &i, "--shard-count");
+            if (value != NULL) options.shard_count = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(argv[i], "--shuffle") == 0) {
+            options.shuffle = true;
+            continue;
+        }
+        else if (cli_is_option(argv[i], "--seed")) {
+            value = cli_option_value(argc, argv, &i, "--seed");
+            if (value != NULL) {
+                options.seed = (uint64_t)strtoull(value, NULL, 10);
+                hasSeed = true;
+            }
+        }
+        else if (cli_is_option(argv[i], "--repeat")) {
+            value = cli_option_value(argc, argv, &i, "--repeat");
+            if (value != NULL) options.repeat = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(argv[i], "--bench") == 0) {
+            runBenches = true;
+            continue;
+        }
+        else if (cli_is_option(argv[i], "--samples")) {
+            value = cli_option_value(argc, argv, &i, "--samples");
+            if (value != NULL) benchArgs.options.samples = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(argv[i], "--counters") == 0) {
+            benchArgs.options.counters = true;
+            continue;
+        }
+        else if (cli_is_option(argv[i], "--save-baseline")) {
+            value = cli_option_value(argc, argv, &i, "--save-baseline");
+            benchArgs.save_baseline = value;
+        }
+        else if (cli_is_option(argv[i], "--baseline")) {
+            value = cli_option_value(argc, argv, &i, "--baseline");
+            benchArgs.baseline = value;
+        }
+        else if (cli_is_option(argv[i], "--threshold")) {
+            value = cli_option_value(argc, argv, &i, "--threshold");
+            if (value != NULL) benchArgs.compare_options.threshold = strtod(value, NULL) / 100.0;
+        }
+        else if (strcmp(argv[i], "--fuzz") == 0) {
+            runFuzzers = true;
+            continue;
+        }
+        else if (cli_is_option(argv[i], "--runs")) {
+            value = cli_option_value(argc, argv, &i, "--runs");
+            if (value != NULL) fuzzArgs.options.runs = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (cli_is_option(argv[i], "--max-time")) {
+            value = cli_option_value(argc, argv, &i, "--max-time");
+            if (value != NULL) fuzzArgs.options.max_time = strtod(value, NULL);
+        }
+        else if (cli_is_option(argv[i], "--max-len")) {
+            value = cli_option_value(argc, argv, &i, "--max-len");
+            if (value != NULL) fuzzArgs.options.max_input_size = (size_t)strtoul(value, NULL, 10);
+        }
+        else if (cli_is_option(argv[i], "--input-timeout")) {
+            value = cli_option_value(argc, argv, &i, "--input-timeout");
+            if (value != NULL) fuzzArgs.options.input_timeout = strtod(value, NULL);
+        }
+        else if (cli_is_option(argv[i], "--corpus")) {
+            value = cli_option_value(argc, argv, &i, "--corpus");
+            fuzzArgs.options.corpus_dir = value;
+        }
+        else if (cli_is_option(argv[i], "--artifacts")) {
+            value = cli_option_value(argc, argv, &i, "--artifacts");
+            fuzzArgs.options.artifact_dir = value;
+        }
+        else if (cli_is_option(argv[i], "--reproduce")) {
+            value = cli_option_value(argc, argv, &i, "--reproduce");
+            fuzzArgs.reproduce = value;
+        }
+        else if (cli_is_option(argv[i], "--format")) {
+            value = cli_option_value(argc, argv, &i, "--format");
+            formatName = value;
+        }
+        else if (cli_is_option(argv[i], "--output")) {
+            value = cli_option_value(argc, argv, &i, "--output");
+            outputPath = value;
+        }
+        else {
+            cliFilters.words[cliFilters.word_count++] = argv[i];
+            continue;
+        }
+        if (value == NULL) {
+            fprintf(stderr, "missing value for option '%s'\n", argv[i]);
+            CTEST_FREE((void*)cliFilters.words);
+            return 1;
+        }
+    }
+    CTest_FormatWriter formatWriter = { 0 };
+    bool quiet = false;
+    if (formatName != NULL) {
+        if (!cli_parse_format(formatName, &formatWriter.format)) {
+            fprintf(stderr, "unknown format '%s', expected junit, tap or jsonl\n", formatName);
+            CTEST_FREE((void*)cliFilters.words);
+            return 1;
+        }
+        formatWriter.out = stdout;
+        if (outputPath != NULL) {
+            formatWriter.out = fopen(outputPath, "w");
+            if (formatWriter.out == NULL) {
+                fprintf(stderr, "failed to open output '%s'\n", outputPath);
+                CTEST_FREE((void*)cliFilters.words);
+                return 1;
+            }
+        }
+        // When the results are streamed to stdout, the text report would make it unparseable
+        quiet = (outputPath == NULL);
+        options.reporter = ctest_format_reporter(&formatWriter);
+        benchArgs.options.reporter = options.reporter;
+        benchArgs.quiet = quiet;
+    }
+    if (runFuzzers) {
+        if (hasSeed) fuzzArgs.options.seed = options.seed;
+        int fuzzExitCode = run_fuzzers(&cliFilters, fuzzArgs);
+        if (outputPath != NULL && formatName != NULL) fclose(formatWriter.out);
+        CTEST_FREE((void*)cliFilters.words);
+        return fuzzExitCode;
+    }
+    if (runBenches) {
+        int benchExitCode = run_benches(&cliFilters, benchArgs);
+        if (outputPath != NULL && formatName != NULL) fclose(formatWriter.out);
+        CTEST_FREE((void*)cliFilters.words);
+        return benchExitCode;
+    }
+    if (cliFilters.word_count > 0) {
         filter.filter_fn = filter_cases_by_name;
         filter.user = &cliFilters;
     }
+    if (options.shard_count > 1 && options.shard_index >= options.shard_count) {
+        fprintf(stderr, "shard index %zu is out of range for %zu shards\n", options.shard_index, options.shard_count);
+        CTEST_FREE((void*)cliFilters.words);
+        return 1;
+    }
+    if (options.shuffle) {
+        // Without a seed every run is different, the seed is printed to reproduce the order
+        if (!hasSeed) options.seed = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32);
+        fprintf(quiet ? stderr : stdout, "Shuffling with seed %llu\n", (unsigned long long)options.seed);
+    }
 
     CTest_Suite suite = ctest_get_suite();
-    CTest_Report report = ctest_run_suite(suite, filter);
-    ctest_print_report(report);
+    CTest_Report report = ctest_run_suite_with_options(suite, filter, options);
+    if (!quiet) {
+        ctest_print_slowest_cases(report, slowestCount);
+        ctest_print_report(report);
+    }
+    if (outputPath != NULL && formatName != NULL) fclose(formatWriter.out);
     int exitCode = (report.failing.length == 0) ? 0 : 1;
 
     ctest_free_report(&report);
     ctest_free_suite(&suite);
+    CTEST_FREE((void*)cliFilters.words);
 
     return exitCode;
 }
@@ -523,6 +3854,591 @@ ExpectedTestCase expectedCases[] = {
 #undef EXPECTED_CASE
 };
 
+static void busy_case(void) {
+    double start = ctest_now();
+    while (ctest_now() - start < 0.02) {}
+}
+
+static void quick_case(void) {}
+
+static bool check_case_timing(void) {
+    CTest_Suite suite = { 0 };
+    ctest_register_case(&suite, (CTest_Case){ .name = "busy", .test_fn = busy_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "quick", .test_fn = quick_case });
+    CTest_Report report = ctest_run_suite(suite, (CTest_Filter){ 0 });
+    bool ok = true;
+    CTest_Execution* busy = &report.passing.cases[0];
+    if (busy->wall_time < 0.02 || busy->cpu_time <= 0) {
+        printf("expected the busy case to take time, but it took %g seconds (cpu %g seconds)\n", busy->wall_time, busy->cpu_time);
+        ok = false;
+    }
+    if (ok && report.passing.cases[1].wall_time > busy->wall_time) {
+        puts("expected the quick case to be faster than the busy one");
+        ok = false;
+    }
+    puts("Sample output of the slowest cases:");
+    ctest_print_slowest_cases(report, 1);
+    ctest_free_report(&report);
+    ctest_free_suite(&suite);
+    return ok;
+}
+
+size_t selectionRunCount = 0;
+
+static void selection_case(void) {
+    ++selectionRunCount;
+}
+
+// Counts how many times each case of the suite was executed in the report
+static void count_executions_per_case(CTest_Suite suite, CTest_Report report, size_t* counts) {
+    for (size_t i = 0; i < suite.length; ++i) counts[i] = 0;
+    for (size_t i = 0; i < report.passing.length; ++i) ++counts[report.passing.cases[i].test_case - suite.cases];
+}
+
+static bool check_case_selection(void) {
+    static char names[20][16];
+    CTest_Suite suite = { 0 };
+    for (size_t i = 0; i < 20; ++i) {
+        snprintf(names[i], sizeof(names[i]), "selected_%zu", i);
+        ctest_register_case(&suite, (CTest_Case){ .name = names[i], .test_fn = selection_case });
+    }
+    size_t counts[20];
+    size_t totals[20] = { 0 };
+
+    // Shards partition the suite
+    size_t nonEmptyShards = 0;
+    for (size_t shard = 0; shard < 4; ++shard) {
+        CTest_Report report = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, (CTest_Options){ .shard_count = 4, .shard_index = shard });
+        count_executions_per_case(suite, report, counts);
+        for (size_t i = 0; i < 20; ++i) totals[i] += counts[i];
+        if (report.passing.length > 0) ++nonEmptyShards;
+        ctest_free_report(&report);
+    }
+    for (size_t i = 0; i < 20; ++i) {
+        if (totals[i] != 1) {
+            printf("expected case %s to run in exactly one shard, but it ran in %zu\n", names[i], totals[i]);
+            return false;
+        }
+    }
+    if (nonEmptyShards < 2) {
+        puts("expected the cases to be spread over the shards");
+        return false;
+    }
+
+    // The same seed gives the same order, which is a permutation of the suite
+    CTest_Options options = { .shuffle = true, .seed = 42 };
+    CTest_Report first = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, options);
+    CTest_Report second = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, options);
+    options.seed = 43;
+    CTest_Report third = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, options);
+    bool sameOrder = true;
+    bool suiteOrder = true;
+    bool otherSeedSameOrder = true;
+    for (size_t i = 0; i < 20; ++i) {
+        if (first.passing.cases[i].test_case != second.passing.cases[i].test_case) sameOrder = false;
+        if (first.passing.cases[i].test_case != &suite.cases[i]) suiteOrder = false;
+        if (first.passing.cases[i].test_case != third.passing.cases[i].test_case) otherSeedSameOrder = false;
+    }
+    count_executions_per_case(suite, first, counts);
+    ctest_free_report(&first);
+    ctest_free_report(&second);
+    ctest_free_report(&third);
+    if (!sameOrder || suiteOrder || otherSeedSameOrder) {
+        puts("expected the shuffled order to be determined by the seed");
+        return false;
+    }
+    for (size_t i = 0; i < 20; ++i) {
+        if (counts[i] != 1) {
+            puts("expected a shuffled run to run every case once");
+            return false;
+        }
+    }
+
+    // Repeats run every case again
+    selectionRunCount = 0;
+    CTest_Report report = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, (CTest_Options){ .repeat = 3, .shuffle = true, .seed = 7 });
+    count_executions_per_case(suite, report, counts);
+    ctest_free_report(&report);
+    ctest_free_suite(&suite);
+    if (selectionRunCount != 60) {
+        printf("expected 60 runs with 3 repeats, but got %zu\n", selectionRunCount);
+        return false;
+    }
+    for (size_t i = 0; i < 20; ++i) {
+        if (counts[i] != 3) {
+            puts("expected every case to be repeated 3 times");
+            return false;
+        }
+    }
+    return true;
+}
+
+static void reported_passing_case(void) {}
+static void reported_failing_case(void) { CTEST_ASSERT_FAIL("expected <\"quoted\"> & escaped"); }
+
+typedef struct RecordedEvents {
+    size_t begin_count;
+    size_t executions;
+    size_t ends;
+} RecordedEvents;
+
+static void record_begin(size_t count, void* user) { ((RecordedEvents*)user)->begin_count = count; }
+static void record_execution(CTest_Execution const* execution, void* user) { (void)execution; ++((RecordedEvents*)user)->executions; }
+static void record_end(void* user) { ++((RecordedEvents*)user)->ends; }
+
+// Streams the suite in the given format and returns the written text, which needs to be freed
+static char* write_suite_in_format(CTest_Suite suite, CTest_Format format) {
+    CTest_FormatWriter writer = { .format = format, .out = tmpfile() };
+    if (writer.out == NULL) return NULL;
+    CTest_Report report = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, (CTest_Options){ .reporter = ctest_format_reporter(&writer) });
+    ctest_free_report(&report);
+    long length = ftell(writer.out);
+    char* text = (char*)CTEST_REALLOC(NULL, (size_t)length + 1);
+    rewind(writer.out);
+    size_t readLength = fread(text, 1, (size_t)length, writer.out);
+    text[readLength] = '\0';
+    fclose(writer.out);
+    return text;
+}
+
+static bool check_format_contains(CTest_Suite suite, CTest_Format format, char const* const* fragments, size_t fragmentCount) {
+    char* text = write_suite_in_format(suite, format);
+    if (text == NULL) {
+        puts("failed to create a temporary file for the reporter output");
+        return false;
+    }
+    for (size_t i = 0; i < fragmentCount; ++i) {
+        if (strstr(text, fragments[i]) == NULL) {
+            printf("expected the reporter output to contain '%s', but it was:\n%s\n", fragments[i], text);
+            CTEST_FREE(text);
+            return false;
+        }
+    }
+    CTEST_FREE(text);
+    return true;
+}
+
+static bool check_reporters(void) {
+    CTest_Suite suite = { 0 };
+    ctest_register_case(&suite, (CTest_Case){ .name = "reported_passing", .test_fn = reported_passing_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "reported_failing", .test_fn = reported_failing_case });
+
+    // Every result is reported between the beginning and the end of the run
+    RecordedEvents events = { 0 };
+    CTest_Reporter recorder = { .begin_fn = record_begin, .execution_fn = record_execution, .end_fn = record_end, .user = &events };
+    CTest_Report report = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, (CTest_Options){ .reporter = recorder, .repeat = 2 });
+    ctest_free_report(&report);
+    if (events.begin_count != 4 || events.executions != 4 || events.ends != 1) {
+        printf("expected 4 reported executions in one run, but got %zu of %zu in %zu run(s)\n", events.executions, events.begin_count, events.ends);
+        return false;
+    }
+
+    char const* junit[] = {
+        "<testsuite name=\"ctest\" tests=\"2\">",
+        "<testcase classname=\"ctest\" name=\"reported_passing\"",
+        "<failure message=\"expected &lt;&quot;quoted&quot;&gt; &amp; escaped\">",
+        "</testsuites>",
+    };
+    char const* tap[] = {
+        "TAP version 13\n1..2\n",
+        "ok 1 - reported_passing",
+        "not ok 2 - reported_failing",
+        "  message: \"expected <\\\"quoted\\\"> & escaped\"",
+    };
+    char const* jsonLines[] = {
+        "{\"type\":\"begin\",\"count\":2}\n",
+        "{\"type\":\"case\",\"name\":\"reported_passing\",\"passed\":true,",
+        "\"message\":\"expected <\\\"quoted\\\"> & escaped\"",
+        "{\"type\":\"end\",\"count\":2,\"failed\":1}\n",
+    };
+    bool ok = check_format_contains(suite, CTEST_FORMAT_JUNIT, junit, sizeof(junit) / sizeof(junit[0]))
+           && check_format_contains(suite, CTEST_FORMAT_TAP, tap, sizeof(tap) / sizeof(tap[0]))
+           && check_format_contains(suite, CTEST_FORMAT_JSON_LINES, jsonLines, sizeof(jsonLines) / sizeof(jsonLines[0]));
+    ctest_free_suite(&suite);
+    return ok;
+}
+
+size_t benchIterationCount = 0;
+
+CTEST_BENCH(bench1) {
+    char buffer[64] = { 0 };
+    state->bytes_per_iteration = sizeof(buffer);
+    ctest_bench_reset_timer(state);
+    for (size_t i = 0; i < state->iterations; ++i) {
+        buffer[i % sizeof(buffer)] = (char)i;
+        CTEST_DO_NOT_OPTIMIZE(buffer);
+        ++benchIterationCount;
+    }
+}
+
+static bool skip_all_benches(CTest_Bench const* bench, void* user) {
+    (void)bench;
+    (void)user;
+    return false;
+}
+
+static void linear_scaling_bench(CTest_BenchState* state) {
+    for (size_t i = 0; i < state->iterations; ++i) {
+        for (size_t j = 0; j < state->size; ++j) CTEST_DO_NOT_OPTIMIZE(j);
+    }
+}
+
+static void quadratic_scaling_bench(CTest_BenchState* state) {
+    for (size_t i = 0; i < state->iterations; ++i) {
+        for (size_t j = 0; j < state->size; ++j) {
+            for (size_t k = 0; k < state->size; ++k) CTEST_DO_NOT_OPTIMIZE(k);
+        }
+    }
+}
+
+static void linear_within_n_log_n_case(void) { CTEST_ASSERT_COMPLEXITY(linear_scaling_bench, CTEST_COMPLEXITY_N_LOG_N); }
+static void quadratic_within_n_log_n_case(void) { CTEST_ASSERT_COMPLEXITY(quadratic_scaling_bench, CTEST_COMPLEXITY_N_LOG_N); }
+
+static bool check_complexity(void) {
+    // Exact curves are fitted to their own class
+    size_t sizes[8];
+    double times[8];
+    for (size_t c = 0; c < CTEST_COMPLEXITY_COUNT; ++c) {
+        for (size_t i = 0; i < 8; ++i) {
+            sizes[i] = (size_t)16 << i;
+            double n = (double)sizes[i];
+            double logN = 0;
+            for (size_t m = sizes[i]; m > 1; m /= 2) logN += 0.69314718055994530942;
+            double const terms[CTEST_COMPLEXITY_COUNT] = { 1, logN, n, n * logN, n * n };
+            times[i] = 3e-9 * terms[c];
+        }
+        CTest_ComplexityFit fit = ctest_fit_complexity(sizes, times, 8);
+        if (fit.complexity != (CTest_Complexity)c || fit.rms[c] > 1e-9) {
+            printf("expected %s times to fit %s, but got %s\n", ctest_complexity_name((CTest_Complexity)c), ctest_complexity_name((CTest_Complexity)c), ctest_complexity_name(fit.complexity));
+            return false;
+        }
+        if (fit.coefficients[c] < 2.99e-9 || fit.coefficients[c] > 3.01e-9) {
+            printf("expected a coefficient of 3e-9 for %s, but got %g\n", ctest_complexity_name((CTest_Complexity)c), fit.coefficients[c]);
+            return false;
+        }
+    }
+
+    // Measured benchmarks are checked against their bound, the quadratic one fails its case
+    CTest_Suite suite = { 0 };
+    ctest_register_case(&suite, (CTest_Case){ .name = "linear_within_n_log_n", .test_fn = linear_within_n_log_n_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "quadratic_within_n_log_n", .test_fn = quadratic_within_n_log_n_case });
+    CTest_Report report = ctest_run_suite(suite, (CTest_Filter){ 0 });
+    bool linearPassed = report.passing.length == 1 && report.passing.cases[0].test_case->test_fn == linear_within_n_log_n_case;
+    bool quadraticFailed = report.failing.length == 1 && report.failing.cases[0].test_case->test_fn == quadratic_within_n_log_n_case;
+    ctest_free_report(&report);
+    ctest_free_suite(&suite);
+    if (!linearPassed || !quadraticFailed) {
+        CTest_Bench linear = { .name = "linear", .bench_fn = linear_scaling_bench };
+        CTest_Bench quadratic = { .name = "quadratic", .bench_fn = quadratic_scaling_bench };
+        ctest_print_complexity_fit(linear.name, ctest_measure_complexity(&linear, (CTest_ComplexityOptions){ 0 }));
+        ctest_print_complexity_fit(quadratic.name, ctest_measure_complexity(&quadratic, (CTest_ComplexityOptions){ 0 }));
+        puts("expected the linear benchmark to pass an O(n log n) bound and the quadratic one to fail it");
+        return false;
+    }
+    return true;
+}
+
+static size_t fuzzedInputCount = 0;
+
+static void counting_fuzz_target(uint8_t const* data, size_t size) {
+    (void)data;
+    (void)size;
+    ++fuzzedInputCount;
+}
+
+// Fails on inputs containing the dictionary token, which random bytes alone would rarely produce
+static void token_fuzz_target(uint8_t const* data, size_t size) {
+    for (size_t i = 0; i + 3 <= size; ++i) {
+        CTEST_ASSERT_TRUE(data[i] != 'F' || data[i + 1] != 'U' || data[i + 2] != 'Z');
+    }
+}
+
+static void slow_fuzz_target(uint8_t const* data, size_t size) {
+    if (size == 0 || data[0] < 0xf0) return;
+    double start = ctest_now();
+    while (ctest_now() - start < 0.02) {}
+}
+
+#ifdef __CTEST_POSIX
+static void aborting_fuzz_target(uint8_t const* data, size_t size) {
+    (void)data;
+    if (size > 0) abort();
+}
+
+// Fuzzes a target that aborts in a child process, which has to write the input from the crash handler and die of the abort
+static bool check_fuzz_crash(void) {
+    int errorPipe[2];
+    if (pipe(errorPipe) != 0) return false;
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        close(errorPipe[0]);
+        dup2(errorPipe[1], STDERR_FILENO);
+        CTest_FuzzTarget aborting = { .name = "aborting", .fuzz_fn = aborting_fuzz_target };
+        ctest_fuzz(&aborting, (CTest_FuzzOptions){ .runs = 100, .seed = 1 });
+        _exit(0);
+    }
+    close(errorPipe[1]);
+    char output[8192];
+    size_t outputLength = 0;
+    ssize_t readCount;
+    while ((readCount = read(errorPipe[0], output + outputLength, sizeof(output) - 1 - outputLength)) > 0) outputLength += (size_t)readCount;
+    output[outputLength] = '\0';
+    close(errorPipe[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+    // The artifact path is printed between these
+    char const* pathStart = strstr(output, "Input written to ");
+    char const* pathEnd = (pathStart != NULL) ? strstr(pathStart, ", reproduce with") : NULL;
+    bool ok = WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT
+           && strstr(output, "Fuzz target aborting crashed with signal ") != NULL
+           && pathEnd != NULL;
+    if (ok) {
+        pathStart += strlen("Input written to ");
+        char path[1024];
+        size_t pathLength = (size_t)(pathEnd - pathStart);
+        ok = pathLength < sizeof(path);
+        if (ok) {
+            memcpy(path, pathStart, pathLength);
+            path[pathLength] = '\0';
+            uint8_t* written;
+            size_t writtenSize;
+            ok = ctest_read_fuzz_input(path, &written, &writtenSize) && writtenSize > 0;
+            if (ok) CTEST_FREE(written);
+            remove(path);
+        }
+    }
+    if (!ok) printf("expected the crash handler to report and write the aborting input, but got:\n%s\n", output);
+    return ok;
+}
+#endif
+
+// Asserts after fuzzing, which has to fail this case instead of the whole runner
+static void failing_after_fuzzing_case(void) {
+    CTest_FuzzTarget counting = { .name = "counting", .fuzz_fn = counting_fuzz_target };
+    CTest_FuzzResult result = ctest_fuzz(&counting, (CTest_FuzzOptions){ .runs = 100, .seed = 1 });
+    ctest_free_fuzz_result(&result);
+    CTEST_ASSERT_TRUE(result.runs == 0);
+}
+
+static bool check_fuzzing(void) {
+    // No targets are registered in this file, the ones used here are collected in a suite of their own
+    if (ctest_get_fuzz_suite().length != 0) {
+        puts("expected no registered fuzz targets");
+        return false;
+    }
+    CTest_FuzzSuite fuzzSuite = { 0 };
+    ctest_register_fuzz_target(&fuzzSuite, (CTest_FuzzTarget){ .name = "counting", .fuzz_fn = counting_fuzz_target });
+    CTest_FuzzTarget counting = fuzzSuite.targets[0];
+    ctest_free_fuzz_suite(&fuzzSuite);
+
+    // A passing target runs exactly the requested number of inputs
+    CTest_FuzzResult result = ctest_fuzz(&counting, (CTest_FuzzOptions){ .runs = 500, .seed = 1 });
+    bool ok = !result.failed && !result.slow && result.runs == 500 && fuzzedInputCount == 500 && result.input == NULL;
+    ctest_free_fuzz_result(&result);
+    if (!ok) {
+        printf("expected 500 passing fuzz runs, but ran %zu\n", fuzzedInputCount);
+        return false;
+    }
+
+    // Fuzzing inside a case keeps the context of the case
+    CTest_Suite suite = { 0 };
+    ctest_register_case(&suite, (CTest_Case){ .name = "failing_after_fuzzing", .test_fn = failing_after_fuzzing_case });
+    CTest_Report report = ctest_run_suite(suite, (CTest_Filter){ 0 });
+    ok = report.failing.length == 1 && report.failing.cases[0].fail_info.line > 0;
+    ctest_free_report(&report);
+    ctest_free_suite(&suite);
+    if (!ok) {
+        puts("expected an assertion after fuzzing to fail its case");
+        return false;
+    }
+
+    // The failing input is found with the dictionary, written as an artifact and reproduces the failure
+    char const* dictionary[] = { "FUZ" };
+    CTest_FuzzTarget token = { .name = "token", .fuzz_fn = token_fuzz_target };
+    result = ctest_fuzz(&token, (CTest_FuzzOptions){ .runs = 100000, .seed = 1, .dictionary = dictionary, .dictionary_length = 1 });
+    if (!result.failed || result.input == NULL || result.artifact_path == NULL) {
+        printf("expected the fuzzer to find the failing token in %zu runs\n", result.runs);
+        ctest_free_fuzz_result(&result);
+        return false;
+    }
+    puts("Sample output of a failed fuzzing run:");
+    ctest_print_fuzz_result(result);
+    uint8_t* written;
+    size_t writtenSize;
+    ok = ctest_read_fuzz_input(result.artifact_path, &written, &writtenSize)
+      && writtenSize == result.input_size
+      && memcmp(written, result.input, writtenSize) == 0
+      && !ctest_run_fuzz_input(&token, written, writtenSize).passed;
+    CTEST_FREE(written);
+    remove(result.artifact_path);
+    ctest_free_fuzz_result(&result);
+    if (!ok) {
+        puts("expected the written fuzz artifact to reproduce the failure");
+        return false;
+    }
+
+    // Inputs slower than the timeout end the run
+    CTest_FuzzTarget slow = { .name = "slow", .fuzz_fn = slow_fuzz_target };
+    result = ctest_fuzz(&slow, (CTest_FuzzOptions){ .runs = 100000, .seed = 1, .input_timeout = 0.01 });
+    ok = result.slow && !result.failed && result.input_size > 0 && result.input[0] >= 0xf0 && result.artifact_path != NULL;
+    if (result.artifact_path != NULL) remove(result.artifact_path);
+    ctest_free_fuzz_result(&result);
+    if (!ok) {
+        puts("expected the fuzzer to report the slow input");
+        return false;
+    }
+#ifdef __CTEST_POSIX
+    if (!check_fuzz_crash()) return false;
+#endif
+    return true;
+}
+
+static bool check_bench_comparison(void) {
+    double baseline[20], same[20], slower[20], faster[20], noisy[20];
+    for (size_t i = 0; i < 20; ++i) {
+        // Some spread, with an outlier
+        baseline[i] = 100.0 + (double)(i * 7 % 11) + ((i == 3) ? 50.0 : 0.0);
+        same[i] = 100.0 + (double)(i * 5 % 11);
+        slower[i] = baseline[i] * 1.3;
+        faster[i] = baseline[i] * 0.7;
+        // Slower median, but within the spread of the baseline
+        noisy[i] = 101.0 + (double)(i * 3 % 11);
+    }
+    CTest_BenchComparison comparison = ctest_compare_bench(baseline, 20, same, 20, (CTest_BenchCompareOptions){ 0 });
+    if (comparison.regressed || comparison.improved || comparison.p_value < 0.05) {
+        printf("expected no change between equal distributions, but p = %g\n", comparison.p_value);
+        return false;
+    }
+    comparison = ctest_compare_bench(baseline, 20, slower, 20, (CTest_BenchCompareOptions){ 0 });
+    if (!comparison.regressed || comparison.p_value > 0.001 || comparison.change < 0.25) {
+        printf("expected a regression, but p = %g and change = %g\n", comparison.p_value, comparison.change);
+        return false;
+    }
+    comparison = ctest_compare_bench(baseline, 20, faster, 20, (CTest_BenchCompareOptions){ 0 });
+    if (!comparison.improved || comparison.regressed) {
+        puts("expected an improvement");
+        return false;
+    }
+    comparison = ctest_compare_bench(baseline, 20, noisy, 20, (CTest_BenchCompareOptions){ .threshold = 0.001 });
+    if (comparison.regressed) {
+        printf("expected a change within the noise not to be a regression, but p = %g\n", comparison.p_value);
+        return false;
+    }
+    // A large threshold lets significant changes through
+    comparison = ctest_compare_bench(baseline, 20, slower, 20, (CTest_BenchCompareOptions){ .threshold = 0.5 });
+    if (comparison.regressed) {
+        puts("expected a change below the threshold not to be a regression");
+        return false;
+    }
+    return true;
+}
+
+static bool check_benches(void) {
+    CTest_BenchSuite suite = ctest_get_bench_suite();
+    if (suite.length != 1 || strcmp(suite.benches[0].name, "bench1") != 0) {
+        printf("expected only bench1 in the benchmark suite, but found %zu benchmark(s)\n", suite.length);
+        return false;
+    }
+
+    CTest_BenchOptions options = { .min_sample_time = 0.001, .samples = 5, .warmup_samples = 1 };
+    CTest_BenchReport report = ctest_run_bench_suite(suite, (CTest_BenchFilter){ 0 }, options);
+    if (report.length != 1) {
+        printf("expected 1 benchmark result, but got %zu\n", report.length);
+        return false;
+    }
+    CTest_BenchResult result = report.results[0];
+    if (result.samples != 5 || result.iterations == 0 || benchIterationCount < (options.samples + options.warmup_samples) * result.iterations) {
+        printf("benchmark ran %zu iterations, which does not cover %zu samples of %zu iterations\n", benchIterationCount, result.samples, result.iterations);
+        return false;
+    }
+    if (!(result.min > 0 && result.min <= result.median && result.median <= result.p99 && result.p99 <= result.max
+        && result.min <= result.mean && result.mean <= result.max && result.stddev >= 0)) {
+        puts("benchmark statistics are inconsistent");
+        return false;
+    }
+    double expectedBytesPerSecond = result.ops_per_second * 64;
+    if (result.bytes_per_second < expectedBytesPerSecond * 0.999 || result.bytes_per_second > expectedBytesPerSecond * 1.001) {
+        puts("expected the throughput in bytes to follow the bytes per iteration");
+        return false;
+    }
+    puts("Sample output of a benchmark report:");
+    ctest_print_bench_report(report);
+
+    // Results survive a round trip through a baseline, and compare equal to themselves
+    char const* baselinePath = "ctest_self_test_baseline.csv";
+    CTest_BenchBaseline baseline;
+    bool roundTripped = ctest_write_bench_baseline(report, baselinePath) && ctest_read_bench_baseline(baselinePath, &baseline);
+    remove(baselinePath);
+    if (!roundTripped || baseline.length != 1 || strcmp(baseline.entries[0].name, "bench1") != 0 || baseline.entries[0].samples != result.samples
+        || memcmp(baseline.entries[0].sample_times, report.results[0].sample_times, result.samples * sizeof(double)) != 0) {
+        puts("expected the benchmark results to survive a round trip through a baseline");
+        return false;
+    }
+    if (ctest_print_bench_comparison(report, baseline, (CTest_BenchCompareOptions){ 0 }) != 0) {
+        puts("expected no regression against the same results");
+        return false;
+    }
+    ctest_free_bench_baseline(&baseline);
+    ctest_free_bench_report(&report);
+
+    // Malformed lines fail the read, without touching entries that were never parsed
+    char const* malformedLines[] = { "no comma at all\n", ",starts with a comma\n", "bench1,no samples,\n" };
+    for (size_t i = 0; i < sizeof(malformedLines) / sizeof(malformedLines[0]); ++i) {
+        FILE* file = fopen(baselinePath, "w");
+        if (file == NULL) {
+            puts("failed to create a malformed baseline file");
+            return false;
+        }
+        fputs("name,samples\n", file);
+        fputs(malformedLines[i], file);
+        fclose(file);
+        bool read = ctest_read_bench_baseline(baselinePath, &baseline);
+        remove(baselinePath);
+        ctest_free_bench_baseline(&baseline);
+        if (read) {
+            printf("expected the baseline line '%.*s' to fail the read\n", (int)(strlen(malformedLines[i]) - 1), malformedLines[i]);
+            return false;
+        }
+    }
+
+    // Counters are only collected if asked for, and at least the software ones are always there
+    for (size_t i = 0; i < CTEST_COUNTER_COUNT; ++i) {
+        if (result.counter_available[i]) {
+            puts("expected no counters without the counters option");
+            return false;
+        }
+    }
+    options.counters = true;
+    report = ctest_run_bench_suite(suite, (CTest_BenchFilter){ 0 }, options);
+    result = report.results[0];
+    if (!result.counter_available[CTEST_COUNTER_TASK_CLOCK] || result.counters[CTEST_COUNTER_TASK_CLOCK] <= 0) {
+        puts("expected the task-clock counter to be collected");
+        return false;
+    }
+    if (result.counter_available[CTEST_COUNTER_INSTRUCTIONS] && result.counters[CTEST_COUNTER_INSTRUCTIONS] <= 0) {
+        puts("expected the benchmark to retire instructions");
+        return false;
+    }
+    puts("Sample output of a benchmark report with counters:");
+    ctest_print_bench_report(report);
+    ctest_free_bench_report(&report);
+    options.counters = false;
+
+    // Filtered benchmarks do not run
+    benchIterationCount = 0;
+    report = ctest_run_bench_suite(suite, (CTest_BenchFilter){ .filter_fn = skip_all_benches }, options);
+    if (report.length != 0 || benchIterationCount != 0) {
+        puts("expected the filtered benchmark not to run");
+        return false;
+    }
+    ctest_free_bench_report(&report);
+    ctest_free_bench_suite(&suite);
+    return true;
+}
+
 CTest_Case const* find_test_case_in_suite_by_function(CTest_Suite suite, void(*testFn)(void)) {
     for (size_t i = 0; i < suite.length; ++i) {
         if (suite.cases[i].test_fn == testFn) return &suite.cases[i];
@@ -544,6 +4460,181 @@ CTest_Execution* find_test_execution_in_report_by_function(CTest_Report report,
     return NULL;
 }
 
+static void allocating_case(void) {
+    void* a = ctest_counting_realloc(NULL, NULL, 16);
+    void* b = ctest_counting_realloc(NULL, NULL, 32);
+    a = ctest_counting_realloc(NULL, a, 64);
+    ctest_counting_free(NULL, b);
+    // Leaks 64 bytes in a
+    (void)a;
+}
+
+static void allocations_within_limit_case(void) {
+    void* setup = ctest_counting_realloc(NULL, NULL, 100);
+    // Only what comes after the reset is checked
+    ctest_reset_alloc_stats();
+    void* block = ctest_counting_realloc(NULL, NULL, 8);
+    ctest_counting_free(NULL, block);
+    CTEST_ASSERT_ALLOCATIONS_AT_MOST(1);
+    CTEST_ASSERT_PEAK_BYTES_AT_MOST(108);
+    ctest_counting_free(NULL, setup);
+    CTEST_ASSERT_NO_LEAKS();
+}
+
+static void too_many_allocations_case(void) {
+    void* block = ctest_counting_realloc(NULL, NULL, 8);
+    block = ctest_counting_realloc(NULL, block, 16);
+    ctest_counting_free(NULL, block);
+    CTEST_ASSERT_ALLOCATIONS_AT_MOST(1);
+}
+
+static void leaking_case(void) {
+    void* block = ctest_counting_realloc(NULL, NULL, 8);
+    (void)block;
+    CTEST_ASSERT_NO_LEAKS();
+}
+
+static bool check_alloc_stats(CTest_AllocStats got, CTest_AllocStats expected) {
+    if (memcmp(&got, &expected, sizeof(CTest_AllocStats)) != 0) {
+        printf("unexpected allocation statistics: %zu allocations, %zu reallocations, %zu frees, %zu bytes allocated, %zu live bytes, %zu peak bytes, %zu live blocks\n",
+            got.allocations, got.reallocations, got.frees, got.allocated_bytes, got.live_bytes, got.peak_bytes, got.live_blocks);
+        return false;
+    }
+    return true;
+}
+
+static bool check_allocation_counting(void) {
+    CTest_Suite suite = { 0 };
+    ctest_register_case(&suite, (CTest_Case){ .name = "allocating", .test_fn = allocating_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "allocations_within_limit", .test_fn = allocations_within_limit_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "too_many_allocations", .test_fn = too_many_allocations_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "leaking", .test_fn = leaking_case });
+    // In a process, so the leaks don't stay around, and the statistics have to be sent back
+    CTest_Options options = { 0 };
+#ifdef __CTEST_POSIX
+    options.jobs = 2;
+#endif
+    CTest_Report report = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, options);
+    bool ok = true;
+    if (report.passing.length != 2 || report.failing.length != 2) {
+        puts("expected the cases over the allocation limits to fail");
+        ok = false;
+    }
+    ok = ok && check_alloc_stats(find_test_execution_in_report_by_function(report, allocating_case)->alloc_stats, (CTest_AllocStats){
+        .allocations = 2,
+        .reallocations = 1,
+        .frees = 1,
+        .allocated_bytes = 16 + 32 + 64,
+        .live_bytes = 64,
+        .peak_bytes = 96,
+        .live_blocks = 1,
+    });
+    ok = ok && strcmp(find_test_execution_in_report_by_function(report, too_many_allocations_case)->fail_info.message, "expected at most 1 allocations") == 0;
+    ok = ok && strcmp(find_test_execution_in_report_by_function(report, leaking_case)->fail_info.message, "expected every allocated block to be freed") == 0;
+    if (!ok) puts("allocation counting failed");
+    ctest_free_report(&report);
+    ctest_free_suite(&suite);
+
+    // Explicit statistics also count outside of cases
+    CTest_AllocStats stats = { 0 };
+    void* block = ctest_counting_realloc(&stats, NULL, 10);
+    ctest_counting_free(&stats, block);
+    ok = ok && check_alloc_stats(stats, (CTest_AllocStats){ .allocations = 1, .frees = 1, .allocated_bytes = 10, .peak_bytes = 10 });
+    return ok;
+}
+
+#ifdef __CTEST_POSIX
+
+// These are not registered, they run in a suite of their own
+static void process_passing_case(void) {}
+static void process_failing_case(void) { CTEST_ASSERT_FAIL("failed in a process"); }
+static void process_crashing_case(void) { abort(); }
+static void process_exiting_case(void) { exit(3); }
+static void process_hanging_case(void) {
+    volatile bool spin = true;
+    while (spin) {}
+}
+static void process_expected_exit_case(void) { exit(1); }
+static size_t inProcessRunCount = 0;
+static void in_process_case(void) { ++inProcessRunCount; }
+
+static bool check_process_execution(CTest_Report report, void(*testFn)(void), bool shouldPass, char const* messagePart) {
+    CTest_Execution* execution = find_test_execution_in_report_by_function(report, testFn);
+    if (execution == NULL) {
+        puts("could not find execution of process case in report");
+        return false;
+    }
+    if (execution->passed != shouldPass) {
+        printf("expected process case %s to %s\n", execution->test_case->name, shouldPass ? "pass" : "fail");
+        return false;
+    }
+    if (messagePart != NULL && (execution->fail_info.message == NULL || strstr(execution->fail_info.message, messagePart) == NULL)) {
+        printf("expected failure message of process case %s to contain '%s', but it was '%s'\n",
+            execution->test_case->name, messagePart, execution->fail_info.message == NULL ? "" : execution->fail_info.message);
+        return false;
+    }
+    return true;
+}
+
+static bool check_cases_in_processes(CTest_Suite registeredSuite) {
+    // The registered cases should have the same outcome in processes
+    CTest_Report report = ctest_run_suite_with_options(registeredSuite, (CTest_Filter){ 0 }, (CTest_Options){ .jobs = 2 });
+    for (size_t i = 0; i < sizeof(expectedCases) / sizeof(ExpectedTestCase); ++i) {
+        if (!check_process_execution(report, expectedCases[i].test_fn, expectedCases[i].shouldPass, NULL)) return false;
+    }
+    if (!check_process_execution(report, case2, false, "custom fail message")) return false;
+    // Results are reported in the order of the suite
+    if (report.failing.length != 2 || report.failing.cases[0].test_case->test_fn != case2 || report.failing.cases[1].test_case->test_fn != case5) {
+        puts("expected failing cases in the order of the suite");
+        return false;
+    }
+    ctest_free_report(&report);
+
+    CTest_Suite suite = { 0 };
+    // A timeout that does not fit the milliseconds of poll is clamped
+    ctest_register_case(&suite, (CTest_Case){ .name = "passing", .test_fn = process_passing_case, .timeout = 1e12 });
+    ctest_register_case(&suite, (CTest_Case){ .name = "failing", .test_fn = process_failing_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "crashing", .test_fn = process_crashing_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "exiting", .test_fn = process_exiting_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "hanging", .test_fn = process_hanging_case });
+    ctest_register_case(&suite, (CTest_Case){ .name = "expected_exit", .test_fn = process_expected_exit_case, .should_fail = true });
+    report = ctest_run_suite_with_options(suite, (CTest_Filter){ 0 }, (CTest_Options){ .jobs = 3, .timeout = 0.5 });
+    bool ok = check_process_execution(report, process_passing_case, true, NULL)
+           && check_process_execution(report, process_failing_case, false, "failed in a process")
+           && check_process_execution(report, process_crashing_case, false, "SIGABRT")
+           && check_process_execution(report, process_exiting_case, false, "exited with code 3")
+           && check_process_execution(report, process_hanging_case, false, "timed out")
+           && check_process_execution(report, process_expected_exit_case, true, "exited with code 1");
+    if (ok && report.passing.length + report.failing.length != suite.length) {
+        puts("expected every process case to be reported exactly once");
+        ok = false;
+    }
+    ctest_free_report(&report);
+    ctest_free_suite(&suite);
+    if (!ok) return false;
+
+    // A timeout of the case is enforced in a process, even if the run does not use processes, the other cases still run in-process
+    suite = (CTest_Suite){ 0 };
+    ctest_register_case(&suite, (CTest_Case){ .name = "hanging", .test_fn = process_hanging_case, .timeout = 0.2 });
+    ctest_register_case(&suite, (CTest_Case){ .name = "in_process", .test_fn = in_process_case });
+    inProcessRunCount = 0;
+    report = ctest_run_suite(suite, (CTest_Filter){ 0 });
+    ok = check_process_execution(report, process_hanging_case, false, "timed out after 0.2 seconds");
+    if (ok && (inProcessRunCount != 1 || report.passing.length != 1)) {
+        printf("expected the case without a timeout to run in-process, but it ran %zu time(s) here\n", inProcessRunCount);
+        ok = false;
+    }
+    if (ok && report.failing.cases[0].wall_time < 0.2) {
+        printf("expected the timed out case to take at least its timeout, but it took %g seconds\n", report.failing.cases[0].wall_time);
+        ok = false;
+    }
+    ctest_free_report(&report);
+    ctest_free_suite(&suite);
+    return ok;
+}
+
+#endif /* __CTEST_POSIX */
+
 int main(void) {
     puts("Running CTEST self-test...");
 
@@ -601,8 +4692,22 @@ int main(void) {
     ctest_print_report(report);
 
     ctest_free_report(&report);
+
+#ifdef __CTEST_POSIX
+    if (!check_cases_in_processes(suite)) return 1;
+#endif
+
     ctest_free_suite(&suite);
 
+    if (!check_case_timing()) return 1;
+    if (!check_case_selection()) return 1;
+    if (!check_reporters()) return 1;
+    if (!check_allocation_counting()) return 1;
+    if (!check_benches()) return 1;
+    if (!check_bench_comparison()) return 1;
+    if (!check_complexity()) return 1;
+    if (!check_fuzzing()) return 1;
+
     puts("Self-test completed successfully!");
     return 0;
 }
@@ -654,4 +4759,14 @@ CTEST_CASE(factorial_of_negative, .should_fail = true) {
     factorial(-1);
 }
 
+// Benchmark code //////////////////////////////////////////////////////////////
+
+// Run with --bench to measure this instead of running the tests
+CTEST_BENCH(factorial_of_ten) {
+    for (size_t i = 0; i < state->iterations; ++i) {
+        int result = factorial(10);
+        CTEST_DO_NOT_OPTIMIZE(result);
+    }
+}
+
 #endif /* CTEST_EXAMPLE */
@@ -174,6 +174,10 @@ typedef struct Json_Value {
             struct Json_HashBucket* buckets;
             size_t buckets_length;
             size_t entry_count;
+            // The position of the entry last found by index, so visiting the entries in order does not rescan the buckets
+            size_t cursor_index;
+            size_t cursor_bucket;
+            size_t cursor_entry;
             Json_Allocator allocator;
         } object;
     } value;
@@ -329,6 +333,7 @@ JSON_DEF Json_Value* json_object_get(Json_Value* object, char const* key);
  * @param out_key A pointer to a char* variable that will receive the key string. The library retains ownership of the key string, so the caller should not free it.
  * @param out_value A pointer to a Json_Value variable that will receive the value. The library retains ownership of the value, so the caller should not free it.
  * @returns true if a key-value pair exists at the specified index and was retrieved successfully, or false if the index is out of bounds.
+ * Visiting the entries in increasing index order takes amortized constant time per call, as long as the object is not modified in between.
  */
 JSON_DEF bool json_object_get_at(Json_Value* object, size_t index, char const** out_key, Json_Value* out_value);
 
@@ -961,7 +966,8 @@ static void json_parse_number_value(Json_Parser* parser) {
         while (true) {
             char c = json_parser_peek(parser, parserOffset, '\0');
             if (!isdigit((unsigned char)c)) break;
-            exponent = exponent * 10 + (c - '0');
+            // Any exponent past this over- or underflows a double anyway, saturating avoids overflowing the int and looping for ages
+            if (exponent < 10000) exponent = exponent * 10 + (c - '0');
             ++parserOffset;
         }
         // Check that we have at least one digit in the exponent
@@ -1446,6 +1452,13 @@ static double json_hash_table_load_factor(Json_Value* value) {
     return (double)value->value.object.entry_count / (double)value->value.object.buckets_length;
 }
 
+// Moves the index cursor back to the first entry, needed whenever entries are added, removed or moved between buckets
+static void json_object_reset_cursor(Json_Value* object) {
+    object->value.object.cursor_index = 0;
+    object->value.object.cursor_bucket = 0;
+    object->value.object.cursor_entry = 0;
+}
+
 static void json_hash_table_resize(Json_Value* value, size_t newBucketCount) {
     Json_Allocator* allocator = &value->value.object.allocator;
     JSON_ASSERT(value->type == JSON_VALUE_OBJECT, "attempted to resize hash table on non-object value");
@@ -1467,6 +1480,7 @@ static void json_hash_table_resize(Json_Value* value, size_t newBucketCount) {
     json_free(allocator, value->value.object.buckets);
     value->value.object.buckets = newBuckets;
     value->value.object.buckets_length = newBucketCount;
+    json_object_reset_cursor(value);
 }
 
 static void json_hash_table_grow(Json_Value* value) {
@@ -1507,6 +1521,7 @@ void json_object_set(Json_Value* object, char const* key, Json_Value value) {
     JSON_ADD_TO_ARRAY(allocator, *bucket, newEntry);
     // New element was added
     ++object->value.object.entry_count;
+    json_object_reset_cursor(object);
 }
 
 Json_Value* json_object_get(Json_Value* object, char const* key) {
@@ -1528,19 +1543,33 @@ Json_Value* json_object_get(Json_Value* object, char const* key) {
 
 bool json_object_get_at(Json_Value* object, size_t index, char const** out_key, Json_Value* out_value) {
     JSON_ASSERT(object->type == JSON_VALUE_OBJECT, "attempted to get key-value pair by index on non-object value");
-    if (object->value.object.buckets_length == 0) return false;
-    size_t currentIndex = 0;
-    for (size_t i = 0; i < object->value.object.buckets_length; ++i) {
-        Json_HashBucket* bucket = &object->value.object.buckets[i];
-        for (size_t j = 0; j < bucket->length; ++j) {
-            if (currentIndex == index) {
-                Json_HashEntry* entry = &bucket->elements[j];
-                if (out_key != NULL) *out_key = entry->key;
-                if (out_value != NULL) *out_value = entry->value;
-                return true;
-            }
-            ++currentIndex;
+    if (index >= object->value.object.entry_count) return false;
+    // Continue from the last entry found, unless the wanted one comes before it
+    size_t currentIndex = object->value.object.cursor_index;
+    size_t bucketIndex = object->value.object.cursor_bucket;
+    size_t entryIndex = object->value.object.cursor_entry;
+    if (index < currentIndex) {
+        currentIndex = 0;
+        bucketIndex = 0;
+        entryIndex = 0;
+    }
+    for (; bucketIndex < object->value.object.buckets_length; ++bucketIndex, entryIndex = 0) {
+        Json_HashBucket* bucket = &object->value.object.buckets[bucketIndex];
+        if (entryIndex >= bucket->length) continue;
+        // Skip the rest of the bucket at once, if the wanted entry is not in it
+        size_t remaining = bucket->length - entryIndex;
+        if (index - currentIndex >= remaining) {
+            currentIndex += remaining;
+            continue;
         }
+        entryIndex += index - currentIndex;
+        object->value.object.cursor_index = index;
+        object->value.object.cursor_bucket = bucketIndex;
+        object->value.object.cursor_entry = entryIndex;
+        Json_HashEntry* entry = &bucket->elements[entryIndex];
+        if (out_key != NULL) *out_key = entry->key;
+        if (out_value != NULL) *out_value = entry->value;
+        return true;
     }
     return false;
 }
@@ -1565,6 +1594,7 @@ bool json_object_remove(Json_Value* object, char const* key, Json_Value* out_val
             memmove(&bucket->elements[i], &bucket->elements[i + 1], (bucket->length - i - 1) * sizeof(Json_HashEntry));
             --bucket->length;
             --object->value.object.entry_count;
+            json_object_reset_cursor(object);
             return true;
         }
     }
@@ -1716,6 +1746,12 @@ static void json_write_value(Json_Writer* writer, Json_Value value) {
         json_writer_appendn(writer, buffer, (size_t)length);
     } break;
     case JSON_VALUE_DOUBLE: {
+        // JSON has no infinities or NaNs, like JSON.stringify we write them as null, x - x is only non-zero for those
+        double difference = value.value.floating - value.value.floating;
+        if (difference != difference || difference != 0) {
+            json_writer_appendn(writer, "null", 4);
+            break;
+        }
         char buffer[32];
         int length = snprintf(buffer, sizeof(buffer), "%g", value.value.floating);
         JSON_ASSERT(length > 0 && (size_t)length < sizeof(buffer), "failed to write double value in JSON writer");
@@ -1838,6 +1874,7 @@ void json_free_value(Json_Value* value) {
         // NULL out in case it's shared somewhere
         value->value.object.buckets = NULL;
         value->value.object.buckets_length = 0;
+        json_object_reset_cursor(value);
     } break;
     default:
         // No resources to free for other types
@@ -2096,6 +2133,100 @@ CTEST_CASE(object_get_at_and_remove) {
     json_free_value(&obj);
 }
 
+CTEST_CASE(object_get_at_is_consistent_in_any_order) {
+    Json_Value obj = json_object(no_allocator);
+    char key[32];
+    for (int i = 0; i < 100; ++i) {
+        snprintf(key, sizeof(key), "key%d", i);
+        json_object_set(&obj, key, json_int(i));
+    }
+
+    // Forward and backward visits find the same entries
+    char const* forwardKeys[100];
+    for (size_t i = 0; i < 100; ++i) CTEST_ASSERT_TRUE(json_object_get_at(&obj, i, &forwardKeys[i], NULL));
+    CTEST_ASSERT_TRUE(!json_object_get_at(&obj, 100, NULL, NULL));
+    for (size_t i = 100; i-- > 0;) {
+        char const* backwardKey = NULL;
+        CTEST_ASSERT_TRUE(json_object_get_at(&obj, i, &backwardKey, NULL));
+        CTEST_ASSERT_TRUE(backwardKey == forwardKeys[i]);
+    }
+
+    // Modifying the object in the middle of a visit restarts the lookups from the current entries
+    CTEST_ASSERT_TRUE(json_object_get_at(&obj, 50, NULL, NULL));
+    for (int i = 0; i < 100; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        CTEST_ASSERT_TRUE(json_object_remove(&obj, key, NULL));
+    }
+    json_object_set(&obj, "extra", json_int(-1));
+    for (size_t i = 0; i < 51; ++i) {
+        char const* visitedKey = NULL;
+        Json_Value visitedValue;
+        CTEST_ASSERT_TRUE(json_object_get_at(&obj, i, &visitedKey, &visitedValue));
+        Json_Value* found = json_object_get(&obj, visitedKey);
+        CTEST_ASSERT_TRUE(found != NULL && json_as_int(found) == json_as_int(&visitedValue));
+    }
+    CTEST_ASSERT_TRUE(!json_object_get_at(&obj, 51, NULL, NULL));
+
+    json_free_value(&obj);
+}
+
+// The object the scaling benchmarks look up in, kept between their runs at the same size, so building and freeing it stays out of the timing
+static Json_Value benchObject;
+static size_t benchObjectSize = 0;
+
+static Json_Value* bench_object_with_keys(size_t count) {
+    if (benchObjectSize == count) return &benchObject;
+    if (benchObjectSize != 0) json_free_value(&benchObject);
+    benchObject = json_object(no_allocator);
+    benchObjectSize = count;
+    char key[32];
+    for (size_t i = 0; i < count; ++i) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        json_object_set(&benchObject, key, json_int((long long)i));
+    }
+    return &benchObject;
+}
+
+static void free_bench_object(void) {
+    if (benchObjectSize != 0) json_free_value(&benchObject);
+    benchObjectSize = 0;
+}
+
+static void object_get_at_last_bench(CTest_BenchState* state) {
+    Json_Value* obj = bench_object_with_keys(state->size);
+    ctest_bench_reset_timer(state);
+    for (size_t i = 0; i < state->iterations; ++i) {
+        // Going back to the first entry each time, so the lookup can't continue from the previous one
+        char const* key = NULL;
+        json_object_get_at(obj, 0, &key, NULL);
+        json_object_get_at(obj, state->size - 1, &key, NULL);
+        CTEST_DO_NOT_OPTIMIZE(key);
+    }
+}
+
+static void object_iterate_by_index_bench(CTest_BenchState* state) {
+    Json_Value* obj = bench_object_with_keys(state->size);
+    ctest_bench_reset_timer(state);
+    for (size_t i = 0; i < state->iterations; ++i) {
+        for (size_t j = 0; j < state->size; ++j) {
+            char const* key = NULL;
+            json_object_get_at(obj, j, &key, NULL);
+            CTEST_DO_NOT_OPTIMIZE(key);
+        }
+    }
+}
+
+CTEST_CASE(object_get_at_scales_linearly) {
+    CTEST_ASSERT_COMPLEXITY(object_get_at_last_bench, CTEST_COMPLEXITY_N);
+    free_bench_object();
+}
+
+CTEST_CASE(object_iteration_by_index_scales_linearly) {
+    // Each lookup continues from the previous one, rescanning the buckets from the start would make this quadratic
+    CTEST_ASSERT_COMPLEXITY(object_iterate_by_index_bench, CTEST_COMPLEXITY_N);
+    free_bench_object();
+}
+
 CTEST_CASE(array_at_and_remove) {
     Json_Value arr = json_array(no_allocator);
     json_array_append(&arr, json_int(10));
@@ -2270,6 +2401,60 @@ CTEST_CASE(write_roundtrip) {
     json_free_document(&doc2);
 }
 
+// The exponent overflowed and computing the power took seconds, then the infinity was written as invalid JSON
+CTEST_CASE(parse_number_with_huge_exponent) {
+    Json_Document doc = json_parse("[1e99999999999999, 1e-99999999999999]", (Json_Options){0});
+    ASSERT_NO_ERRORS(doc);
+    CTEST_ASSERT_TRUE(json_as_double(json_array_at(&doc.root, 0)) > 1e308);
+    CTEST_ASSERT_TRUE(json_as_double(json_array_at(&doc.root, 1)) == 0.0);
+    char* written = json_write(doc.root, (Json_Options){0}, NULL);
+    CTEST_ASSERT_TRUE(strcmp(written, "[null,0]") == 0);
+    free(written);
+    json_free_document(&doc);
+}
+
+// Fuzzing /////////////////////////////////////////////////////////////////////
+
+static char const* const json_fuzz_dictionary[] = { "null", "true", "false", "{", "}", "[", "]", ":", ",", "\"", "\\u", "-", "1e", "0." };
+
+// Whatever the parser accepts has to be written back into something it accepts again
+// Run with --fuzz json_parse_arbitrary_input to fuzz for longer
+CTEST_FUZZ(json_parse_arbitrary_input, data, size) {
+    char* text = (char*)malloc(size + 1);
+    CTEST_ASSERT_TRUE(text != NULL);
+    memcpy(text, data, size);
+    text[size] = '\0';
+    Json_Document doc = json_parse(text, (Json_Options){0});
+    free(text);
+    if (doc.errors.length == 0) {
+        char* written = json_write(doc.root, (Json_Options){0}, NULL);
+        Json_Document reparsed = json_parse(written, (Json_Options){0});
+        bool reparsedWithoutErrors = reparsed.errors.length == 0;
+        free(written);
+        json_free_document(&reparsed);
+        json_free_document(&doc);
+        CTEST_ASSERT_TRUE(reparsedWithoutErrors);
+        return;
+    }
+    json_free_document(&doc);
+}
+
+CTEST_CASE(parse_survives_fuzzing) {
+    CTest_FuzzTarget target = { .name = "json_parse_arbitrary_input", .fuzz_fn = json_parse_arbitrary_input };
+    CTest_FuzzOptions options = {
+        .runs = 5000,
+        .max_input_size = 256,
+        .seed = 1,
+        .dictionary = json_fuzz_dictionary,
+        .dictionary_length = sizeof(json_fuzz_dictionary) / sizeof(json_fuzz_dictionary[0]),
+    };
+    CTest_FuzzResult result = ctest_fuzz(&target, options);
+    if (result.failed || result.slow) ctest_print_fuzz_result(result);
+    bool passed = !result.failed && !result.slow;
+    ctest_free_fuzz_result(&result);
+    CTEST_ASSERT_TRUE(passed);
+}
+
 #endif /* JSON_SELF_TEST */
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -5,20 +5,28 @@
  *  - #define STRING_BUILDER_IMPLEMENTATION before including this header in exactly one source file to include the implementation section
  *  - #define STRING_BUILDER_STATIC before including this header to make all functions have internal linkage
  *  - #define STRING_BUILDER_ASSERT to use a custom assertion mechanism (by default it uses assert from the C standard library)
+ *  - #define STRING_BUILDER_NO_SIMD before including the implementation to disable the SSE2 fast paths and only use the portable ones
  *  - #define STRING_BUILDER_SELF_TEST before including this header to compile a self-test that verifies the library's functionality
  *  - #define STRING_BUILDER_EXAMPLE before including this header to compile a simple example that demonstrates how to use the library
+ *  - #define STRING_BUILDER_BENCHMARK before including this header to compile a benchmark program measuring the throughput and allocations of the builders
  *
  * StringBuilder API:
  *  - Use sb_puts, sb_putsn, sb_putc and sb_format to append content to the builder
+ *  - Use sb_join to append many strings with a separator, and sb_repeat, sb_repeatn and sb_repeatc to append repeated content
  *  - Use sb_insert, sb_insertn and sb_insertc to insert content at a specific position
  *  - Use sb_remove to remove a portion of the string, and sb_replace to replace all occurrences of a target string
  *  - Use sb_length to get the current length, and sb_char_at to access a character at a specific position
  *  - Use sb_contains and sb_containsc to check if the builder contains a string or character
  *  - Use sb_index_of and sb_index_ofc to find the position of a string or character (-1 if not found)
+ *  - Use sb_to_upper and sb_to_lower for ASCII case conversion, and sb_trim, sb_trim_start and sb_trim_end to remove whitespace
+ *  - Use sb_split to split the content on a delimiter into StringView slices of the buffer, without copying
+ *  - Use sb_utf8_validate, sb_utf8_length and sb_utf8_truncate to work with the content as UTF-8 encoded text
+ *  - Use sb_utf8_next to iterate the code points of the builder, and sb_utf8_putc to append an encoded code point
  *  - Use sb_to_cstr to get a heap-allocated C string with the current content of the builder, which must be freed by the caller
  *  - Use sb_clear to clear the content of the builder without freeing the allocated buffer
  *  - Use sb_free to free the memory allocated for the builder when it is no longer needed
  *  - Use the allocator field and SB_Allocator to customize memory allocation if needed
+ *  - Use the growth field and SB_GrowthPolicy to customize how the buffer grows, and the stats field to inspect its allocations
  *
  * CodeBuilder API:
  *  - Similar to StringBuilder but with automatic indentation at the start of lines, useful for code generation
@@ -27,9 +35,23 @@
  *  - Use code_builder_to_cstr and code_builder_free to get the result and clean up
  *  - Customize the indentation string by setting the indent_str field of CodeBuilder (defaults to 4 spaces if NULL)
  *
+ * StringInterner API:
+ *  - Deduplicates strings by mapping them to dense 32-bit ids, storing all bytes in large append-only chunks
+ *  - Use string_interner_intern and string_interner_internn to get the id of a string, adding it if it's not interned yet
+ *  - Use string_interner_find to look up the id of a string without adding it
+ *  - Use string_interner_get to get a view of an interned string by its id, the view stays valid until the interner is freed
+ *  - Use string_interner_count to get the number of interned strings and string_interner_free to clean up
+ *  - Customize the chunk size by setting the chunk_size field of StringInterner (defaults to 64 KiB if 0)
+ *
  * Check the example section at the end of this file for a full example.
  */
 
+// NOTE: We need this for mremap on Linux
+// and apparently we need this before any includes
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // Declaration section                                                        //
 ////////////////////////////////////////////////////////////////////////////////
@@ -39,6 +61,7 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef STRING_BUILDER_STATIC
     #define STRING_BUILDER_DEF static
@@ -66,6 +89,46 @@ typedef struct SB_Allocator {
     void(*free)(void* ctx, void* ptr);
 } SB_Allocator;
 
+/**
+ * A non-owning view of a string, not necessarily null-terminated.
+ */
+typedef struct StringView {
+    // The first character of the viewed string
+    char const* data;
+    // The length of the viewed string
+    size_t length;
+} StringView;
+
+/**
+ * Controls how the buffer of a string builder grows.
+ * The zero-initialized policy starts from 16 bytes and doubles the capacity without bounds.
+ */
+typedef struct SB_GrowthPolicy {
+    // The capacity of the first allocation, defaults to 16 if 0
+    size_t initial_capacity;
+    // The factor the capacity is multiplied with when growing, defaults to 2 if 0, must be greater than 1 otherwise
+    double factor;
+    // Once the capacity reaches this threshold, it grows linearly instead of by the factor, 0 disables linear growth
+    size_t linear_threshold;
+    // The amount the capacity grows by in linear mode, defaults to linear_threshold if 0
+    size_t linear_step;
+    // Once the capacity reaches this threshold, the buffer is moved into an anonymous memory mapping that grows in place with mremap,
+    // bypassing the allocator, 0 disables it (only supported on Linux, ignored elsewhere)
+    size_t mremap_threshold;
+} SB_GrowthPolicy;
+
+/**
+ * Allocation statistics of a string builder, kept across clears and frees.
+ */
+typedef struct SB_Stats {
+    // The number of times the buffer was allocated or reallocated
+    size_t reallocs;
+    // The number of bytes copied because the buffer moved during reallocation
+    size_t bytes_copied;
+    // The highest capacity the buffer ever had
+    size_t peak_capacity;
+} SB_Stats;
+
 /**
  * A simple dynamic string builder.
  */
@@ -78,6 +141,12 @@ typedef struct StringBuilder {
     size_t capacity;
     // Optional custom memory allocator
     SB_Allocator allocator;
+    // Optional growth policy
+    SB_GrowthPolicy growth;
+    // Allocation statistics, updated on each growth
+    SB_Stats stats;
+    // True, if the buffer is memory-mapped because of the mremap_threshold of the growth policy
+    bool buffer_mapped;
 } StringBuilder;
 
 /**
@@ -145,6 +214,43 @@ STRING_BUILDER_DEF void sb_format(StringBuilder* sb, char const* format, ...);
  */
 STRING_BUILDER_DEF void sb_vformat(StringBuilder* sb, char const* format, va_list args);
 
+/**
+ * Appends multiple strings to the builder, separated by the given separator.
+ * With lengths given, the total length is computed up front and the builder grows at most once.
+ * Without them, the strings are measured 256 at a time and the builder grows at most once per 256 strings.
+ * @param sb The string builder to append to.
+ * @param strings The strings to append.
+ * @param lengths The lengths of the strings to append, or NULL if all strings are null-terminated.
+ * @param count The number of strings to append.
+ * @param sep The null-terminated separator to put between the strings, or NULL for no separator.
+ */
+STRING_BUILDER_DEF void sb_join(StringBuilder* sb, char const* const* strings, size_t const* lengths, size_t count, char const* sep);
+
+/**
+ * Appends a null-terminated string to the builder repeatedly.
+ * @param sb The string builder to append to.
+ * @param str The null-terminated string to append.
+ * @param count The number of times to append the string.
+ */
+STRING_BUILDER_DEF void sb_repeat(StringBuilder* sb, char const* str, size_t count);
+
+/**
+ * Appends a string with the given length to the builder repeatedly.
+ * @param sb The string builder to append to.
+ * @param str The string to append, not necessarily null-terminated.
+ * @param n The length of the string to append.
+ * @param count The number of times to append the string.
+ */
+STRING_BUILDER_DEF void sb_repeatn(StringBuilder* sb, char const* str, size_t n, size_t count);
+
+/**
+ * Appends a single character to the builder repeatedly, useful for padding.
+ * @param sb The string builder to append to.
+ * @param c The character to append.
+ * @param count The number of times to append the character.
+ */
+STRING_BUILDER_DEF void sb_repeatc(StringBuilder* sb, char c, size_t count);
+
 /**
  * Inserts a null-terminated string at the specified position in the builder.
  * @param sb The string builder to insert into.
@@ -234,6 +340,87 @@ STRING_BUILDER_DEF int sb_index_of(StringBuilder* sb, char const* str);
  */
 STRING_BUILDER_DEF int sb_index_ofc(StringBuilder* sb, char c);
 
+/**
+ * Converts the ASCII letters in the builder to uppercase, leaving all other bytes untouched.
+ * @param sb The string builder to convert.
+ */
+STRING_BUILDER_DEF void sb_to_upper(StringBuilder* sb);
+
+/**
+ * Converts the ASCII letters in the builder to lowercase, leaving all other bytes untouched.
+ * @param sb The string builder to convert.
+ */
+STRING_BUILDER_DEF void sb_to_lower(StringBuilder* sb);
+
+/**
+ * Removes leading and trailing ASCII whitespace from the builder.
+ * @param sb The string builder to trim.
+ */
+STRING_BUILDER_DEF void sb_trim(StringBuilder* sb);
+
+/**
+ * Removes leading ASCII whitespace from the builder.
+ * @param sb The string builder to trim.
+ */
+STRING_BUILDER_DEF void sb_trim_start(StringBuilder* sb);
+
+/**
+ * Removes trailing ASCII whitespace from the builder.
+ * @param sb The string builder to trim.
+ */
+STRING_BUILDER_DEF void sb_trim_end(StringBuilder* sb);
+
+/**
+ * Splits the content of the builder on a delimiter character.
+ * The parts are views into the buffer of the builder, and stay valid until the builder is modified.
+ * Adjacent delimiters produce empty parts, and the content always splits into one more part than the number of delimiters.
+ * @param sb The string builder to split.
+ * @param delimiter The character to split on.
+ * @param parts The array to write the parts into, can be NULL if max_parts is 0.
+ * @param max_parts The maximum number of parts to write.
+ * @return The total number of parts, which can be more than max_parts.
+ */
+STRING_BUILDER_DEF size_t sb_split(StringBuilder* sb, char delimiter, StringView* parts, size_t max_parts);
+
+/**
+ * Checks if the content of the builder is well-formed UTF-8.
+ * Overlong encodings, surrogates and code points above U+10FFFF are rejected.
+ * @param sb The string builder to validate.
+ * @return true if the content is valid UTF-8, false otherwise.
+ */
+STRING_BUILDER_DEF bool sb_utf8_validate(StringBuilder* sb);
+
+/**
+ * Counts the code points in the builder, assuming its content is valid UTF-8.
+ * @param sb The string builder to count the code points of.
+ * @return The number of code points in the builder.
+ */
+STRING_BUILDER_DEF size_t sb_utf8_length(StringBuilder* sb);
+
+/**
+ * Truncates the builder to contain at most the given number of code points, never splitting a code point.
+ * @param sb The string builder to truncate.
+ * @param n The maximum number of code points to keep.
+ */
+STRING_BUILDER_DEF void sb_utf8_truncate(StringBuilder* sb, size_t n);
+
+/**
+ * Decodes the code point at the given byte position and advances the position past it.
+ * Invalid sequences decode as U+FFFD and advance the position by a single byte.
+ * @param sb The string builder to iterate.
+ * @param pos The byte position to decode at, gets advanced to the start of the next code point.
+ * @param codepoint The decoded code point gets written here.
+ * @return true if a code point was decoded, false if the end of the builder was reached.
+ */
+STRING_BUILDER_DEF bool sb_utf8_next(StringBuilder* sb, size_t* pos, uint32_t* codepoint);
+
+/**
+ * Appends a single code point to the builder, encoded as UTF-8.
+ * @param sb The string builder to append to.
+ * @param codepoint The code point to append, must not be a surrogate or above U+10FFFF.
+ */
+STRING_BUILDER_DEF void sb_utf8_putc(StringBuilder* sb, uint32_t codepoint);
+
 /**
  * Utility for building code with indentation, using an underlying string builder.
  * Useful for code generation where the goal is producing a somewhat nicely formatted output.
@@ -259,6 +446,84 @@ STRING_BUILDER_DEF void code_builder_vformat(CodeBuilder* cb, char const* format
 STRING_BUILDER_DEF void code_builder_indent(CodeBuilder* cb);
 STRING_BUILDER_DEF void code_builder_dedent(CodeBuilder* cb);
 
+/**
+ * Deduplicates strings by mapping each distinct string to a dense 32-bit id.
+ * All string bytes are stored in large append-only chunks, so interned strings never move.
+ */
+typedef struct StringInterner {
+    // The chunks storing the interned string bytes, each chunk is filled up to its capacity but never grown
+    StringBuilder* chunks;
+    // The number of chunks
+    size_t chunk_count;
+    // The capacity of the chunks array
+    size_t chunk_capacity;
+    // The size of a single chunk, defaults to 64 KiB if 0
+    size_t chunk_size;
+    // The interned strings, indexed by their id
+    StringView* strings;
+    // The hash codes of the interned strings, indexed by their id
+    uint32_t* hashes;
+    // The number of interned strings
+    size_t string_count;
+    // The capacity of the strings and hashes arrays
+    size_t string_capacity;
+    // The open-addressing index, each slot holds the id of a string plus one, or 0 if the slot is empty
+    uint32_t* slots;
+    // The number of slots in the index, always a power of 2
+    size_t slot_count;
+    // Optional custom memory allocator
+    SB_Allocator allocator;
+} StringInterner;
+
+/**
+ * Interns a null-terminated string, adding it to the interner if it's not interned yet.
+ * @param si The string interner to intern the string in.
+ * @param str The null-terminated string to intern.
+ * @return The id of the interned string.
+ */
+STRING_BUILDER_DEF uint32_t string_interner_intern(StringInterner* si, char const* str);
+
+/**
+ * Interns a string with the given length, adding it to the interner if it's not interned yet.
+ * @param si The string interner to intern the string in.
+ * @param str The string to intern, not necessarily null-terminated.
+ * @param n The length of the string to intern.
+ * @return The id of the interned string.
+ */
+STRING_BUILDER_DEF uint32_t string_interner_internn(StringInterner* si, char const* str, size_t n);
+
+/**
+ * Looks up the id of a string without interning it.
+ * @param si The string interner to search in.
+ * @param str The string to search for, not necessarily null-terminated.
+ * @param n The length of the string to search for.
+ * @param id The id of the string gets written here, if found. Can be NULL.
+ * @return true if the string is interned, false otherwise.
+ */
+STRING_BUILDER_DEF bool string_interner_find(StringInterner* si, char const* str, size_t n, uint32_t* id);
+
+/**
+ * Returns a view of the interned string with the given id.
+ * The viewed string is also null-terminated, and stays valid until the interner is freed.
+ * @param si The string interner to access.
+ * @param id The id of the interned string.
+ * @return A view of the interned string.
+ */
+STRING_BUILDER_DEF StringView string_interner_get(StringInterner* si, uint32_t id);
+
+/**
+ * Returns the number of distinct strings interned.
+ * @param si The string interner to get the count of.
+ * @return The number of interned strings.
+ */
+STRING_BUILDER_DEF size_t string_interner_count(StringInterner* si);
+
+/**
+ * Frees all memory allocated by the interner and resets its state.
+ * @param si The string interner to free.
+ */
+STRING_BUILDER_DEF void string_interner_free(StringInterner* si);
+
 #ifdef __cplusplus
 }
 #endif
@@ -276,6 +541,20 @@ STRING_BUILDER_DEF void code_builder_dedent(CodeBuilder* cb);
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+    // Only available with _GNU_SOURCE, which might have been missed if the user included system headers before us
+    #if defined(MREMAP_MAYMOVE) && defined(MAP_ANONYMOUS)
+        #define __STRING_BUILDER_MREMAP
+    #endif
+#endif
+
+#if !defined(STRING_BUILDER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define __STRING_BUILDER_SSE2
+    #include <emmintrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -313,17 +592,88 @@ static void sb_alloc_free(SB_Allocator* allocator, void* ptr) {
     allocator->free(allocator->context, ptr);
 }
 
+// Growth //////////////////////////////////////////////////////////////////////
+
+// Computes the capacity to grow to according to the growth policy, so that it's at least the required capacity
+static size_t sb_grow_capacity(StringBuilder* sb, size_t required) {
+    SB_GrowthPolicy* policy = &sb->growth;
+    double factor = (policy->factor == 0) ? 2.0 : policy->factor;
+    STRING_BUILDER_ASSERT(factor > 1, "growth factor must be greater than 1");
+    size_t capacity = sb->capacity;
+    if (capacity == 0) {
+        capacity = (policy->initial_capacity == 0) ? 16 : policy->initial_capacity;
+    }
+    while (capacity < required) {
+        if (policy->linear_threshold != 0 && capacity >= policy->linear_threshold) {
+            // Linear mode, jump straight to the first step that fits
+            size_t step = (policy->linear_step == 0) ? policy->linear_threshold : policy->linear_step;
+            capacity += (required - capacity + step - 1) / step * step;
+            break;
+        }
+        size_t next = (size_t)((double)capacity * factor);
+        if (next <= capacity) next = capacity + 1;
+        // Don't overshoot the threshold, linear growth takes over from there
+        if (policy->linear_threshold != 0 && capacity < policy->linear_threshold && next > policy->linear_threshold) {
+            next = policy->linear_threshold;
+        }
+        capacity = next;
+    }
+    return capacity;
+}
+
+static void sb_record_growth(StringBuilder* sb, size_t newCapacity, size_t copied) {
+    ++sb->stats.reallocs;
+    sb->stats.bytes_copied += copied;
+    if (newCapacity > sb->stats.peak_capacity) sb->stats.peak_capacity = newCapacity;
+}
+
+#ifdef __STRING_BUILDER_MREMAP
+static void sb_reserve_mapped(StringBuilder* sb, size_t capacity) {
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    capacity = (capacity + pageSize - 1) / pageSize * pageSize;
+    void* newBuffer;
+    size_t copied = 0;
+    if (sb->buffer_mapped) {
+        // The kernel moves the pages if needed, no copying involved
+        newBuffer = mremap(sb->buffer, sb->capacity, capacity, MREMAP_MAYMOVE);
+        STRING_BUILDER_ASSERT(newBuffer != MAP_FAILED, "failed to remap memory");
+    } else {
+        newBuffer = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        STRING_BUILDER_ASSERT(newBuffer != MAP_FAILED, "failed to map memory");
+        if (sb->buffer != NULL) {
+            memcpy(newBuffer, sb->buffer, sb->length);
+            copied = sb->length;
+            sb_alloc_free(&sb->allocator, sb->buffer);
+        }
+        sb->buffer_mapped = true;
+    }
+    sb->buffer = (char*)newBuffer;
+    sb->capacity = capacity;
+    sb_record_growth(sb, capacity, copied);
+}
+#endif
+
 // String builder //////////////////////////////////////////////////////////////
 
 void sb_reserve(StringBuilder* sb, size_t capacity) {
     if (capacity <= sb->capacity) return;
 
-    size_t newCapacity = (sb->capacity == 0) ? 16 : sb->capacity;
-    while (newCapacity < capacity) newCapacity *= 2;
+    size_t newCapacity = sb_grow_capacity(sb, capacity);
 
+#ifdef __STRING_BUILDER_MREMAP
+    if (sb->buffer_mapped || (sb->growth.mremap_threshold != 0 && newCapacity >= sb->growth.mremap_threshold)) {
+        sb_reserve_mapped(sb, newCapacity);
+        return;
+    }
+#endif
+
+    // NOTE: We only compare addresses, the old pointer is never dereferenced after realloc
+    uintptr_t oldAddress = (uintptr_t)sb->buffer;
     char* newBuffer = (char*)sb_alloc_realloc(&sb->allocator, sb->buffer, sizeof(char) * newCapacity);
+    size_t copied = (oldAddress != 0 && (uintptr_t)newBuffer != oldAddress) ? sb->capacity : 0;
     sb->buffer = newBuffer;
     sb->capacity = newCapacity;
+    sb_record_growth(sb, newCapacity, copied);
 }
 
 char* sb_to_cstr(StringBuilder* sb) {
@@ -334,7 +684,16 @@ char* sb_to_cstr(StringBuilder* sb) {
 }
 
 void sb_free(StringBuilder* sb) {
+#ifdef __STRING_BUILDER_MREMAP
+    if (sb->buffer_mapped) {
+        munmap(sb->buffer, sb->capacity);
+    } else {
+        sb_alloc_free(&sb->allocator, sb->buffer);
+    }
+#else
     sb_alloc_free(&sb->allocator, sb->buffer);
+#endif
+    sb->buffer_mapped = false;
     sb->buffer = NULL;
     sb->length = 0;
     sb->capacity = 0;
@@ -378,6 +737,67 @@ void sb_vformat(StringBuilder* sb, char const* format, va_list args) {
     sb->length += (size_t)formattedLength;
 }
 
+void sb_join(StringBuilder* sb, char const* const* strings, size_t const* lengths, size_t count, char const* sep) {
+    size_t sepLength = (sep == NULL) ? 0 : strlen(sep);
+    // Missing lengths are measured a chunk at a time, so each string is scanned once and the buffer still grows once per chunk
+    size_t measuredLengths[256];
+    size_t const maxChunkCount = sizeof(measuredLengths) / sizeof(measuredLengths[0]);
+    size_t chunkCount;
+    for (size_t start = 0; start < count; start += chunkCount) {
+        chunkCount = count - start;
+        size_t const* chunkLengths;
+        if (lengths != NULL) {
+            chunkLengths = lengths + start;
+        }
+        else {
+            if (chunkCount > maxChunkCount) chunkCount = maxChunkCount;
+            for (size_t i = 0; i < chunkCount; ++i) measuredLengths[i] = strlen(strings[start + i]);
+            chunkLengths = measuredLengths;
+        }
+        size_t totalLength = sepLength * ((start == 0) ? (chunkCount - 1) : chunkCount);
+        for (size_t i = 0; i < chunkCount; ++i) totalLength += chunkLengths[i];
+        sb_reserve(sb, sb->length + totalLength);
+        char* dest = sb->buffer + sb->length;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            if (start + i > 0 && sepLength > 0) {
+                memcpy(dest, sep, sepLength);
+                dest += sepLength;
+            }
+            memcpy(dest, strings[start + i], chunkLengths[i]);
+            dest += chunkLengths[i];
+        }
+        sb->length += totalLength;
+    }
+}
+
+void sb_repeat(StringBuilder* sb, char const* str, size_t count) {
+    size_t strLength = strlen(str);
+    sb_repeatn(sb, str, strLength, count);
+}
+
+void sb_repeatn(StringBuilder* sb, char const* str, size_t n, size_t count) {
+    if (n == 0 || count == 0) return;
+    STRING_BUILDER_ASSERT(count <= (size_t)-1 / n, "repeated length overflows");
+    size_t totalLength = n * count;
+    sb_reserve(sb, sb->length + totalLength);
+    char* dest = sb->buffer + sb->length;
+    memcpy(dest, str, n);
+    // Double the already copied part until the whole range is filled
+    size_t filled = n;
+    while (filled < totalLength) {
+        size_t chunk = (filled < totalLength - filled) ? filled : (totalLength - filled);
+        memcpy(dest + filled, dest, chunk);
+        filled += chunk;
+    }
+    sb->length += totalLength;
+}
+
+void sb_repeatc(StringBuilder* sb, char c, size_t count) {
+    sb_reserve(sb, sb->length + count);
+    memset(sb->buffer + sb->length, c, count);
+    sb->length += count;
+}
+
 void sb_insert(StringBuilder* sb, size_t pos, char const* str) {
     size_t strLength = strlen(str);
     sb_insertn(sb, pos, str, strLength);
@@ -420,33 +840,47 @@ void sb_remove(StringBuilder* sb, size_t pos, size_t length) {
 void sb_replace(StringBuilder* sb, char const* target, char const* replacement) {
     size_t targetLen = strlen(target);
     // Avoid replacing empty strings, just makes no sense
-    if (targetLen == 0) return;
+    if (targetLen == 0 || targetLen > sb->length) return;
     size_t replacementLen = strlen(replacement);
-    size_t pos = 0;
-    while (pos + targetLen <= sb->length) {
-        if (memcmp(sb->buffer + pos, target, targetLen) != 0) {
-            ++pos;
-            continue;
+    // The content is rewritten in a single forward pass, reading from 'from' and writing to 'to'
+    size_t from = 0;
+    size_t end = sb->length;
+    if (replacementLen > targetLen) {
+        // Replacement is longer, count the matches to grow once, and move the content to the end of the grown buffer
+        // Each match then takes up exactly the space that was made for it, so the writes never overtake the reads
+        size_t matches = 0;
+        for (size_t pos = 0; pos + targetLen <= sb->length;) {
+            if (memcmp(sb->buffer + pos, target, targetLen) == 0) {
+                ++matches;
+                pos += targetLen;
+            } else {
+                ++pos;
+            }
         }
-        if (targetLen == replacementLen) {
-            // Same length, no shifting needed
-            memcpy(sb->buffer + pos, replacement, replacementLen);
-        } else if (replacementLen < targetLen) {
-            // Replacement is shorter, copy replacement, then shift rest left
-            size_t diff = targetLen - replacementLen;
-            memcpy(sb->buffer + pos, replacement, replacementLen);
-            memmove(sb->buffer + pos + replacementLen, sb->buffer + pos + targetLen, sb->length - pos - targetLen);
-            sb->length -= diff;
-        } else {
-            // Replacement is longer, reserve, shift rest right, then copy replacement
-            size_t diff = replacementLen - targetLen;
-            sb_reserve(sb, sb->length + diff);
-            memmove(sb->buffer + pos + replacementLen, sb->buffer + pos + targetLen, sb->length - pos - targetLen);
-            memcpy(sb->buffer + pos, replacement, replacementLen);
-            sb->length += diff;
+        if (matches == 0) return;
+        size_t growth = matches * (replacementLen - targetLen);
+        sb_reserve(sb, sb->length + growth);
+        memmove(sb->buffer + growth, sb->buffer, sb->length);
+        from = growth;
+        end = sb->length + growth;
+    }
+    size_t to = 0;
+    // The unmatched content since the last match, moved in one piece when the next match is found
+    size_t runStart = from;
+    while (from + targetLen <= end) {
+        if (memcmp(sb->buffer + from, target, targetLen) != 0) {
+            ++from;
+            continue;
         }
-        pos += replacementLen;
+        memmove(sb->buffer + to, sb->buffer + runStart, from - runStart);
+        to += from - runStart;
+        memcpy(sb->buffer + to, replacement, replacementLen);
+        to += replacementLen;
+        from += targetLen;
+        runStart = from;
     }
+    memmove(sb->buffer + to, sb->buffer + runStart, end - runStart);
+    sb->length = to + (end - runStart);
 }
 
 bool sb_contains(StringBuilder* sb, char const* str) {
@@ -478,6 +912,269 @@ int sb_index_ofc(StringBuilder* sb, char c) {
     return -1;
 }
 
+// Text operations /////////////////////////////////////////////////////////////
+
+// Flips the case of the ASCII letters in the given range, lower is the first letter to flip ('a' or 'A')
+static void sb_ascii_flip_case(char* str, size_t n, char lower) {
+    char upper = (char)(lower + 25);
+    size_t i = 0;
+#ifdef __STRING_BUILDER_SSE2
+    __m128i rangeStart = _mm_set1_epi8((char)(lower - 1));
+    __m128i rangeEnd = _mm_set1_epi8((char)(upper + 1));
+    __m128i caseBit = _mm_set1_epi8(0x20);
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128((__m128i const*)(str + i));
+        // Non-ASCII bytes are negative as signed, so they are never in range
+        __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(block, rangeStart), _mm_cmplt_epi8(block, rangeEnd));
+        block = _mm_xor_si128(block, _mm_and_si128(inRange, caseBit));
+        _mm_storeu_si128((__m128i*)(str + i), block);
+    }
+#else
+    uint64_t const ones = 0x0101010101010101ull;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, str + i, sizeof(word));
+        // The top bit of each byte is set, if the low 7 bits are at least the given value, no carry crosses bytes
+        uint64_t heptets = word & 0x7F7F7F7F7F7F7F7Full;
+        uint64_t atLeastLower = heptets + ones * (uint64_t)(0x80 - lower);
+        uint64_t aboveUpper = heptets + ones * (uint64_t)(0x80 - upper - 1);
+        uint64_t inRange = atLeastLower & ~aboveUpper & ~word & 0x8080808080808080ull;
+        word ^= inRange >> 2;
+        memcpy(str + i, &word, sizeof(word));
+    }
+#endif
+    for (; i < n; ++i) {
+        if (str[i] >= lower && str[i] <= upper) str[i] = (char)(str[i] ^ 0x20);
+    }
+}
+
+static bool sb_is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+#ifdef __STRING_BUILDER_SSE2
+// Returns a 16-bit mask with a bit set for each whitespace byte in the block
+static int sb_space_mask(__m128i block) {
+    __m128i isSpace = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    __m128i isControl = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(block, _mm_set1_epi8('\r' + 1)));
+    return _mm_movemask_epi8(_mm_or_si128(isSpace, isControl));
+}
+#endif
+
+void sb_to_upper(StringBuilder* sb) {
+    sb_ascii_flip_case(sb->buffer, sb->length, 'a');
+}
+
+void sb_to_lower(StringBuilder* sb) {
+    sb_ascii_flip_case(sb->buffer, sb->length, 'A');
+}
+
+void sb_trim(StringBuilder* sb) {
+    // Trimming the end first means less to move when trimming the start
+    sb_trim_end(sb);
+    sb_trim_start(sb);
+}
+
+void sb_trim_start(StringBuilder* sb) {
+    size_t start = 0;
+#ifdef __STRING_BUILDER_SSE2
+    while (start + 16 <= sb->length && sb_space_mask(_mm_loadu_si128((__m128i const*)(sb->buffer + start))) == 0xFFFF) start += 16;
+#endif
+    while (start < sb->length && sb_is_space(sb->buffer[start])) ++start;
+    sb_remove(sb, 0, start);
+}
+
+void sb_trim_end(StringBuilder* sb) {
+    size_t end = sb->length;
+#ifdef __STRING_BUILDER_SSE2
+    while (end >= 16 && sb_space_mask(_mm_loadu_si128((__m128i const*)(sb->buffer + end - 16))) == 0xFFFF) end -= 16;
+#endif
+    while (end > 0 && sb_is_space(sb->buffer[end - 1])) --end;
+    sb->length = end;
+}
+
+size_t sb_split(StringBuilder* sb, char delimiter, StringView* parts, size_t max_parts) {
+    size_t count = 0;
+    size_t start = 0;
+    while (true) {
+        // memchr is vectorized by every major C library, no need to roll our own
+        char const* found = (sb->length > start) ? (char const*)memchr(sb->buffer + start, delimiter, sb->length - start) : NULL;
+        size_t end = (found == NULL) ? sb->length : (size_t)(found - sb->buffer);
+        if (count < max_parts) {
+            parts[count] = (StringView){ .data = sb->buffer + start, .length = end - start };
+        }
+        ++count;
+        if (found == NULL) break;
+        start = end + 1;
+    }
+    return count;
+}
+
+// UTF-8 ///////////////////////////////////////////////////////////////////////
+
+static size_t sb_popcount64(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (size_t)((x * 0x0101010101010101ull) >> 56);
+}
+
+// Returns the length of the longest prefix that only contains ASCII characters
+static size_t sb_utf8_ascii_prefix(char const* str, size_t n) {
+    size_t i = 0;
+#ifdef __STRING_BUILDER_SSE2
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128((__m128i const*)(str + i));
+        if (_mm_movemask_epi8(block) != 0) break;
+    }
+#else
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, str + i, sizeof(word));
+        if ((word & 0x8080808080808080ull) != 0) break;
+    }
+#endif
+    // The remainder, or the block containing the first non-ASCII character
+    while (i < n && ((unsigned char)str[i] & 0x80) == 0) ++i;
+    return i;
+}
+
+// Counts the bytes that are not continuation bytes, meaning the number of code points in valid UTF-8
+static size_t sb_utf8_count_leads(char const* str, size_t n) {
+    size_t count = 0;
+    size_t i = 0;
+#ifdef __STRING_BUILDER_SSE2
+    // Continuation bytes are 0x80-0xBF, which are exactly the signed bytes below -64
+    __m128i threshold = _mm_set1_epi8(-65);
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128((__m128i const*)(str + i));
+        count += sb_popcount64((uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(block, threshold)));
+    }
+#else
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, str + i, sizeof(word));
+        // Continuation bytes have the top bit set and the one below it cleared
+        uint64_t continuations = word & ~(word << 1) & 0x8080808080808080ull;
+        count += 8 - sb_popcount64(continuations);
+    }
+#endif
+    for (; i < n; ++i) {
+        if (((unsigned char)str[i] & 0xC0) != 0x80) ++count;
+    }
+    return count;
+}
+
+// Decodes a single code point, returns the number of bytes consumed or 0 if the sequence is invalid
+static size_t sb_utf8_decode(unsigned char const* str, size_t n, uint32_t* codepoint) {
+    unsigned char first = str[0];
+    if (first < 0x80) {
+        *codepoint = first;
+        return 1;
+    }
+    size_t length;
+    uint32_t value;
+    uint32_t minValue;
+    if ((first & 0xE0) == 0xC0) {
+        length = 2;
+        value = (uint32_t)(first & 0x1F);
+        minValue = 0x80;
+    } else if ((first & 0xF0) == 0xE0) {
+        length = 3;
+        value = (uint32_t)(first & 0x0F);
+        minValue = 0x800;
+    } else if ((first & 0xF8) == 0xF0) {
+        length = 4;
+        value = (uint32_t)(first & 0x07);
+        minValue = 0x10000;
+    } else {
+        return 0;
+    }
+    if (length > n) return 0;
+    for (size_t i = 1; i < length; ++i) {
+        if ((str[i] & 0xC0) != 0x80) return 0;
+        value = (value << 6) | (uint32_t)(str[i] & 0x3F);
+    }
+    // Reject overlong encodings, surrogates and out of range values
+    if (value < minValue || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF)) return 0;
+    *codepoint = value;
+    return length;
+}
+
+bool sb_utf8_validate(StringBuilder* sb) {
+    size_t pos = 0;
+    while (pos < sb->length) {
+        pos += sb_utf8_ascii_prefix(sb->buffer + pos, sb->length - pos);
+        if (pos == sb->length) break;
+        uint32_t codepoint;
+        size_t length = sb_utf8_decode((unsigned char const*)sb->buffer + pos, sb->length - pos, &codepoint);
+        if (length == 0) return false;
+        pos += length;
+    }
+    return true;
+}
+
+size_t sb_utf8_length(StringBuilder* sb) {
+    return sb_utf8_count_leads(sb->buffer, sb->length);
+}
+
+void sb_utf8_truncate(StringBuilder* sb, size_t n) {
+    // Skip whole blocks while the code point to cut at is known to be past them
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos + 64 <= sb->length) {
+        size_t blockCount = sb_utf8_count_leads(sb->buffer + pos, 64);
+        if (count + blockCount > n) break;
+        count += blockCount;
+        pos += 64;
+    }
+    for (; pos < sb->length; ++pos) {
+        if (((unsigned char)sb->buffer[pos] & 0xC0) == 0x80) continue;
+        if (count == n) {
+            sb->length = pos;
+            return;
+        }
+        ++count;
+    }
+}
+
+bool sb_utf8_next(StringBuilder* sb, size_t* pos, uint32_t* codepoint) {
+    if (*pos >= sb->length) return false;
+    size_t length = sb_utf8_decode((unsigned char const*)sb->buffer + *pos, sb->length - *pos, codepoint);
+    if (length == 0) {
+        *codepoint = 0xFFFD;
+        length = 1;
+    }
+    *pos += length;
+    return true;
+}
+
+void sb_utf8_putc(StringBuilder* sb, uint32_t codepoint) {
+    STRING_BUILDER_ASSERT(codepoint <= 0x10FFFF && (codepoint < 0xD800 || codepoint > 0xDFFF), "invalid code point");
+    char encoded[4];
+    size_t length;
+    if (codepoint < 0x80) {
+        encoded[0] = (char)codepoint;
+        length = 1;
+    } else if (codepoint < 0x800) {
+        encoded[0] = (char)(0xC0 | (codepoint >> 6));
+        encoded[1] = (char)(0x80 | (codepoint & 0x3F));
+        length = 2;
+    } else if (codepoint < 0x10000) {
+        encoded[0] = (char)(0xE0 | (codepoint >> 12));
+        encoded[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        encoded[2] = (char)(0x80 | (codepoint & 0x3F));
+        length = 3;
+    } else {
+        encoded[0] = (char)(0xF0 | (codepoint >> 18));
+        encoded[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        encoded[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        encoded[3] = (char)(0x80 | (codepoint & 0x3F));
+        length = 4;
+    }
+    sb_putsn(sb, encoded, length);
+}
+
 // Code builder ////////////////////////////////////////////////////////////////
 
 static void code_builder_indent_if_needed(CodeBuilder* cb) {
@@ -576,6 +1273,134 @@ void code_builder_dedent(CodeBuilder* cb) {
     --cb->indent_level;
 }
 
+// String interner /////////////////////////////////////////////////////////////
+
+static uint32_t string_interner_hash(char const* str, size_t n) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < n; ++i) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Returns the index of the slot holding the given string, or the empty slot where it should be inserted
+static size_t string_interner_probe(StringInterner* si, char const* str, size_t n, uint32_t hash) {
+    size_t mask = si->slot_count - 1;
+    size_t index = hash & mask;
+    while (si->slots[index] != 0) {
+        uint32_t id = si->slots[index] - 1;
+        StringView view = si->strings[id];
+        if (si->hashes[id] == hash && view.length == n && memcmp(view.data, str, n) == 0) break;
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+static void string_interner_grow_index(StringInterner* si) {
+    size_t newSlotCount = (si->slot_count == 0) ? 64 : (si->slot_count * 2);
+    uint32_t* newSlots = (uint32_t*)sb_alloc_realloc(&si->allocator, NULL, sizeof(uint32_t) * newSlotCount);
+    memset(newSlots, 0, sizeof(uint32_t) * newSlotCount);
+    // Reinsert all ids, no need to compare strings as they are all distinct
+    size_t mask = newSlotCount - 1;
+    for (size_t id = 0; id < si->string_count; ++id) {
+        size_t index = si->hashes[id] & mask;
+        while (newSlots[index] != 0) index = (index + 1) & mask;
+        newSlots[index] = (uint32_t)(id + 1);
+    }
+    sb_alloc_free(&si->allocator, si->slots);
+    si->slots = newSlots;
+    si->slot_count = newSlotCount;
+}
+
+// Copies the string into chunk storage with a null-terminator and returns a pointer to the stored copy
+static char const* string_interner_store(StringInterner* si, char const* str, size_t n) {
+    StringBuilder* chunk = (si->chunk_count == 0) ? NULL : &si->chunks[si->chunk_count - 1];
+    if (chunk == NULL || chunk->capacity - chunk->length < n + 1) {
+        if (si->chunk_count + 1 > si->chunk_capacity) {
+            size_t newCapacity = (si->chunk_capacity == 0) ? 8 : (si->chunk_capacity * 2);
+            si->chunks = (StringBuilder*)sb_alloc_realloc(&si->allocator, si->chunks, sizeof(StringBuilder) * newCapacity);
+            si->chunk_capacity = newCapacity;
+        }
+        size_t chunkSize = (si->chunk_size == 0) ? 64 * 1024 : si->chunk_size;
+        // Oversized strings get a dedicated chunk
+        if (chunkSize < n + 1) chunkSize = n + 1;
+        chunk = &si->chunks[si->chunk_count++];
+        *chunk = (StringBuilder){ .allocator = si->allocator };
+        sb_reserve(chunk, chunkSize);
+    }
+    char const* stored = chunk->buffer + chunk->length;
+    // The chunk has enough capacity, so these never reallocate and the stored strings never move
+    sb_putsn(chunk, str, n);
+    sb_putc(chunk, '\0');
+    return stored;
+}
+
+uint32_t string_interner_intern(StringInterner* si, char const* str) {
+    size_t strLength = strlen(str);
+    return string_interner_internn(si, str, strLength);
+}
+
+uint32_t string_interner_internn(StringInterner* si, char const* str, size_t n) {
+    // Keep the load factor at or below 1/2
+    if ((si->string_count + 1) * 2 > si->slot_count) string_interner_grow_index(si);
+
+    uint32_t hash = string_interner_hash(str, n);
+    size_t index = string_interner_probe(si, str, n, hash);
+    if (si->slots[index] != 0) return si->slots[index] - 1;
+
+    STRING_BUILDER_ASSERT(si->string_count < UINT32_MAX, "string interner ran out of ids");
+    if (si->string_count + 1 > si->string_capacity) {
+        size_t newCapacity = (si->string_capacity == 0) ? 32 : (si->string_capacity * 2);
+        si->strings = (StringView*)sb_alloc_realloc(&si->allocator, si->strings, sizeof(StringView) * newCapacity);
+        si->hashes = (uint32_t*)sb_alloc_realloc(&si->allocator, si->hashes, sizeof(uint32_t) * newCapacity);
+        si->string_capacity = newCapacity;
+    }
+    uint32_t id = (uint32_t)si->string_count;
+    si->strings[id] = (StringView){ .data = string_interner_store(si, str, n), .length = n };
+    si->hashes[id] = hash;
+    ++si->string_count;
+    si->slots[index] = id + 1;
+    return id;
+}
+
+bool string_interner_find(StringInterner* si, char const* str, size_t n, uint32_t* id) {
+    if (si->string_count == 0) return false;
+    size_t index = string_interner_probe(si, str, n, string_interner_hash(str, n));
+    if (si->slots[index] == 0) return false;
+    if (id != NULL) *id = si->slots[index] - 1;
+    return true;
+}
+
+StringView string_interner_get(StringInterner* si, uint32_t id) {
+    STRING_BUILDER_ASSERT(id < si->string_count, "string interner id out of bounds");
+    return si->strings[id];
+}
+
+size_t string_interner_count(StringInterner* si) {
+    return si->string_count;
+}
+
+void string_interner_free(StringInterner* si) {
+    for (size_t i = 0; i < si->chunk_count; ++i) {
+        sb_free(&si->chunks[i]);
+    }
+    sb_alloc_free(&si->allocator, si->chunks);
+    sb_alloc_free(&si->allocator, si->strings);
+    sb_alloc_free(&si->allocator, si->hashes);
+    sb_alloc_free(&si->allocator, si->slots);
+    si->chunks = NULL;
+    si->chunk_count = 0;
+    si->chunk_capacity = 0;
+    si->strings = NULL;
+    si->hashes = NULL;
+    si->string_count = 0;
+    si->string_capacity = 0;
+    si->slots = NULL;
+    si->slot_count = 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -644,6 +1469,102 @@ CTEST_CASE(string_builder_reserve_no_shrink) {
     sb_free(&sb);
 }
 
+CTEST_CASE(string_builder_append_within_capacity_does_not_allocate) {
+    StringBuilder sb = { .allocator = { .realloc = ctest_counting_realloc, .free = ctest_counting_free } };
+    sb_reserve(&sb, 64);
+    ctest_reset_alloc_stats();
+    sb_puts(&sb, "Hello, ");
+    sb_puts(&sb, "World!");
+    CTEST_ASSERT_ALLOCATIONS_AT_MOST(0);
+    sb_free(&sb);
+    CTEST_ASSERT_NO_LEAKS();
+}
+
+static void append_characters_bench(CTest_BenchState* state) {
+    for (size_t i = 0; i < state->iterations; ++i) {
+        StringBuilder sb = { 0 };
+        for (size_t j = 0; j < state->size; ++j) sb_putc(&sb, 'a');
+        CTEST_DO_NOT_OPTIMIZE(sb.length);
+        sb_free(&sb);
+    }
+}
+
+CTEST_CASE(string_builder_append_scales_linearly) {
+    // Geometric growth amortizes the reallocations, growing by a constant step would make this quadratic
+    CTEST_ASSERT_COMPLEXITY(append_characters_bench, CTEST_COMPLEXITY_N);
+}
+
+static void replace_bench(CTest_BenchState* state, char const* replacement) {
+    for (size_t i = 0; i < state->iterations; ++i) {
+        StringBuilder sb = { 0 };
+        // Large enough for shifting the content after each match to dominate, if it was done
+        while (sb.length < state->size * 16) sb_puts(&sb, "foo bar ");
+        sb_replace(&sb, "foo", replacement);
+        CTEST_DO_NOT_OPTIMIZE(sb.length);
+        sb_free(&sb);
+    }
+}
+
+static void replace_same_length_bench(CTest_BenchState* state) { replace_bench(state, "baz"); }
+static void replace_longer_bench(CTest_BenchState* state) { replace_bench(state, "quux"); }
+
+CTEST_CASE(string_builder_replace_same_length_scales_linearly) {
+    CTEST_ASSERT_COMPLEXITY(replace_same_length_bench, CTEST_COMPLEXITY_N);
+}
+
+CTEST_CASE(string_builder_replace_longer_scales_linearly) {
+    // Shifting the rest of the content for each match would make growing replacements quadratic in the number of matches
+    CTEST_ASSERT_COMPLEXITY(replace_longer_bench, CTEST_COMPLEXITY_N);
+}
+
+CTEST_CASE(string_builder_reserve_custom_factor) {
+    StringBuilder sb = { .growth = { .initial_capacity = 100, .factor = 1.5 } };
+    sb_reserve(&sb, 1);
+    CTEST_ASSERT_TRUE(sb.capacity == 100);
+    sb_reserve(&sb, 101);
+    CTEST_ASSERT_TRUE(sb.capacity == 150);
+    sb_reserve(&sb, 200);
+    CTEST_ASSERT_TRUE(sb.capacity == 225);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_reserve_linear_above_threshold) {
+    StringBuilder sb = { .growth = { .linear_threshold = 100, .linear_step = 50 } };
+    sb_reserve(&sb, 80);
+    // 16 -> 32 -> 64 -> 100, capped at the threshold
+    CTEST_ASSERT_TRUE(sb.capacity == 100);
+    sb_reserve(&sb, 101);
+    CTEST_ASSERT_TRUE(sb.capacity == 150);
+    sb_reserve(&sb, 320);
+    CTEST_ASSERT_TRUE(sb.capacity == 350);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_stats_track_growth) {
+    StringBuilder sb = test_sb_create();
+    for (int i = 0; i < 100; ++i) sb_putc(&sb, 'x');
+    // 16 -> 32 -> 64 -> 128
+    CTEST_ASSERT_TRUE(sb.stats.reallocs == 4);
+    CTEST_ASSERT_TRUE(sb.stats.peak_capacity == 128);
+    CTEST_ASSERT_TRUE(sb.stats.bytes_copied <= 16 + 32 + 64);
+    sb_clear(&sb);
+    sb_putc(&sb, 'x');
+    CTEST_ASSERT_TRUE(sb.stats.reallocs == 4);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_mremap_growth_preserves_content) {
+    StringBuilder sb = { .growth = { .mremap_threshold = 4096 } };
+    for (int i = 0; i < 100000; ++i) sb_putc(&sb, (char)('a' + i % 26));
+    CTEST_ASSERT_TRUE(sb.length == 100000);
+    for (size_t i = 0; i < sb.length; ++i) {
+        CTEST_ASSERT_TRUE(sb.buffer[i] == (char)('a' + i % 26));
+    }
+    sb_free(&sb);
+    CTEST_ASSERT_TRUE(sb.buffer == NULL);
+    CTEST_ASSERT_TRUE(!sb.buffer_mapped);
+}
+
 // Puts tests //////////////////////////////////////////////////////////////////
 
 CTEST_CASE(string_builder_puts_appends_string) {
@@ -732,6 +1653,89 @@ CTEST_CASE(string_builder_putc_null_char) {
     sb_free(&sb);
 }
 
+// Join and repeat tests ///////////////////////////////////////////////////////
+
+CTEST_CASE(string_builder_join_with_separator) {
+    StringBuilder sb = test_sb_create();
+    char const* strings[] = { "a", "bc", "def" };
+    sb_puts(&sb, "[");
+    sb_join(&sb, strings, NULL, 3, ", ");
+    sb_puts(&sb, "]");
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "[a, bc, def]"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_join_with_lengths_and_no_separator) {
+    StringBuilder sb = test_sb_create();
+    char const* strings[] = { "hello", "world!!!" };
+    size_t lengths[] = { 4, 5 };
+    sb_join(&sb, strings, lengths, 2, NULL);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "hellworld"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_join_grows_once) {
+    StringBuilder sb = test_sb_create();
+    char const* strings[100];
+    for (size_t i = 0; i < 100; ++i) strings[i] = "element";
+    sb_join(&sb, strings, NULL, 100, ",");
+    CTEST_ASSERT_TRUE(sb.length == 100 * 7 + 99);
+    CTEST_ASSERT_TRUE(sb.stats.reallocs == 1);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_join_many_without_lengths) {
+    StringBuilder sb = test_sb_create();
+    char const* strings[1000];
+    for (size_t i = 0; i < 1000; ++i) strings[i] = (i % 2 == 0) ? "ab" : "";
+    sb_join(&sb, strings, NULL, 1000, ";");
+    CTEST_ASSERT_TRUE(sb.length == 500 * 2 + 999);
+    CTEST_ASSERT_TRUE(sb.buffer[0] == 'a' && sb.buffer[2] == ';' && sb.buffer[3] == ';' && sb.buffer[4] == 'a');
+    CTEST_ASSERT_TRUE(sb.buffer[sb.length - 1] == ';');
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_join_empty) {
+    StringBuilder sb = test_sb_create();
+    sb_join(&sb, NULL, NULL, 0, ",");
+    CTEST_ASSERT_TRUE(sb.length == 0);
+    char const* strings[] = { "only" };
+    sb_join(&sb, strings, NULL, 1, ",");
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "only"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_repeat_string) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "<");
+    sb_repeat(&sb, "ab", 5);
+    sb_puts(&sb, ">");
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "<ababababab>"));
+    sb_repeat(&sb, "xyz", 0);
+    sb_repeat(&sb, "", 10);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "<ababababab>"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_repeatn_long) {
+    StringBuilder sb = test_sb_create();
+    sb_repeatn(&sb, "abcdef", 3, 1000);
+    CTEST_ASSERT_TRUE(sb.length == 3000);
+    for (size_t i = 0; i < sb.length; ++i) {
+        CTEST_ASSERT_TRUE(sb.buffer[i] == "abc"[i % 3]);
+    }
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_repeatc_pads) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "name");
+    sb_repeatc(&sb, ' ', 4);
+    sb_puts(&sb, "|");
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "name    |"));
+    sb_free(&sb);
+}
+
 // Format tests ////////////////////////////////////////////////////////////////
 
 CTEST_CASE(string_builder_format_simple_string) {
@@ -1066,6 +2070,16 @@ CTEST_CASE(string_builder_replace_with_longer) {
     sb_free(&sb);
 }
 
+CTEST_CASE(string_builder_replace_overlapping_matches_from_the_left) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "aaaaa-aa");
+    sb_replace(&sb, "aa", "xyz");
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "xyzxyza-xyz"));
+    sb_replace(&sb, "xyz", "b");
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "bba-b"));
+    sb_free(&sb);
+}
+
 CTEST_CASE(string_builder_replace_with_same_length) {
     StringBuilder sb = test_sb_create();
     sb_puts(&sb, "cat and dog");
@@ -1226,6 +2240,177 @@ CTEST_CASE(string_builder_index_of_in_empty_builder) {
     sb_free(&sb);
 }
 
+// Text operation tests ////////////////////////////////////////////////////////
+
+CTEST_CASE(string_builder_to_upper_ascii_only) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "Hello, World! az AZ @[`{ 09 \xC3\xA1rv\xC3\xADzt\xC5\xB1r\xC5\x91 the quick brown fox");
+    sb_to_upper(&sb);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "HELLO, WORLD! AZ AZ @[`{ 09 \xC3\xA1RV\xC3\xADZT\xC5\xB1R\xC5\x91 THE QUICK BROWN FOX"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_to_lower_ascii_only) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "Hello, World! az AZ @[`{ 09 \xC3\x81RV\xC3\x8DZT\xC5\xB0R\xC5\x90 THE QUICK BROWN FOX");
+    sb_to_lower(&sb);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "hello, world! az az @[`{ 09 \xC3\x81rv\xC3\x8Dzt\xC5\xB0r\xC5\x90 the quick brown fox"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_trim_both_ends) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, " \t\r\n  hello world \v\f\n");
+    sb_trim(&sb);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "hello world"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_trim_long_whitespace_runs) {
+    StringBuilder sb = test_sb_create();
+    sb_repeatc(&sb, ' ', 40);
+    sb_puts(&sb, "x");
+    sb_repeatc(&sb, '\n', 40);
+    sb_trim_end(&sb);
+    CTEST_ASSERT_TRUE(sb.length == 41);
+    sb_trim_start(&sb);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "x"));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_trim_all_whitespace) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "   \t\t\n   ");
+    sb_trim(&sb);
+    CTEST_ASSERT_TRUE(sb.length == 0);
+    sb_trim(&sb);
+    CTEST_ASSERT_TRUE(sb.length == 0);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_split_on_delimiter) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "a,bc,,def,");
+    StringView parts[8];
+    size_t count = sb_split(&sb, ',', parts, 8);
+    CTEST_ASSERT_TRUE(count == 5);
+    CTEST_ASSERT_TRUE(parts[0].length == 1 && parts[0].data == sb.buffer);
+    CTEST_ASSERT_TRUE(parts[1].length == 2 && memcmp(parts[1].data, "bc", 2) == 0);
+    CTEST_ASSERT_TRUE(parts[2].length == 0);
+    CTEST_ASSERT_TRUE(parts[3].length == 3 && memcmp(parts[3].data, "def", 3) == 0);
+    CTEST_ASSERT_TRUE(parts[4].length == 0);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_split_counts_beyond_max_parts) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "x y z w");
+    CTEST_ASSERT_TRUE(sb_split(&sb, ' ', NULL, 0) == 4);
+    StringView parts[2];
+    CTEST_ASSERT_TRUE(sb_split(&sb, ' ', parts, 2) == 4);
+    CTEST_ASSERT_TRUE(parts[1].length == 1 && parts[1].data[0] == 'y');
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_split_empty_builder) {
+    StringBuilder sb = test_sb_create();
+    StringView parts[2];
+    CTEST_ASSERT_TRUE(sb_split(&sb, ',', parts, 2) == 1);
+    CTEST_ASSERT_TRUE(parts[0].length == 0);
+    sb_free(&sb);
+}
+
+// UTF-8 tests /////////////////////////////////////////////////////////////////
+
+CTEST_CASE(string_builder_utf8_validate_ascii) {
+    StringBuilder sb = test_sb_create();
+    CTEST_ASSERT_TRUE(sb_utf8_validate(&sb));
+    sb_puts(&sb, "The quick brown fox jumps over the lazy dog, twice over.");
+    CTEST_ASSERT_TRUE(sb_utf8_validate(&sb));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_utf8_validate_multibyte) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "long ASCII prefix to skip \xC3\xA1rv\xC3\xADzt\xC5\xB1r\xC5\x91 \xE2\x82\xAC \xF0\x9F\x98\x80 and a tail");
+    CTEST_ASSERT_TRUE(sb_utf8_validate(&sb));
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_utf8_validate_rejects_invalid) {
+    char const* invalid[] = {
+        "stray continuation \x80 byte",
+        "overlong \xC0\xAF slash",
+        "surrogate \xED\xA0\x80 half",
+        "too large \xF4\x90\x80\x80 value",
+        "truncated at the very end \xE2\x82",
+        "invalid lead byte \xFF",
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        StringBuilder sb = test_sb_create();
+        sb_puts(&sb, invalid[i]);
+        CTEST_ASSERT_TRUE(!sb_utf8_validate(&sb));
+        sb_free(&sb);
+    }
+}
+
+CTEST_CASE(string_builder_utf8_length_counts_code_points) {
+    StringBuilder sb = test_sb_create();
+    CTEST_ASSERT_TRUE(sb_utf8_length(&sb) == 0);
+    sb_puts(&sb, "\xC3\xA1rv\xC3\xADzt\xC5\xB1r\xC5\x91 t\xC3\xBCk\xC3\xB6rf\xC3\xBAr\xC3\xB3g\xC3\xA9p \xF0\x9F\x98\x80");
+    CTEST_ASSERT_TRUE(sb_utf8_length(&sb) == 24);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_utf8_truncate_keeps_code_points) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "a\xC3\xA1\xE2\x82\xAC\xF0\x9F\x98\x80" "b");
+    sb_utf8_truncate(&sb, 3);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "a\xC3\xA1\xE2\x82\xAC"));
+    sb_utf8_truncate(&sb, 10);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "a\xC3\xA1\xE2\x82\xAC"));
+    sb_utf8_truncate(&sb, 0);
+    CTEST_ASSERT_TRUE(sb.length == 0);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_utf8_truncate_long_content) {
+    StringBuilder sb = test_sb_create();
+    for (int i = 0; i < 100; ++i) sb_puts(&sb, "\xC3\xA1");
+    sb_utf8_truncate(&sb, 70);
+    CTEST_ASSERT_TRUE(sb.length == 140);
+    CTEST_ASSERT_TRUE(sb_utf8_length(&sb) == 70);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_utf8_next_iterates_code_points) {
+    StringBuilder sb = test_sb_create();
+    sb_puts(&sb, "a\xC3\xA1\xE2\x82\xAC\xF0\x9F\x98\x80\x80");
+    uint32_t expected[] = { 'a', 0xE1, 0x20AC, 0x1F600, 0xFFFD };
+    size_t pos = 0;
+    size_t count = 0;
+    uint32_t codepoint;
+    while (sb_utf8_next(&sb, &pos, &codepoint)) {
+        CTEST_ASSERT_TRUE(count < 5);
+        CTEST_ASSERT_TRUE(codepoint == expected[count]);
+        ++count;
+    }
+    CTEST_ASSERT_TRUE(count == 5);
+    CTEST_ASSERT_TRUE(pos == sb.length);
+    sb_free(&sb);
+}
+
+CTEST_CASE(string_builder_utf8_putc_encodes) {
+    StringBuilder sb = test_sb_create();
+    sb_utf8_putc(&sb, 'a');
+    sb_utf8_putc(&sb, 0xE1);
+    sb_utf8_putc(&sb, 0x20AC);
+    sb_utf8_putc(&sb, 0x1F600);
+    CTEST_ASSERT_TRUE(test_sb_equals(&sb, "a\xC3\xA1\xE2\x82\xAC\xF0\x9F\x98\x80"));
+    CTEST_ASSERT_TRUE(sb_utf8_validate(&sb));
+    sb_free(&sb);
+}
+
 // Code builder tests //////////////////////////////////////////////////////////
 
 CTEST_CASE(code_builder_no_indent_at_level_zero) {
@@ -1315,8 +2500,363 @@ CTEST_CASE(code_builder_clear_preserves_indent_level) {
     code_builder_free(&cb);
 }
 
+// String interner tests ///////////////////////////////////////////////////////
+
+CTEST_CASE(string_interner_same_string_same_id) {
+    StringInterner si = { 0 };
+    uint32_t a = string_interner_intern(&si, "foo");
+    uint32_t b = string_interner_intern(&si, "bar");
+    uint32_t c = string_interner_intern(&si, "foo");
+    CTEST_ASSERT_TRUE(a == c);
+    CTEST_ASSERT_TRUE(a != b);
+    CTEST_ASSERT_TRUE(string_interner_count(&si) == 2);
+    string_interner_free(&si);
+}
+
+CTEST_CASE(string_interner_ids_are_dense) {
+    StringInterner si = { 0 };
+    CTEST_ASSERT_TRUE(string_interner_intern(&si, "a") == 0);
+    CTEST_ASSERT_TRUE(string_interner_intern(&si, "b") == 1);
+    CTEST_ASSERT_TRUE(string_interner_intern(&si, "a") == 0);
+    CTEST_ASSERT_TRUE(string_interner_intern(&si, "c") == 2);
+    string_interner_free(&si);
+}
+
+CTEST_CASE(string_interner_get_returns_null_terminated_view) {
+    StringInterner si = { 0 };
+    uint32_t id = string_interner_internn(&si, "hello world", 5);
+    StringView view = string_interner_get(&si, id);
+    CTEST_ASSERT_TRUE(view.length == 5);
+    CTEST_ASSERT_TRUE(strcmp(view.data, "hello") == 0);
+    string_interner_free(&si);
+}
+
+CTEST_CASE(string_interner_find_does_not_intern) {
+    StringInterner si = { 0 };
+    uint32_t id = 0;
+    CTEST_ASSERT_TRUE(!string_interner_find(&si, "x", 1, &id));
+    uint32_t expected = string_interner_intern(&si, "x");
+    CTEST_ASSERT_TRUE(!string_interner_find(&si, "y", 1, &id));
+    CTEST_ASSERT_TRUE(string_interner_find(&si, "x", 1, &id));
+    CTEST_ASSERT_TRUE(id == expected);
+    CTEST_ASSERT_TRUE(string_interner_count(&si) == 1);
+    string_interner_free(&si);
+}
+
+CTEST_CASE(string_interner_empty_string) {
+    StringInterner si = { 0 };
+    uint32_t a = string_interner_intern(&si, "");
+    uint32_t b = string_interner_internn(&si, "abc", 0);
+    CTEST_ASSERT_TRUE(a == b);
+    CTEST_ASSERT_TRUE(string_interner_get(&si, a).length == 0);
+    string_interner_free(&si);
+}
+
+CTEST_CASE(string_interner_many_strings_across_chunks) {
+    StringInterner si = { .chunk_size = 64 };
+    char buffer[32];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(buffer, sizeof(buffer), "identifier_%d", i);
+        CTEST_ASSERT_TRUE(string_interner_intern(&si, buffer) == (uint32_t)i);
+    }
+    CTEST_ASSERT_TRUE(si.chunk_count > 1);
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(buffer, sizeof(buffer), "identifier_%d", i);
+        CTEST_ASSERT_TRUE(string_interner_intern(&si, buffer) == (uint32_t)i);
+        CTEST_ASSERT_TRUE(strcmp(string_interner_get(&si, (uint32_t)i).data, buffer) == 0);
+    }
+    CTEST_ASSERT_TRUE(string_interner_count(&si) == 1000);
+    string_interner_free(&si);
+}
+
+CTEST_CASE(string_interner_oversized_string) {
+    StringInterner si = { .chunk_size = 16 };
+    char const* longStr = "this string is longer than a single chunk";
+    uint32_t id = string_interner_intern(&si, longStr);
+    CTEST_ASSERT_TRUE(strcmp(string_interner_get(&si, id).data, longStr) == 0);
+    CTEST_ASSERT_TRUE(string_interner_intern(&si, longStr) == id);
+    string_interner_free(&si);
+}
+
 #endif /* STRING_BUILDER_SELF_TEST */
 
+////////////////////////////////////////////////////////////////////////////////
+// Benchmark section                                                          //
+////////////////////////////////////////////////////////////////////////////////
+#ifdef STRING_BUILDER_BENCHMARK
+#undef STRING_BUILDER_BENCHMARK
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRING_BUILDER_STATIC
+#define STRING_BUILDER_IMPLEMENTATION
+#include "string_builder.h"
+
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <time.h>
+#endif
+
+// Seconds elapsed on a monotonic clock
+static double bench_now(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+typedef struct BenchContext {
+    // The number of allocations done through the counting allocator during the measured part
+    size_t alloc_calls;
+    // The allocation stats of the measured builder
+    SB_Stats stats;
+    // Accumulates results, so the measured work can't be optimized away
+    size_t sink;
+} BenchContext;
+
+static void* bench_realloc(void* ctx, void* ptr, size_t new_size) {
+    ++((BenchContext*)ctx)->alloc_calls;
+    return realloc(ptr, new_size);
+}
+
+static void bench_free(void* ctx, void* ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+static StringBuilder bench_sb_create(BenchContext* ctx) {
+    StringBuilder sb = { .allocator = { .context = ctx, .realloc = bench_realloc, .free = bench_free } };
+    return sb;
+}
+
+// The piece every append-style benchmark appends
+static char const bench_piece[] = "0123456789abcdef0123456789abcdef";
+#define BENCH_PIECE_LENGTH (sizeof(bench_piece) - 1)
+
+// Each benchmark produces roughly size bytes of output and returns the seconds spent in the measured part
+
+static double bench_memcpy_baseline(size_t size, BenchContext* ctx) {
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    char* buffer = (char*)bench_realloc(ctx, NULL, size + BENCH_PIECE_LENGTH);
+    size_t length = 0;
+    while (length < size) {
+        memcpy(buffer + length, bench_piece, BENCH_PIECE_LENGTH);
+        length += BENCH_PIECE_LENGTH;
+    }
+    double elapsed = bench_now() - start;
+    ctx->sink += (size_t)buffer[length / 2];
+    free(buffer);
+    return elapsed;
+}
+
+static double bench_sb_putsn(size_t size, BenchContext* ctx) {
+    StringBuilder sb = bench_sb_create(ctx);
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    while (sb.length < size) sb_putsn(&sb, bench_piece, BENCH_PIECE_LENGTH);
+    double elapsed = bench_now() - start;
+    ctx->stats = sb.stats;
+    ctx->sink += (size_t)sb.buffer[sb.length / 2];
+    sb_free(&sb);
+    return elapsed;
+}
+
+static double bench_sb_join(size_t size, BenchContext* ctx) {
+    size_t count = size / (BENCH_PIECE_LENGTH + 2) + 1;
+    char const** strings = (char const**)malloc(sizeof(char const*) * count);
+    for (size_t i = 0; i < count; ++i) strings[i] = bench_piece;
+    StringBuilder sb = bench_sb_create(ctx);
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    sb_join(&sb, strings, NULL, count, ", ");
+    double elapsed = bench_now() - start;
+    ctx->stats = sb.stats;
+    ctx->sink += (size_t)sb.buffer[sb.length / 2];
+    sb_free(&sb);
+    free((void*)strings);
+    return elapsed;
+}
+
+static double bench_sb_putc(size_t size, BenchContext* ctx) {
+    StringBuilder sb = bench_sb_create(ctx);
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    for (size_t i = 0; i < size; ++i) sb_putc(&sb, (char)('a' + (i & 15)));
+    double elapsed = bench_now() - start;
+    ctx->stats = sb.stats;
+    ctx->sink += (size_t)sb.buffer[sb.length / 2];
+    sb_free(&sb);
+    return elapsed;
+}
+
+static double bench_sb_format(size_t size, BenchContext* ctx) {
+    StringBuilder sb = bench_sb_create(ctx);
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    for (int i = 0; sb.length < size; ++i) sb_format(&sb, "item_%d = %d;\n", i, i * 31);
+    double elapsed = bench_now() - start;
+    ctx->stats = sb.stats;
+    ctx->sink += (size_t)sb.buffer[sb.length / 2];
+    sb_free(&sb);
+    return elapsed;
+}
+
+static double bench_sb_insert(size_t size, BenchContext* ctx) {
+    StringBuilder sb = bench_sb_create(ctx);
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    while (sb.length < size) sb_insert(&sb, sb.length / 2, bench_piece);
+    double elapsed = bench_now() - start;
+    ctx->stats = sb.stats;
+    ctx->sink += (size_t)sb.buffer[sb.length / 2];
+    sb_free(&sb);
+    return elapsed;
+}
+
+static double bench_sb_replace(size_t size, BenchContext* ctx) {
+    StringBuilder sb = bench_sb_create(ctx);
+    while (sb.length < size) sb_puts(&sb, "foo bar ");
+    SB_Stats setupStats = sb.stats;
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    // Replacement is longer, so the content has to be shifted
+    sb_replace(&sb, "foo", "quux");
+    double elapsed = bench_now() - start;
+    ctx->stats = sb.stats;
+    ctx->stats.reallocs -= setupStats.reallocs;
+    ctx->stats.bytes_copied -= setupStats.bytes_copied;
+    ctx->sink += (size_t)sb.buffer[sb.length / 2];
+    sb_free(&sb);
+    return elapsed;
+}
+
+static double bench_sb_index_of(size_t size, BenchContext* ctx) {
+    StringBuilder sb = bench_sb_create(ctx);
+    // Lots of partial matches before the real one at the very end
+    while (sb.length < size) sb_puts(&sb, "needl ");
+    sb_puts(&sb, "needle");
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    int index = sb_index_of(&sb, "needle");
+    double elapsed = bench_now() - start;
+    ctx->stats = (SB_Stats){ 0 };
+    ctx->sink += (size_t)index;
+    sb_free(&sb);
+    return elapsed;
+}
+
+static double bench_code_builder(size_t size, BenchContext* ctx) {
+    CodeBuilder cb = { .builder = bench_sb_create(ctx) };
+    double start = bench_now();
+    ctx->alloc_calls = 0;
+    for (int i = 0; cb.builder.length < size; ++i) {
+        code_builder_format(&cb, "static int function_%d(int x) {\n", i);
+        code_builder_indent(&cb);
+        code_builder_puts(&cb, "if (x > 0) {\n");
+        code_builder_indent(&cb);
+        code_builder_format(&cb, "return x * %d;\n", i);
+        code_builder_dedent(&cb);
+        code_builder_puts(&cb, "}\nreturn 0;\n");
+        code_builder_dedent(&cb);
+        code_builder_puts(&cb, "}\n\n");
+    }
+    double elapsed = bench_now() - start;
+    ctx->stats = cb.builder.stats;
+    ctx->sink += (size_t)cb.builder.buffer[cb.builder.length / 2];
+    code_builder_free(&cb);
+    return elapsed;
+}
+
+typedef struct Benchmark {
+    char const* name;
+    double(*run)(size_t size, BenchContext* ctx);
+    // Sizes above this are skipped, as the operation is too slow for them, 0 means no limit
+    size_t max_size;
+} Benchmark;
+
+static Benchmark const benchmarks[] = {
+    { .name = "memcpy (baseline)", .run = bench_memcpy_baseline },
+    { .name = "sb_putsn", .run = bench_sb_putsn },
+    { .name = "sb_join", .run = bench_sb_join },
+    { .name = "sb_putc", .run = bench_sb_putc },
+    { .name = "sb_format", .run = bench_sb_format },
+    { .name = "sb_insert (middle)", .run = bench_sb_insert, .max_size = 256 * 1024 },
+    { .name = "sb_replace (growing)", .run = bench_sb_replace, .max_size = 256 * 1024 },
+    { .name = "sb_index_of", .run = bench_sb_index_of },
+    { .name = "code_builder_*", .run = bench_code_builder },
+};
+
+static size_t bench_parse_size(char const* str) {
+    char* end;
+    size_t size = (size_t)strtoull(str, &end, 10);
+    if (*end == 'K' || *end == 'k') size *= 1024;
+    else if (*end == 'M' || *end == 'm') size *= 1024 * 1024;
+    else if (*end == 'G' || *end == 'g') size *= 1024 * 1024 * 1024;
+    return size;
+}
+
+static void bench_print_size(size_t size) {
+    if (size >= 1024 * 1024 * 1024) printf("%8zu GiB", size / (1024 * 1024 * 1024));
+    else if (size >= 1024 * 1024) printf("%8zu MiB", size / (1024 * 1024));
+    else if (size >= 1024) printf("%8zu KiB", size / 1024);
+    else printf("%8zu B  ", size);
+}
+
+// The sizes grow by a factor of 16, the last one is clamped to the maximum size, so that one is measured too, 0 ends the sizes
+static size_t bench_next_size(size_t size, size_t maxSize) {
+    if (size >= maxSize) return 0;
+    return (size > maxSize / 16) ? maxSize : size * 16;
+}
+
+int main(int argc, char* argv[]) {
+    // Usage: [max size, like 64M or 1G] [benchmark name filters...]
+    size_t maxSize = (argc > 1) ? bench_parse_size(argv[1]) : 16 * 1024 * 1024;
+    BenchContext ctx = { 0 };
+
+    printf("%-22s %12s %14s %12s %10s %10s %14s\n", "benchmark", "size", "time/iter", "MiB/s", "allocs", "reallocs", "bytes copied");
+    for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); ++b) {
+        Benchmark const* bench = &benchmarks[b];
+        bool selected = (argc <= 2);
+        for (int i = 2; i < argc; ++i) {
+            if (strstr(bench->name, argv[i]) != NULL) selected = true;
+        }
+        if (!selected) continue;
+
+        for (size_t size = (maxSize < 16) ? maxSize : 16; size != 0; size = bench_next_size(size, maxSize)) {
+            if (bench->max_size != 0 && size > bench->max_size) break;
+            // Repeat for a stable result, the time limits include the unmeasured setup
+            double total = 0;
+            size_t iterations = 0;
+            double wallStart = bench_now();
+            while (iterations < 3 || bench_now() - wallStart < 0.25) {
+                total += bench->run(size, &ctx);
+                ++iterations;
+                if (iterations >= 3 && bench_now() - wallStart > 5.0) break;
+            }
+            double perIteration = total / (double)iterations;
+            double throughput = (double)size / (1024.0 * 1024.0) / perIteration;
+            printf("%-22s ", bench->name);
+            bench_print_size(size);
+            printf(" %11.3f us %12.1f %10zu %10zu %14zu\n", perIteration * 1e6, throughput, ctx.alloc_calls, ctx.stats.reallocs, ctx.stats.bytes_copied);
+        }
+    }
+    // Print the sink, so no work can be eliminated
+    printf("(checksum: %zu)\n", ctx.sink);
+    return 0;
+}
+
+#endif /* STRING_BUILDER_BENCHMARK */
+
 ////////////////////////////////////////////////////////////////////////////////
 // Example section                                                            //
 ////////////////////////////////////////////////////////////////////////////////